@@ -0,0 +1,147 @@
+// Atomic.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Integer.h>
+#include <Basic/System.h>
+
+#if defined(CC_Microsoft)
+	#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+	#include <xmmintrin.h>
+#endif
+
+
+// Atomic operations on naturally aligned variables. Read-modify-write operations are full barriers,
+// loads have acquire and stores release semantics.
+namespace Grok
+{
+	template <typename TYPE>
+	inline TYPE AtomicLoad(const volatile TYPE* source) throw()
+	{
+		#if defined(CC_Microsoft)
+			TYPE value = *source;
+			_ReadWriteBarrier();
+			return value;
+		#else
+			return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+		#endif
+	}
+
+
+	template <typename TYPE>
+	inline void AtomicStore(volatile TYPE* target, TYPE value) throw()
+	{
+		#if defined(CC_Microsoft)
+			_ReadWriteBarrier();
+			*target = value;
+		#else
+			__atomic_store_n(target, value, __ATOMIC_RELEASE);
+		#endif
+	}
+
+
+	// Returns the new value
+	inline sint32 AtomicAdd(volatile sint32* target, sint32 value) throw()
+	{
+		#if defined(CC_Microsoft)
+			return _InterlockedExchangeAdd(reinterpret_cast<volatile long*>(target), value) + value;
+		#else
+			return __sync_add_and_fetch(target, value);
+		#endif
+	}
+
+
+	inline sint64 AtomicAdd(volatile sint64* target, sint64 value) throw()
+	{
+		#if defined(CC_Microsoft)
+			return _InterlockedExchangeAdd64(target, value) + value;
+		#else
+			return __sync_add_and_fetch(target, value);
+		#endif
+	}
+
+
+	// Returns the previous value
+	inline sint32 AtomicExchange(volatile sint32* target, sint32 value) throw()
+	{
+		#if defined(CC_Microsoft)
+			return _InterlockedExchange(reinterpret_cast<volatile long*>(target), value);
+		#else
+			return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+		#endif
+	}
+
+
+	// Stores value when target holds expected, tells whether it did
+	inline bool AtomicCompareExchange(volatile sint32* target, sint32 expected, sint32 value) throw()
+	{
+		#if defined(CC_Microsoft)
+			return _InterlockedCompareExchange(reinterpret_cast<volatile long*>(target), value, expected) == expected;
+		#else
+			return __sync_bool_compare_and_swap(target, expected, value);
+		#endif
+	}
+
+
+	inline bool AtomicCompareExchange(volatile sint64* target, sint64 expected, sint64 value) throw()
+	{
+		#if defined(CC_Microsoft)
+			return _InterlockedCompareExchange64(target, value, expected) == expected;
+		#else
+			return __sync_bool_compare_and_swap(target, expected, value);
+		#endif
+	}
+
+
+	template <typename TYPE>
+	inline bool AtomicCompareExchange(TYPE* volatile* target, TYPE* expected, TYPE* value) throw()
+	{
+		#if defined(CC_Microsoft)
+			return _InterlockedCompareExchangePointer(reinterpret_cast<void* volatile*>(target), value, expected) == expected;
+		#else
+			return __sync_bool_compare_and_swap(target, expected, value);
+		#endif
+	}
+
+
+	// Orders every load and store before it with every one after it
+	inline void AtomicFence() throw()
+	{
+		#if defined(CC_Microsoft)
+			_ReadWriteBarrier();
+			_mm_mfence();
+		#else
+			__sync_synchronize();
+		#endif
+	}
+
+
+	// Hint for the body of a spin loop
+	inline void CpuRelax() throw()
+	{
+		#if defined(CC_Microsoft) || defined(__i386__) || defined(__x86_64__)
+			_mm_pause();
+		#endif
+	}
+
+
+	// Lets the operating system run another ready thread, for spin loops that may wait on a thread that
+	// was preempted
+	void YieldThread() throw();
+}
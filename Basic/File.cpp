@@ -51,6 +51,8 @@
 
 #elif defined(OS_MacOSX) || defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
 
+	#include <fcntl.h>
+	#include <sys/mman.h>
 	#include <sys/types.h>
 	#include <sys/stat.h>
 	#include <unistd.h>
@@ -739,6 +741,210 @@ namespace Grok
 		}
 	}
 
+
+	MappedFile::MappedFile() throw()
+	:	address(static_cast<void*>(0)),
+		size(0),
+		mapping(FileMapping::read_only)
+	{
+	}
+
+
+	MappedFile::~MappedFile() throw()
+	{
+		if (address)
+		{
+			Close();
+		}
+	}
+
+
+	void MappedFile::Advise(FileAdvice::ID advice, sint64 offset_bytes, sint64 size_bytes) throw()
+	{
+		Assert(offset_bytes >= 0);
+
+		if (size_bytes < 0)
+		{
+			size_bytes = size - offset_bytes;
+		}
+		if (!address || (offset_bytes >= size) || (size_bytes <= 0))
+		{
+			return;
+		}
+		if (offset_bytes + size_bytes > size)
+		{
+			size_bytes = size - offset_bytes;
+		}
+
+		#if defined(OS_MacOSX) || defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
+
+			// madvise takes page aligned ranges
+			const sint64 page_size = static_cast<sint64>(sysconf(_SC_PAGESIZE));
+			register sint64 begin = offset_bytes - offset_bytes % page_size;
+			register int flag;
+			switch (advice)
+			{
+				#if defined(MADV_SEQUENTIAL)
+					case FileAdvice::sequential:
+						flag = MADV_SEQUENTIAL;
+						break;
+				#endif
+				#if defined(MADV_RANDOM)
+					case FileAdvice::random:
+						flag = MADV_RANDOM;
+						break;
+				#endif
+				#if defined(MADV_WILLNEED)
+					case FileAdvice::will_need:
+						flag = MADV_WILLNEED;
+						break;
+				#endif
+				#if defined(MADV_HUGEPAGE)
+					case FileAdvice::huge_pages:
+						flag = MADV_HUGEPAGE;
+						break;
+				#endif
+				#if defined(MADV_NORMAL)
+					case FileAdvice::normal:
+						flag = MADV_NORMAL;
+						break;
+				#endif
+				default:
+					return;
+			}
+			madvise(static_cast<char*>(address) + begin, static_cast<size_t>(offset_bytes + size_bytes - begin), flag);
+
+		#else
+
+			(void)advice;
+
+		#endif
+	}
+
+
+	void MappedFile::Close() throw()
+	{
+		Assert(address || (size == 0));
+
+		if (address)
+		{
+			#if defined(OS_Windows)
+				UnmapViewOfFile(address);
+			#else
+				munmap(address, static_cast<size_t>(size));
+			#endif
+		}
+		address = static_cast<void*>(0);
+		size = 0;
+	}
+
+
+	void MappedFile::Open(const char* file_name, FileMapping::ID mapping) throw(FileException)
+	{
+		Assert(file_name);
+		Assert(!address);
+
+		this->mapping = mapping;
+
+		#if defined(OS_Windows)
+
+			HANDLE file_handle = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, static_cast<LPSECURITY_ATTRIBUTES>(0), OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, static_cast<HANDLE>(0));
+			if (file_handle == INVALID_HANDLE_VALUE)
+			{
+				Throw(FileException(FileException::open_error));
+			}
+			LARGE_INTEGER file_size;
+			if (!GetFileSizeEx(file_handle, &file_size))
+			{
+				CloseHandle(file_handle);
+				Throw(FileException(FileException::open_error));
+			}
+			size = static_cast<sint64>(file_size.QuadPart);
+
+			// Empty files can not be mapped, they get no address
+			if (size > 0)
+			{
+				register HANDLE mapping_handle = CreateFileMappingA(file_handle, static_cast<LPSECURITY_ATTRIBUTES>(0), (mapping == FileMapping::copy_on_write) ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, static_cast<LPCSTR>(0));
+				if (mapping_handle)
+				{
+					address = MapViewOfFile(mapping_handle, (mapping == FileMapping::copy_on_write) ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+
+					// The view keeps the mapping and the file open
+					CloseHandle(mapping_handle);
+				}
+				if (!address)
+				{
+					CloseHandle(file_handle);
+					size = 0;
+					Throw(FileException(FileException::map_error));
+				}
+			}
+			CloseHandle(file_handle);
+
+		#else
+
+			register int file_descriptor = open(file_name, O_RDONLY);
+			if (file_descriptor < 0)
+			{
+				Throw(FileException(FileException::open_error));
+			}
+			struct stat file_status;
+			if (fstat(file_descriptor, &file_status) != 0)
+			{
+				close(file_descriptor);
+				Throw(FileException(FileException::open_error));
+			}
+			size = static_cast<sint64>(file_status.st_size);
+
+			// Empty files can not be mapped, they get no address
+			if (size > 0)
+			{
+				register void* memory = MAP_FAILED;
+				if (static_cast<sint64>(static_cast<size_t>(size)) == size)
+				{
+					if (mapping == FileMapping::copy_on_write)
+					{
+						memory = mmap(static_cast<void*>(0), static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file_descriptor, 0);
+					}
+					else
+					{
+						memory = mmap(static_cast<void*>(0), static_cast<size_t>(size), PROT_READ, MAP_SHARED, file_descriptor, 0);
+					}
+				}
+				if (memory == MAP_FAILED)
+				{
+					close(file_descriptor);
+					size = 0;
+					Throw(FileException(FileException::map_error));
+				}
+				address = memory;
+			}
+
+			// The mapping keeps the file open
+			close(file_descriptor);
+
+		#endif
+	}
+
+
+	void* MappedFile::Region(sint64 offset_bytes, sint64 size_bytes) const throw(FileException)
+	{
+		Assert(offset_bytes >= 0);
+		Assert(size_bytes >= 0);
+
+		if (offset_bytes + size_bytes > size)
+		{
+			Throw(FileException(FileException::eof_error));
+		}
+		return static_cast<char*>(address) + offset_bytes;
+	}
+
+
+	sint64 MappedFile::Size() const throw()
+	{
+		return size;
+	}
+
 	#if defined(CC_Microsoft)
 		#pragma warning(pop)
 	#elif defined(CC_Clang)
@@ -20,6 +20,7 @@
 #include <Basic/Exception.h>
 #include <Basic/Integer.h>
 #include <Basic/String.h>
+#include <Container/MatrixView.h>
 
 #define STRING_DEFAULT_MAXIMUM_SIZE 512
 
@@ -38,7 +39,8 @@ namespace Grok
 			read_error   = 6,
 			seek_error   = 7,
 			tell_error   = 8,
-			write_error  = 9
+			write_error  = 9,
+			map_error    = 10
 		};
 
 		ErrorType error_type;
@@ -210,4 +212,114 @@ namespace Grok
 
 			char comment_delimiter;
 	};
+
+
+	namespace FileMapping
+	{
+		enum ID
+		{
+			// Views are const, the pages are shared with the page cache and other processes
+			read_only,
+
+			// Views can be written, written pages become private copies and the file is never changed
+			copy_on_write
+		};
+	}
+
+
+	namespace FileAdvice
+	{
+		enum ID
+		{
+			normal,
+			sequential,
+			random,
+			will_need,
+			huge_pages
+		};
+	}
+
+
+	// A whole file mapped into memory, read through typed views that point into the mapping, so
+	// nothing is copied through stdio buffers and pages are read from disk only when touched. Views must
+	// not outlive the mapping.
+	class MappedFile
+	{
+		public:
+
+			MappedFile() throw();
+
+
+			// Unmaps if still open
+			~MappedFile() throw();
+
+
+			void Open(const char* file_name, FileMapping::ID mapping = FileMapping::read_only) throw(FileException);
+
+
+			void Close() throw();
+
+
+			// Hint about how the bytes [offset_bytes, offset_bytes + size_bytes) will be accessed, size_bytes -1
+			// to the end of the file. Hints the system does not support are ignored.
+			void Advise(FileAdvice::ID advice, sint64 offset_bytes = 0, sint64 size_bytes = -1) throw();
+
+
+			sint64 Size() const throw();
+
+
+			// count entries of type T from offset_bytes, which has to be a multiple of the alignment of T
+			template <typename T>
+			inline VectorView<const T> View(sint64 offset_bytes, int count) const throw(FileException)
+			{
+				return VectorView<const T>(static_cast<const T*>(Region(offset_bytes, static_cast<sint64>(count)*static_cast<sint64>(sizeof(T)))), count);
+			}
+
+
+			// Only with FileMapping::copy_on_write
+			template <typename T>
+			inline VectorView<T> WritableView(sint64 offset_bytes, int count) throw(FileException)
+			{
+				Assert(mapping == FileMapping::copy_on_write);
+
+				return VectorView<T>(static_cast<T*>(Region(offset_bytes, static_cast<sint64>(count)*static_cast<sint64>(sizeof(T)))), count);
+			}
+
+
+			// rows x columns entries of type T from offset_bytes, stored with the given layout and no padding
+			template <typename T>
+			inline MatrixView<const T> View(sint64 offset_bytes, int rows, int columns, MatrixLayout::ID layout = MatrixLayout::row_major) const throw(FileException)
+			{
+				return MatrixView<const T>(static_cast<const T*>(Region(offset_bytes, static_cast<sint64>(rows)*static_cast<sint64>(columns)*static_cast<sint64>(sizeof(T)))), rows, columns, (layout == MatrixLayout::row_major) ? columns : rows, layout);
+			}
+
+
+			// Only with FileMapping::copy_on_write
+			template <typename T>
+			inline MatrixView<T> WritableView(sint64 offset_bytes, int rows, int columns, MatrixLayout::ID layout = MatrixLayout::row_major) throw(FileException)
+			{
+				Assert(mapping == FileMapping::copy_on_write);
+
+				return MatrixView<T>(static_cast<T*>(Region(offset_bytes, static_cast<sint64>(rows)*static_cast<sint64>(columns)*static_cast<sint64>(sizeof(T)))), rows, columns, (layout == MatrixLayout::row_major) ? columns : rows, layout);
+			}
+
+
+		private:
+
+			void* address;
+
+			sint64 size;
+
+			FileMapping::ID mapping;
+
+
+			// Start of the bytes [offset_bytes, offset_bytes + size_bytes), eof_error if they are not all in the file
+			void* Region(sint64 offset_bytes, sint64 size_bytes) const throw(FileException);
+
+
+			MappedFile(const MappedFile&);
+
+
+			MappedFile& operator = (const MappedFile&);
+	};
 }
@@ -44,7 +44,7 @@ namespace Grok
 		Assert(level >= 0);
 
 		file_stream = (void*)stdout;
-		start_time.SetEpochTime();
+		start_time.UseCurrentTime();
 		this->level = level;
 		this->use_colors = use_colors;
 	}
@@ -70,7 +70,7 @@ namespace Grok
 		{
 			Time current_time;
 
-			current_time.SetEpochTime();
+			current_time.UseCurrentTime();
 
 			Time time_difference = current_time - start_time;
 
@@ -108,11 +108,6 @@ namespace Grok
 						Console::SetForeground(ConsoleColor::cyan, false);
 						break;
 					}
-					case LogLevel::debug2:
-					{
-						Console::SetForeground(ConsoleColor::cyan, false);
-						break;
-					}
 				};
 			}
 
@@ -149,11 +144,6 @@ namespace Grok
 					code_id = 'D';
 					break;
 				}
-				case LogLevel::debug2:
-				{
-					code_id = 'D';
-					break;
-				}
 				default:
 				{
 					code_id = ' ';
@@ -177,7 +167,7 @@ namespace Grok
 
 	void Log::RestartTime() throw()
 	{
-		start_time.SetEpochTime();
+		start_time.UseCurrentTime();
 	}
 
 
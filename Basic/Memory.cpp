@@ -15,80 +15,1126 @@
 // License along with this library; if not, write to the Free
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
+#include <Basic/Assert.h>
+#include <Basic/Atomic.h>
 #include <Basic/Memory.h>
+#include <Basic/Time.h>
+
+#include <new>
+#include <string.h>
 
 #if defined(OS_MacOSX)
 
 	#include <malloc/malloc.h>
+	#include <mach/mach.h>
+	#include <pthread.h>
 
 #elif defined(OS_Windows)
 
+	#define WINVER         0x0502
+	#define _WIN32_WINNT   0x0502
+	#define _WIN32_WINDOWS 0x0502
+	#define WIN32_LEAN_AND_MEAN
+	#define NOCOMM
+	#define NODEFERWINDOWPOS
+	#define NOHELP
+	#define NOIME
+	#define NOMCX
+	#define NOPROFILER
+	#define NOSERVICE
+	#define NOWH
+	#include <windows.h>
 	#include <malloc.h>
 
-#elif defined(OS_Cygwin) || defined(OS_Linux)
+#elif defined(OS_Cygwin)
 
+	#include <malloc.h>
+	#include <pthread.h>
+	#include <stdio.h>
 	#include <stdlib.h>
+	#include <unistd.h>
+
+#elif defined(OS_Linux)
+
+	#include <malloc.h>
+	#include <pthread.h>
+	#include <stdio.h>
+	#include <stdlib.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
 
 #elif defined(OS_FreeBSD)
 
 	#include <malloc_np.h>
+	#include <pthread.h>
+	#include <sys/types.h>
+	#include <sys/sysctl.h>
+	#include <unistd.h>
 
 #endif
 
 
-void* operator new (size_t size, unsigned short alignment) throw()
+namespace GrokInternal
 {
-	#if defined(OS_Windows)
+	// Last AvailableMemory() reading and the milliseconds since the epoch when it was taken
+	volatile Grok::sint64 available_memory = 0;
 
-		return _aligned_malloc(size, alignment);
+	volatile Grok::sint64 available_memory_time = 0;
 
-	#elif defined(OS_MacOSX) || defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
 
-		void* memory;
-		return posix_memalign(&memory, alignment, size) ? static_cast<void*>(0) : memory;
+	static size_t SystemAvailableMemory() throw()
+	{
+		#if defined(OS_Windows)
 
-	#endif
+			MEMORYSTATUSEX status;
+			status.dwLength = sizeof(status);
+			return GlobalMemoryStatusEx(&status) ? static_cast<size_t>(status.ullAvailPhys) : 0;
+
+		#elif defined(OS_MacOSX)
+
+			vm_statistics64_data_t statistics;
+			mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+			if (host_statistics64(mach_host_self(), HOST_VM_INFO64, reinterpret_cast<host_info64_t>(&statistics), &count) != KERN_SUCCESS)
+			{
+				return 0;
+			}
+			return static_cast<size_t>(statistics.free_count + statistics.inactive_count)*static_cast<size_t>(vm_page_size);
+
+		#elif defined(OS_FreeBSD)
+
+			unsigned int free_count = 0;
+			unsigned int inactive_count = 0;
+			size_t length = sizeof(unsigned int);
+			sysctlbyname("vm.stats.vm.v_free_count", &free_count, &length, static_cast<void*>(0), 0);
+			length = sizeof(unsigned int);
+			sysctlbyname("vm.stats.vm.v_inactive_count", &inactive_count, &length, static_cast<void*>(0), 0);
+			return static_cast<size_t>(free_count + inactive_count)*static_cast<size_t>(getpagesize());
+
+		#elif defined(OS_Cygwin) || defined(OS_Linux)
+
+			// MemAvailable also counts reclaimable page cache, free pages alone underestimate it
+			FILE* meminfo = fopen("/proc/meminfo", "r");
+			if (meminfo)
+			{
+				char line[128];
+				while (fgets(line, sizeof(line), meminfo))
+				{
+					unsigned long kilobytes;
+					if (sscanf(line, "MemAvailable: %lu kB", &kilobytes) == 1)
+					{
+						fclose(meminfo);
+						return static_cast<size_t>(kilobytes)*1024;
+					}
+				}
+				fclose(meminfo);
+			}
+			return static_cast<size_t>(sysconf(_SC_AVPHYS_PAGES))*static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+		#endif
+	}
 }
 
 
-void* operator new [] (size_t size, unsigned short alignment) throw()
+namespace Grok
+{
+	size_t AvailableMemory() throw()
+	{
+		Time now;
+		now.UseCurrentTime();
+		const sint64 milliseconds = static_cast<sint64>(now.seconds)*1000 + now.milliseconds;
+		register sint64 last = AtomicLoad(&GrokInternal::available_memory_time);
+		if ((milliseconds - last >= AVAILABLE_MEMORY_REFRESH) || (milliseconds < last))
+		{
+			AtomicStore(&GrokInternal::available_memory, static_cast<sint64>(GrokInternal::SystemAvailableMemory()));
+			AtomicStore(&GrokInternal::available_memory_time, milliseconds);
+		}
+		return static_cast<size_t>(AtomicLoad(&GrokInternal::available_memory));
+	}
+}
+
+
+namespace GrokInternal
 {
+	THREAD_LOCAL Grok::ArenaScope* arena_scope = static_cast<Grok::ArenaScope*>(0);
+
+
+	static inline void* SystemAllocate(size_t size, size_t alignment) throw()
+	{
+		#if defined(OS_Windows)
+
+			return _aligned_malloc(size, alignment);
+
+		#elif defined(OS_MacOSX) || defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
+
+			void* memory;
+			return posix_memalign(&memory, alignment, size) ? static_cast<void*>(0) : memory;
+
+		#endif
+	}
+
+
+	static inline void SystemFree(void* memory) throw()
+	{
+		#if defined(OS_Windows)
+
+			_aligned_free(memory);
+
+		#elif defined(OS_MacOSX) || defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
+
+			free(memory);
+
+		#endif
+	}
+
+
+	static inline size_t UsableSize(void* memory) throw()
+	{
+		#if defined(OS_Windows)
+
+			// _aligned_msize needs the alignment the block was requested with
+			return 0;
+
+		#elif defined(OS_MacOSX)
+
+			return malloc_size(memory);
+
+		#elif defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
+
+			return malloc_usable_size(memory);
+
+		#endif
+	}
+
+
+	static inline Grok::sint64 AtomicAdd(volatile Grok::sint64* target, Grok::sint64 value) throw()
+	{
+		#if defined(OS_Windows)
+			return InterlockedExchangeAdd64(target, value) + value;
+		#else
+			return __sync_add_and_fetch(target, value);
+		#endif
+	}
+
+
+	static inline bool AtomicCompareExchange(volatile Grok::sint64* target, Grok::sint64 expected, Grok::sint64 value) throw()
+	{
+		#if defined(OS_Windows)
+			return InterlockedCompareExchange64(target, value, expected) == expected;
+		#else
+			return __sync_bool_compare_and_swap(target, expected, value);
+		#endif
+	}
+
+
+	static inline void SpinLock(volatile long* lock) throw()
+	{
+		#if defined(OS_Windows)
+			while (InterlockedExchange(lock, 1))
+			{
+			}
+		#else
+			while (__sync_lock_test_and_set(lock, 1))
+			{
+			}
+		#endif
+	}
+
+
+	static inline void SpinUnlock(volatile long* lock) throw()
+	{
+		#if defined(OS_Windows)
+			InterlockedExchange(lock, 0);
+		#else
+			__sync_lock_release(lock);
+		#endif
+	}
+
+
+	// Live bytes of a thread are published once they drift this far from the last flush
+	const Grok::sint64 memory_flush_bytes = 1048576;
+
+
+	struct MemoryCounters
+	{
+		Grok::sint64 live_bytes;
+
+		Grok::sint64 unflushed_bytes;
+
+		Grok::uint64 allocations;
+
+		Grok::uint64 frees;
+
+		Grok::uint64 size_class_allocations[MEMORY_SIZE_CLASSES];
+
+		Grok::uint64 rate_histogram[MEMORY_RATE_CLASSES];
+
+		long interval;
+
+		Grok::uint64 interval_allocations;
+
+		int tags;
+
+		const char* tag_name[MEMORY_TAGS];
+
+		Grok::uint64 tag_allocations[MEMORY_TAGS];
+
+		Grok::sint64 tag_bytes[MEMORY_TAGS];
+
+		MemoryCounters* next;
+	};
+
+
+	volatile bool memory_tracking = false;
+
+	volatile Grok::sint64 memory_live_bytes = 0;
+
+	volatile Grok::sint64 memory_peak_bytes = 0;
+
+	MemoryCounters* memory_counters_list = static_cast<MemoryCounters*>(0);
+
+	volatile long memory_counters_lock = 0;
+
+	THREAD_LOCAL MemoryCounters* memory_counters = static_cast<MemoryCounters*>(0);
+
+	THREAD_LOCAL const char* memory_tag = static_cast<const char*>(0);
+
+
+	// Blocks of finished threads stay in the list, their counts are still part of the totals
+	static MemoryCounters* RegisterMemoryCounters() throw()
+	{
+		register MemoryCounters* counters = static_cast<MemoryCounters*>(SystemAllocate(sizeof(MemoryCounters), DEFAULT_ALIGNMENT));
+		if (counters)
+		{
+			memset(counters, 0, sizeof(MemoryCounters));
+			SpinLock(&memory_counters_lock);
+			counters->next = memory_counters_list;
+			memory_counters_list = counters;
+			SpinUnlock(&memory_counters_lock);
+			memory_counters = counters;
+		}
+		return counters;
+	}
+
+
+	static void FlushLiveBytes(MemoryCounters* counters) throw()
+	{
+		register Grok::sint64 live = AtomicAdd(&memory_live_bytes, counters->unflushed_bytes);
+		counters->unflushed_bytes = 0;
+		for (register Grok::sint64 peak = memory_peak_bytes; peak < live; peak = memory_peak_bytes)
+		{
+			if (AtomicCompareExchange(&memory_peak_bytes, peak, live))
+			{
+				break;
+			}
+		}
+	}
+
+
+	static inline int Log2(Grok::uint64 value) throw()
+	{
+		register int log = 0;
+		while (value >>= 1)
+		{
+			++log;
+		}
+		return log;
+	}
+
+
+	static void RecordAllocation(size_t bytes) throw()
+	{
+		register MemoryCounters* counters = memory_counters ? memory_counters : RegisterMemoryCounters();
+		if (!counters)
+		{
+			return;
+		}
+		counters->live_bytes += static_cast<Grok::sint64>(bytes);
+		counters->unflushed_bytes += static_cast<Grok::sint64>(bytes);
+		if (counters->unflushed_bytes > memory_flush_bytes)
+		{
+			FlushLiveBytes(counters);
+		}
+		register int c = Log2(bytes);
+		++counters->size_class_allocations[(c < MEMORY_SIZE_CLASSES) ? c : MEMORY_SIZE_CLASSES - 1];
+		if ((++counters->allocations & 255) == 0)
+		{
+			Grok::Time now;
+			now.UseCurrentTime();
+			if (now.seconds != counters->interval)
+			{
+				if (counters->interval_allocations)
+				{
+					register int r = Log2(counters->interval_allocations);
+					++counters->rate_histogram[(r < MEMORY_RATE_CLASSES) ? r : MEMORY_RATE_CLASSES - 1];
+				}
+				counters->interval = now.seconds;
+				counters->interval_allocations = 0;
+			}
+			counters->interval_allocations += 256;
+		}
+		if (memory_tag)
+		{
+			register int t = 0;
+			while ((t < counters->tags) && (counters->tag_name[t] != memory_tag))
+			{
+				++t;
+			}
+			if (t == counters->tags)
+			{
+				if (t == MEMORY_TAGS)
+				{
+					return;
+				}
+				counters->tag_name[t] = memory_tag;
+				++counters->tags;
+			}
+			++counters->tag_allocations[t];
+			counters->tag_bytes[t] += static_cast<Grok::sint64>(bytes);
+		}
+	}
+
+
+	static void RecordFree(size_t bytes) throw()
+	{
+		register MemoryCounters* counters = memory_counters ? memory_counters : RegisterMemoryCounters();
+		if (!counters)
+		{
+			return;
+		}
+		++counters->frees;
+		counters->live_bytes -= static_cast<Grok::sint64>(bytes);
+		counters->unflushed_bytes -= static_cast<Grok::sint64>(bytes);
+		if (counters->unflushed_bytes < -memory_flush_bytes)
+		{
+			FlushLiveBytes(counters);
+		}
+	}
+
+
+	static inline void* HeapAllocate(size_t size, size_t alignment) throw()
+	{
+		register void* memory = SystemAllocate(size, alignment);
+		if (memory_tracking && memory)
+		{
+			RecordAllocation(UsableSize(memory));
+		}
+		return memory;
+	}
+
+
+	static inline void HeapFree(void* memory) throw()
+	{
+		if (memory_tracking && memory)
+		{
+			RecordFree(UsableSize(memory));
+		}
+		SystemFree(memory);
+	}
+
+
+	static inline void* Allocate(size_t size, unsigned short alignment) throw()
+	{
+		if (arena_scope)
+		{
+			void* memory = arena_scope->arena.Allocate(size, alignment);
+			if (memory)
+			{
+				return memory;
+			}
+		}
+		return HeapAllocate(size, alignment);
+	}
+
+
+	#if defined(OS_Linux)
+
+		// Regions mapped from the huge page pool, delete has to munmap them instead of free
+		struct HugeRegion
+		{
+			void* begin;
+
+			size_t size;
+		};
+
+
+		const int huge_regions_capacity = 256;
+
+		HugeRegion huge_regions[huge_regions_capacity];
+
+		volatile int huge_regions_count = 0;
+
+		volatile long huge_regions_lock = 0;
+
+
+		static bool HugeRegionAdd(void* begin, size_t size) throw()
+		{
+			SpinLock(&huge_regions_lock);
+			register bool added = false;
+			if (huge_regions_count < huge_regions_capacity)
+			{
+				huge_regions[huge_regions_count].begin = begin;
+				huge_regions[huge_regions_count].size = size;
+				++huge_regions_count;
+				added = true;
+			}
+			SpinUnlock(&huge_regions_lock);
+			return added;
+		}
+
+
+		static bool HugeRegionRemove(void* begin) throw()
+		{
+			size_t size = 0;
+			SpinLock(&huge_regions_lock);
+			for (register int r = 0; r < huge_regions_count; ++r)
+			{
+				if (huge_regions[r].begin == begin)
+				{
+					size = huge_regions[r].size;
+					huge_regions[r] = huge_regions[--huge_regions_count];
+					break;
+				}
+			}
+			SpinUnlock(&huge_regions_lock);
+			if (size)
+			{
+				munmap(begin, size);
+				if (memory_tracking)
+				{
+					RecordFree(size);
+				}
+				return true;
+			}
+			return false;
+		}
+
+	#endif
+
+
+	static inline void Free(void* memory) throw()
+	{
+		for (register Grok::ArenaScope* scope = arena_scope; scope; scope = scope->outer)
+		{
+			if (scope->arena.Owns(memory))
+			{
+				return;
+			}
+		}
+		#if defined(OS_Linux)
+			if (huge_regions_count && HugeRegionRemove(memory))
+			{
+				return;
+			}
+		#endif
+		HeapFree(memory);
+	}
+
+
+	// Allocations whose placement could not be applied
+	volatile Grok::sint64 memory_placement_failures = 0;
+
+
+	static void* PolicyAllocate(size_t size, const Grok::MemoryPolicy& policy) throw()
+	{
+		#if defined(OS_Linux)
+
+			const size_t huge_page_size = 2097152;
+			const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+			void* memory = static_cast<void*>(0);
+			#if defined(MAP_HUGETLB)
+				if (policy.pages == Grok::MemoryPages::explicit_huge)
+				{
+					register size_t length = (size + huge_page_size - 1) & ~(huge_page_size - 1);
+					memory = mmap(static_cast<void*>(0), length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+					if (memory == MAP_FAILED)
+					{
+						memory = static_cast<void*>(0);
+					}
+					else if (!HugeRegionAdd(memory, length))
+					{
+						munmap(memory, length);
+						memory = static_cast<void*>(0);
+					}
+					else if (memory_tracking)
+					{
+						RecordAllocation(length);
+					}
+				}
+			#endif
+			if (!memory)
+			{
+				register size_t alignment = policy.alignment;
+				if (policy.pages != Grok::MemoryPages::standard)
+				{
+					alignment = huge_page_size;
+				}
+				else if ((policy.placement != Grok::MemoryPlacement::first_touch) && (alignment < page_size))
+				{
+					alignment = page_size;
+				}
+				memory = HeapAllocate(size, alignment);
+				if (!memory)
+				{
+					return static_cast<void*>(0);
+				}
+				#if defined(MADV_HUGEPAGE)
+					if (policy.pages != Grok::MemoryPages::standard)
+					{
+						madvise(memory, size, MADV_HUGEPAGE);
+					}
+				#endif
+			}
+
+			// Policies only apply to pages not touched yet, failures (no NUMA support, node not allowed) leave
+			// the pages on first touch and are counted
+			if (policy.placement != Grok::MemoryPlacement::first_touch)
+			{
+				const int mpol_bind = 2;
+				const int mpol_interleave = 3;
+				unsigned long mask = (policy.placement == Grok::MemoryPlacement::interleave) ? ~0UL : 1UL << policy.node;
+				if (syscall(SYS_mbind, memory, size, (policy.placement == Grok::MemoryPlacement::interleave) ? mpol_interleave : mpol_bind, &mask, 8*sizeof(mask), 0) != 0)
+				{
+					AtomicAdd(&memory_placement_failures, static_cast<Grok::sint64>(1));
+				}
+			}
+			return memory;
+
+		#else
+
+			if (policy.placement != Grok::MemoryPlacement::first_touch)
+			{
+				AtomicAdd(&memory_placement_failures, static_cast<Grok::sint64>(1));
+			}
+			return HeapAllocate(size, policy.alignment);
+
+		#endif
+	}
+
+
+	// Classes 0 to 63 step by 16 bytes up to 1 KB, classes 64 to 73 are the powers of two up to 1 MB
+	const int pool_classes = 74;
+
+
+	struct PoolNode
+	{
+		PoolNode* next;
+	};
+
+
+	THREAD_LOCAL PoolNode* pool_free[pool_classes];
+
+
+	// Written only by its thread, read by GetPoolStatistics
+	struct PoolCounters
+	{
+		size_t hits;
+
+		size_t misses;
+
+		size_t bytes_held;
+
+		PoolCounters* next;
+	};
+
+
+	// Shared by the threads that could not allocate counters of their own
+	PoolCounters pool_counters_shared;
+
+	PoolCounters* pool_counters_list = &pool_counters_shared;
+
+	volatile long pool_counters_lock = 0;
+
+	THREAD_LOCAL PoolCounters* pool_counters = static_cast<PoolCounters*>(0);
+
+
+	// Blocks of finished threads stay in the list, their hits and misses are still part of the totals
+	static PoolCounters* RegisterPoolCounters() throw()
+	{
+		register PoolCounters* counters = static_cast<PoolCounters*>(SystemAllocate(sizeof(PoolCounters), DEFAULT_ALIGNMENT));
+		if (!counters)
+		{
+			pool_counters = &pool_counters_shared;
+			return pool_counters;
+		}
+		memset(counters, 0, sizeof(PoolCounters));
+		SpinLock(&pool_counters_lock);
+		counters->next = pool_counters_list;
+		pool_counters_list = counters;
+		SpinUnlock(&pool_counters_lock);
+		pool_counters = counters;
+		return counters;
+	}
+
+
+	static inline PoolCounters* ThreadPoolCounters() throw()
+	{
+		return pool_counters ? pool_counters : RegisterPoolCounters();
+	}
+
+
+	static inline int PoolClass(size_t size) throw()
+	{
+		if (size <= 1024)
+		{
+			return (size > 16) ? static_cast<int>((size - 1) >> 4) : 0;
+		}
+		register int c = 64;
+		register size_t class_size = 2048;
+		while (class_size < size)
+		{
+			class_size <<= 1;
+			++c;
+		}
+		return c;
+	}
+
+
+	static inline size_t PoolClassSize(int c) throw()
+	{
+		return (c < 64) ? static_cast<size_t>(c + 1) << 4 : static_cast<size_t>(2048) << (c - 64);
+	}
+
+
+	// Blocks given back by threads that exited or went over POOL_CACHE_LIMIT, shared by every thread so
+	// the blocks one thread frees are reused by the others instead of being kept for good
+	struct PoolDepot
+	{
+		PoolNode* volatile free;
+
+		volatile long lock;
+	};
+
+
+	PoolDepot pool_depot[pool_classes];
+
+	volatile Grok::sint64 pool_depot_bytes = 0;
+
+	THREAD_LOCAL bool pool_thread_registered = false;
+
+	volatile long pool_exit_lock = 0;
+
+	bool pool_exit_ready = false;
+
 	#if defined(OS_Windows)
+		DWORD pool_exit_index = FLS_OUT_OF_INDEXES;
+	#else
+		pthread_key_t pool_exit_key;
+	#endif
+
+
+	// Adds a list of class c blocks to the depot, or frees them when the depot would exceed POOL_DEPOT_LIMIT
+	static void PoolDepotPut(int c, PoolNode* list) throw()
+	{
+		if (!list)
+		{
+			return;
+		}
+		register PoolNode* tail = list;
+		register Grok::sint64 bytes = static_cast<Grok::sint64>(PoolClassSize(c));
+		while (tail->next)
+		{
+			tail = tail->next;
+			bytes += static_cast<Grok::sint64>(PoolClassSize(c));
+		}
+		if (AtomicAdd(&pool_depot_bytes, bytes) > POOL_DEPOT_LIMIT)
+		{
+			AtomicAdd(&pool_depot_bytes, -bytes);
+			while (list)
+			{
+				register PoolNode* next = list->next;
+				HeapFree(list);
+				list = next;
+			}
+			return;
+		}
+		SpinLock(&pool_depot[c].lock);
+		tail->next = pool_depot[c].free;
+		Grok::AtomicStore(&pool_depot[c].free, list);
+		SpinUnlock(&pool_depot[c].lock);
+	}
 
-		return _aligned_malloc(size, alignment);
 
-	#elif defined(OS_MacOSX) || defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
+	// Takes up to POOL_REFILL_BYTES of class c blocks (at least one) from the depot, null if it has none
+	static PoolNode* PoolDepotTake(int c, int& taken) throw()
+	{
+		taken = 0;
+		if (!Grok::AtomicLoad(&pool_depot[c].free))
+		{
+			return static_cast<PoolNode*>(0);
+		}
+		register int count = static_cast<int>(POOL_REFILL_BYTES/PoolClassSize(c));
+		if (count < 1)
+		{
+			count = 1;
+		}
+		SpinLock(&pool_depot[c].lock);
+		register PoolNode* list = pool_depot[c].free;
+		register PoolNode* tail = list;
+		if (list)
+		{
+			taken = 1;
+			while (tail->next && (taken < count))
+			{
+				tail = tail->next;
+				++taken;
+			}
+			Grok::AtomicStore(&pool_depot[c].free, tail->next);
+			tail->next = static_cast<PoolNode*>(0);
+		}
+		SpinUnlock(&pool_depot[c].lock);
+		AtomicAdd(&pool_depot_bytes, -static_cast<Grok::sint64>(taken*PoolClassSize(c)));
+		return list;
+	}
 
-		void* memory;
-		return posix_memalign(&memory, alignment, size) ? static_cast<void*>(0) : memory;
 
+	// Moves every block cached by the calling thread to the depot
+	static void PoolFlush() throw()
+	{
+		for (register int c = 0; c < pool_classes; ++c)
+		{
+			PoolDepotPut(c, pool_free[c]);
+			pool_free[c] = static_cast<PoolNode*>(0);
+		}
+		ThreadPoolCounters()->bytes_held = 0;
+	}
+
+
+	#if defined(OS_Windows)
+		static VOID WINAPI PoolThreadExit(PVOID) throw()
+	#else
+		static void PoolThreadExit(void*) throw()
 	#endif
+	{
+		PoolFlush();
+	}
+
+
+	// Has PoolThreadExit called when the calling thread exits (not for the main thread, whose cache goes
+	// with the process)
+	static void PoolRegisterThread() throw()
+	{
+		pool_thread_registered = true;
+		SpinLock(&pool_exit_lock);
+		if (!pool_exit_ready)
+		{
+			#if defined(OS_Windows)
+				pool_exit_index = FlsAlloc(PoolThreadExit);
+				pool_exit_ready = (pool_exit_index != FLS_OUT_OF_INDEXES);
+			#else
+				pool_exit_ready = !pthread_key_create(&pool_exit_key, PoolThreadExit);
+			#endif
+		}
+		SpinUnlock(&pool_exit_lock);
+		if (pool_exit_ready)
+		{
+			// Any value but null has the callback run
+			#if defined(OS_Windows)
+				FlsSetValue(pool_exit_index, &pool_thread_registered);
+			#else
+				pthread_setspecific(pool_exit_key, &pool_thread_registered);
+			#endif
+		}
+	}
 }
 
 
-void operator delete (void* object) throw()
+namespace Grok
 {
-	#if defined(OS_Windows)
+	Arena::Arena(size_t capacity) throw(MemoryException)
+	{
+		begin = static_cast<char*>(GrokInternal::HeapAllocate(capacity, 4096));
+		if (!begin)
+		{
+			Throw(MemoryException());
+		}
+		end = begin + capacity;
+		top = begin;
+	}
 
-		_aligned_free(object);
 
-	#elif defined(OS_MacOSX) || defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
+	Arena::~Arena() throw()
+	{
+		GrokInternal::HeapFree(begin);
+	}
 
-		free(object);
 
-	#endif
+	ArenaScope::ArenaScope(Arena& arena) throw()
+	:	arena(arena),
+		mark(arena.top),
+		outer(GrokInternal::arena_scope)
+	{
+		GrokInternal::arena_scope = this;
+	}
+
+
+	ArenaScope::~ArenaScope() throw()
+	{
+		Assert(GrokInternal::arena_scope == this);
+
+		arena.top = mark;
+		GrokInternal::arena_scope = outer;
+	}
+
+
+	void* PoolAllocate(size_t size) throw()
+	{
+		register GrokInternal::PoolCounters* counters = GrokInternal::ThreadPoolCounters();
+		register int c = GrokInternal::PoolClass(size);
+		if (c >= GrokInternal::pool_classes)
+		{
+			++counters->misses;
+			return GrokInternal::HeapAllocate(size, DEFAULT_ALIGNMENT);
+		}
+		register GrokInternal::PoolNode* node = GrokInternal::pool_free[c];
+		if (node)
+		{
+			GrokInternal::pool_free[c] = node->next;
+			counters->bytes_held -= GrokInternal::PoolClassSize(c);
+			++counters->hits;
+			return node;
+		}
+		int taken;
+		node = GrokInternal::PoolDepotTake(c, taken);
+		if (node)
+		{
+			if (!GrokInternal::pool_thread_registered)
+			{
+				GrokInternal::PoolRegisterThread();
+			}
+			GrokInternal::pool_free[c] = node->next;
+			counters->bytes_held += (taken - 1)*GrokInternal::PoolClassSize(c);
+			++counters->hits;
+			return node;
+		}
+		++counters->misses;
+		return GrokInternal::HeapAllocate(GrokInternal::PoolClassSize(c), DEFAULT_ALIGNMENT);
+	}
+
+
+	void PoolFree(void* memory, size_t size) throw()
+	{
+		if (!memory)
+		{
+			return;
+		}
+		register int c = GrokInternal::PoolClass(size);
+		if (c >= GrokInternal::pool_classes)
+		{
+			GrokInternal::HeapFree(memory);
+			return;
+		}
+		register GrokInternal::PoolCounters* counters = GrokInternal::ThreadPoolCounters();
+		if (counters->bytes_held + GrokInternal::PoolClassSize(c) > POOL_CACHE_LIMIT)
+		{
+			GrokInternal::PoolFlush();
+		}
+		if (!GrokInternal::pool_thread_registered)
+		{
+			GrokInternal::PoolRegisterThread();
+		}
+		register GrokInternal::PoolNode* node = static_cast<GrokInternal::PoolNode*>(memory);
+		node->next = GrokInternal::pool_free[c];
+		GrokInternal::pool_free[c] = node;
+		counters->bytes_held += GrokInternal::PoolClassSize(c);
+	}
+
+
+	void PoolTrim() throw()
+	{
+		for (register int c = 0; c < GrokInternal::pool_classes; ++c)
+		{
+			while (GrokInternal::pool_free[c])
+			{
+				register GrokInternal::PoolNode* next = GrokInternal::pool_free[c]->next;
+				GrokInternal::HeapFree(GrokInternal::pool_free[c]);
+				GrokInternal::pool_free[c] = next;
+			}
+		}
+		GrokInternal::ThreadPoolCounters()->bytes_held = 0;
+		for (register int c = 0; c < GrokInternal::pool_classes; ++c)
+		{
+			int taken;
+			for (register GrokInternal::PoolNode* list = GrokInternal::PoolDepotTake(c, taken); list; list = GrokInternal::PoolDepotTake(c, taken))
+			{
+				while (list)
+				{
+					register GrokInternal::PoolNode* next = list->next;
+					GrokInternal::HeapFree(list);
+					list = next;
+				}
+			}
+		}
+	}
+
+
+	sint64 MemoryPlacementFailures() throw()
+	{
+		return AtomicLoad(&GrokInternal::memory_placement_failures);
+	}
+
+
+	PoolStatistics GetPoolStatistics() throw()
+	{
+		PoolStatistics statistics;
+		memset(&statistics, 0, sizeof(PoolStatistics));
+		GrokInternal::SpinLock(&GrokInternal::pool_counters_lock);
+		for (register GrokInternal::PoolCounters* counters = GrokInternal::pool_counters_list; counters; counters = counters->next)
+		{
+			statistics.hits += counters->hits;
+			statistics.misses += counters->misses;
+			statistics.bytes_held += counters->bytes_held;
+		}
+		GrokInternal::SpinUnlock(&GrokInternal::pool_counters_lock);
+		statistics.depot_bytes = static_cast<size_t>(AtomicLoad(&GrokInternal::pool_depot_bytes));
+		return statistics;
+	}
+
+
+	void EnableMemoryTracking(bool enable) throw()
+	{
+		GrokInternal::memory_tracking = enable;
+	}
+
+
+	MemoryStatistics GetMemoryStatistics() throw()
+	{
+		MemoryStatistics statistics;
+		memset(&statistics, 0, sizeof(MemoryStatistics));
+		GrokInternal::SpinLock(&GrokInternal::memory_counters_lock);
+		for (register GrokInternal::MemoryCounters* counters = GrokInternal::memory_counters_list; counters; counters = counters->next)
+		{
+			statistics.live_bytes += counters->live_bytes;
+			statistics.allocations += counters->allocations;
+			statistics.frees += counters->frees;
+			for (register int c = 0; c < MEMORY_SIZE_CLASSES; ++c)
+			{
+				statistics.size_class_allocations[c] += counters->size_class_allocations[c];
+			}
+			for (register int r = 0; r < MEMORY_RATE_CLASSES; ++r)
+			{
+				statistics.rate_histogram[r] += counters->rate_histogram[r];
+			}
+			for (register int t = 0; t < counters->tags; ++t)
+			{
+				register int s = 0;
+				while ((s < statistics.tags) && strcmp(statistics.tag_name[s], counters->tag_name[t]))
+				{
+					++s;
+				}
+				if (s == statistics.tags)
+				{
+					if (s == MEMORY_TAGS)
+					{
+						continue;
+					}
+					statistics.tag_name[s] = counters->tag_name[t];
+					++statistics.tags;
+				}
+				statistics.tag_allocations[s] += counters->tag_allocations[t];
+				statistics.tag_bytes[s] += counters->tag_bytes[t];
+			}
+		}
+		GrokInternal::SpinUnlock(&GrokInternal::memory_counters_lock);
+		statistics.peak_bytes = (GrokInternal::memory_peak_bytes > statistics.live_bytes) ? GrokInternal::memory_peak_bytes : statistics.live_bytes;
+		return statistics;
+	}
+
+
+	void PostMemoryReport(Log& log, LogLevel::ID level) throw(LogException)
+	{
+		MemoryStatistics statistics = GetMemoryStatistics();
+		log.Post(level, "Memory: %.1f MB live, %.1f MB peak, %.0f allocations, %.0f frees", static_cast<double>(statistics.live_bytes)/1048576.0, static_cast<double>(statistics.peak_bytes)/1048576.0, static_cast<double>(statistics.allocations), static_cast<double>(statistics.frees));
+		for (register int c = 0; c < MEMORY_SIZE_CLASSES; ++c)
+		{
+			if (statistics.size_class_allocations[c])
+			{
+				log.Post(level, "  size [%.0f, %.0f) bytes: %.0f allocations", static_cast<double>(static_cast<uint64>(1) << c), static_cast<double>(static_cast<uint64>(2) << c), static_cast<double>(statistics.size_class_allocations[c]));
+			}
+		}
+		for (register int r = 0; r < MEMORY_RATE_CLASSES; ++r)
+		{
+			if (statistics.rate_histogram[r])
+			{
+				log.Post(level, "  rate [%.0f, %.0f) allocations/s: %.0f seconds", static_cast<double>(static_cast<uint64>(1) << r), static_cast<double>(static_cast<uint64>(2) << r), static_cast<double>(statistics.rate_histogram[r]));
+			}
+		}
+		for (register int t = 0; t < statistics.tags; ++t)
+		{
+			log.Post(level, "  tag %s: %.0f allocations, %.1f MB", statistics.tag_name[t], static_cast<double>(statistics.tag_allocations[t]), static_cast<double>(statistics.tag_bytes[t])/1048576.0);
+		}
+	}
+
+
+	MemoryTagScope::MemoryTagScope(const char* tag) throw()
+	:	outer(GrokInternal::memory_tag)
+	{
+		GrokInternal::memory_tag = tag;
+	}
+
+
+	MemoryTagScope::~MemoryTagScope() throw()
+	{
+		GrokInternal::memory_tag = outer;
+	}
 }
 
 
-void operator delete [] (void* objects) throw()
+// Plain new also goes through the heap wrappers, its memory is released by the delete below
+void* operator new (size_t size) throw(std::bad_alloc)
 {
-	#if defined(OS_Windows)
+	register void* memory = GrokInternal::HeapAllocate(size ? size : 1, DEFAULT_ALIGNMENT);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
 
-		_aligned_free(objects);
 
-	#elif defined(OS_MacOSX) || defined(OS_Cygwin) || defined(OS_FreeBSD) || defined(OS_Linux)
+void* operator new [] (size_t size) throw(std::bad_alloc)
+{
+	register void* memory = GrokInternal::HeapAllocate(size ? size : 1, DEFAULT_ALIGNMENT);
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
 
-		free(objects);
 
-	#endif
+void* operator new (size_t size, unsigned short alignment) throw()
+{
+	return GrokInternal::Allocate(size, alignment);
+}
+
+
+void* operator new [] (size_t size, unsigned short alignment) throw()
+{
+	return GrokInternal::Allocate(size, alignment);
+}
+
+
+void* operator new (size_t size, const Grok::MemoryPolicy& policy) throw()
+{
+	return GrokInternal::PolicyAllocate(size, policy);
+}
+
+
+void* operator new [] (size_t size, const Grok::MemoryPolicy& policy) throw()
+{
+	return GrokInternal::PolicyAllocate(size, policy);
+}
+
+
+void operator delete (void* object) throw()
+{
+	GrokInternal::Free(object);
+}
+
+
+void operator delete [] (void* objects) throw()
+{
+	GrokInternal::Free(objects);
 }
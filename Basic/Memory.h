@@ -18,6 +18,8 @@
 #pragma once
 
 #include <Basic/Exception.h>
+#include <Basic/Integer.h>
+#include <Basic/Log.h>
 #include <Basic/System.h>
 
 
@@ -25,12 +27,314 @@
 
 #define USE_ALLOCA_SIZE 1000
 
+#if !defined(POOL_CACHE_LIMIT)
+	#define POOL_CACHE_LIMIT 67108864
+#endif
+
+#if !defined(POOL_DEPOT_LIMIT)
+	#define POOL_DEPOT_LIMIT 268435456
+#endif
+
+#if !defined(POOL_REFILL_BYTES)
+	#define POOL_REFILL_BYTES 65536
+#endif
+
+#if !defined(PARALLEL_FILL_LIMIT)
+	#define PARALLEL_FILL_LIMIT 65536
+#endif
+
+// Milliseconds AvailableMemory() returns its last reading before asking the system again
+#if !defined(AVAILABLE_MEMORY_REFRESH)
+	#define AVAILABLE_MEMORY_REFRESH 100
+#endif
+
+#define MEMORY_SIZE_CLASSES 48
+
+#define MEMORY_RATE_CLASSES 32
+
+#define MEMORY_TAGS 32
+
 
 namespace Grok
 {
 	struct MemoryException : public Exception
 	{
 	};
+
+
+	// Physical memory available to new allocations in bytes, 0 when unknown. Sort() asks before every large
+	// sort, so the system is read at most every AVAILABLE_MEMORY_REFRESH milliseconds.
+	size_t AvailableMemory() throw();
+
+
+	namespace MemoryPages
+	{
+		enum ID
+		{
+			standard,         // Pages chosen by the system
+			transparent_huge, // 2 MB aligned region advised with madvise(MADV_HUGEPAGE)
+			explicit_huge     // mmap(MAP_HUGETLB) from the reserved huge page pool, transparent huge pages when it is exhausted
+		};
+	}
+
+
+	namespace MemoryPlacement
+	{
+		enum ID
+		{
+			first_touch, // Each page lands on the NUMA node of the thread that writes it first
+			interleave,  // Pages round-robin over all the allowed nodes
+			bind         // Every page on one node
+		};
+	}
+
+
+	// Allocation policy for large containers, used with new(policy). Only GNU/Linux honors pages and
+	// placement, elsewhere the memory comes from the aligned heap. Memory is released with delete as usual.
+	struct MemoryPolicy
+	{
+		MemoryPages::ID pages;
+
+		MemoryPlacement::ID placement;
+
+		int node;
+
+		unsigned short alignment;
+
+
+		inline MemoryPolicy(MemoryPages::ID pages = MemoryPages::standard, MemoryPlacement::ID placement = MemoryPlacement::first_touch, int node = 0, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw()
+		:	pages(pages),
+			placement(placement),
+			node(node),
+			alignment(alignment)
+		{
+		}
+	};
+
+
+	// Allocations with new(policy) since the start whose placement other than first_touch the system did
+	// not apply (no NUMA support, node not allowed, or not GNU/Linux), their pages land on first touch
+	sint64 MemoryPlacementFailures() throw();
+
+
+	// Bump allocator over one region reserved up front. While an ArenaScope is alive every new(alignment)
+	// of its thread, such as Vector and Matrix storage or RadixSort scratch, is carved from the arena
+	// (from the heap once the arena is full) and delete of arena memory does nothing. Container blocks
+	// (PoolObject) come from the pool and never from an arena. Leaving the scope releases all that was
+	// allocated inside it at once, so that memory must not outlive the scope nor be deleted from another
+	// thread.
+	struct Arena
+	{
+		char* begin;
+
+		char* end;
+
+		char* top;
+
+
+		Arena(size_t capacity) throw(MemoryException);
+
+
+		~Arena() throw();
+
+
+		inline void* Allocate(size_t size, unsigned short alignment) throw()
+		{
+			register size_t address = (reinterpret_cast<size_t>(top) + alignment - 1) & ~static_cast<size_t>(alignment - 1);
+			if ((address > reinterpret_cast<size_t>(end)) || (size > reinterpret_cast<size_t>(end) - address))
+			{
+				return static_cast<void*>(0);
+			}
+			top = reinterpret_cast<char*>(address + size);
+			return reinterpret_cast<void*>(address);
+		}
+
+
+		inline bool Owns(const void* memory) const throw()
+		{
+			return (static_cast<const char*>(memory) >= begin) && (static_cast<const char*>(memory) < end);
+		}
+
+
+		inline size_t Used() const throw()
+		{
+			return static_cast<size_t>(top - begin);
+		}
+
+
+		inline size_t Capacity() const throw()
+		{
+			return static_cast<size_t>(end - begin);
+		}
+
+
+		inline void Reset() throw()
+		{
+			top = begin;
+		}
+
+
+		private:
+
+			Arena(const Arena&);
+
+
+			Arena& operator = (const Arena&);
+	};
+
+
+	// Installs an arena for the calling thread, scopes nest and are released in reverse order
+	struct ArenaScope
+	{
+		Arena& arena;
+
+		char* mark;
+
+		ArenaScope* outer;
+
+
+		ArenaScope(Arena& arena) throw();
+
+
+		~ArenaScope() throw();
+
+
+		private:
+
+			ArenaScope(const ArenaScope&);
+
+
+			ArenaScope& operator = (const ArenaScope&);
+	};
+
+
+	// Size-class pool for fixed-size blocks. Each thread keeps a free list per class (16 byte steps up to
+	// 1 KB, then powers of two up to 1 MB, larger sizes go straight to the heap) holding at most
+	// POOL_CACHE_LIMIT bytes. Memory may be freed by a different thread than the one that allocated it.
+	// A thread that exits or goes over the limit moves its lists to a shared depot of at most
+	// POOL_DEPOT_LIMIT bytes, where threads missing a class take POOL_REFILL_BYTES of blocks at a time.
+	void* PoolAllocate(size_t size) throw();
+
+
+	void PoolFree(void* memory, size_t size) throw();
+
+
+	// Returns the blocks cached by the calling thread and the shared depot to the heap
+	void PoolTrim() throw();
+
+
+	struct PoolStatistics
+	{
+		size_t hits;
+
+		size_t misses;
+
+		size_t bytes_held;
+
+		size_t depot_bytes;
+	};
+
+
+	// Totals over every thread, finished ones included. bytes_held is what the thread caches hold and
+	// depot_bytes what the depot shared by all threads holds.
+	PoolStatistics GetPoolStatistics() throw();
+
+
+	// Base of the container blocks, routes their new and delete through the pool, bypassing any arena
+	struct PoolObject
+	{
+		static inline void* operator new (size_t size) throw()
+		{
+			return PoolAllocate(size);
+		}
+
+
+		static inline void operator delete (void* object, size_t size) throw()
+		{
+			PoolFree(object, size);
+		}
+	};
+
+
+	// Allocation tracking, off by default so the allocator only pays a flag check. It should be turned on
+	// before the allocations of interest: freeing a block allocated while it was off still subtracts it.
+	// Counters are per thread and merged when the statistics are taken. Live bytes are the sizes reported
+	// by the allocator (not available on Windows, where only the counts are kept).
+	void EnableMemoryTracking(bool enable = true) throw();
+
+
+	struct MemoryStatistics
+	{
+		// Sum of the per-thread counters when the statistics are taken
+		sint64 live_bytes;
+
+		// Highest total seen when a thread published its live bytes, which it does each time they drift
+		// 1 MB from the last time, so the peak can be off either way by up to 1 MB per thread
+		sint64 peak_bytes;
+
+		uint64 allocations;
+
+		uint64 frees;
+
+		// Allocations of [2^c, 2^(c + 1)) bytes
+		uint64 size_class_allocations[MEMORY_SIZE_CLASSES];
+
+		// Seconds in which the allocations were [2^r, 2^(r + 1)), sampled every 256 allocations
+		uint64 rate_histogram[MEMORY_RATE_CLASSES];
+
+		int tags;
+
+		const char* tag_name[MEMORY_TAGS];
+
+		// Allocations and bytes allocated under each tag, frees are not attributed
+		uint64 tag_allocations[MEMORY_TAGS];
+
+		sint64 tag_bytes[MEMORY_TAGS];
+	};
+
+
+	MemoryStatistics GetMemoryStatistics() throw();
+
+
+	void PostMemoryReport(Log& log = message_log, LogLevel::ID level = LogLevel::message) throw(LogException);
+
+
+	// Attributes the allocations of the calling thread to a tag while alive, the name must outlive the
+	// report (a string literal). Only the first MEMORY_TAGS names of each thread get their own counters.
+	struct MemoryTagScope
+	{
+		const char* outer;
+
+
+		MemoryTagScope(const char* tag) throw();
+
+
+		~MemoryTagScope() throw();
+
+
+		private:
+
+			MemoryTagScope(const MemoryTagScope&);
+
+
+			MemoryTagScope& operator = (const MemoryTagScope&);
+	};
+}
+
+
+namespace GrokInternal
+{
+	// Alignment of a new(alignment) or new(policy) allocation, for padding rows
+	inline unsigned short AllocationAlignment(unsigned short alignment) throw()
+	{
+		return alignment;
+	}
+
+
+	inline unsigned short AllocationAlignment(const Grok::MemoryPolicy& policy) throw()
+	{
+		return policy.alignment;
+	}
 }
 
 
@@ -57,6 +361,12 @@ void* operator new (size_t size, unsigned short alignment) throw();
 void* operator new [] (size_t size, unsigned short alignment) throw();
 
 
+void* operator new (size_t size, const Grok::MemoryPolicy& policy) throw();
+
+
+void* operator new [] (size_t size, const Grok::MemoryPolicy& policy) throw();
+
+
 void operator delete (void* object) throw();
 
 
@@ -17,6 +17,638 @@
 
 #include <Basic/Sort.h>
 
+#if defined(_OPENMP)
+	#include <omp.h>
+#endif
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE4_2__)
+	#include <nmmintrin.h>
+#endif
+
+
+namespace GrokInternal
+{
+	using Grok::sint64;
+
+
+	#if defined(_OPENMP)
+
+		// LSD radix sort, 8 bits per pass. Each thread owns a contiguous chunk of the input, counts its own
+		// histogram, and after a prefix sum ordered by (bucket, thread) scatters its chunk, keeping stability.
+		template <typename KEY>
+		void ParallelRadixSort(typename KEY::Bits* __restrict vector, int size) throw(Grok::MemoryException)
+		{
+			typedef typename KEY::Bits Bits;
+
+			const int passes = static_cast<int>(sizeof(Bits));
+			const int max_threads = omp_get_max_threads();
+
+			register Bits* __restrict buffer = new(DEFAULT_ALIGNMENT) Bits[size];
+			register int* __restrict histogram = new(DEFAULT_ALIGNMENT) int[256*max_threads];
+			if ((!buffer) || (!histogram))
+			{
+				delete [] histogram;
+				delete [] buffer;
+				Throw(Grok::MemoryException());
+			}
+
+			#pragma omp parallel num_threads(max_threads)
+			{
+				const int threads = omp_get_num_threads();
+				const int thread = omp_get_thread_num();
+				const int begin = static_cast<int>(static_cast<sint64>(size)*thread/threads);
+				const int end = static_cast<int>(static_cast<sint64>(size)*(thread + 1)/threads);
+
+				register int* __restrict offset = histogram + 256*thread;
+				register Bits* a = vector;
+				register Bits* b = buffer;
+
+				for (int pass = 0; pass < passes; ++pass)
+				{
+					const int shift = 8*pass;
+
+					for (register int h = 0; h < 256; ++h)
+					{
+						offset[h] = 0;
+					}
+					if (pass == 0)
+					{
+						for (register int i = begin; i < end; ++i)
+						{
+							++offset[KEY::Encode(a[i]) & 0xff];
+						}
+					}
+					else
+					{
+						for (register int i = begin; i < end; ++i)
+						{
+							++offset[a[i] >> shift & 0xff];
+						}
+					}
+
+					#pragma omp barrier
+					#pragma omp single
+					{
+						register int count = 0;
+						for (register int h = 0; h < 256; ++h)
+						{
+							for (register int t = 0; t < threads; ++t)
+							{
+								register int tmp = histogram[256*t + h];
+								histogram[256*t + h] = count;
+								count += tmp;
+							}
+						}
+					}
+
+					if (passes == 1)
+					{
+						for (register int i = begin; i < end; ++i)
+						{
+							register Bits value = KEY::Encode(a[i]);
+							b[offset[value & 0xff]++] = KEY::Decode(value);
+						}
+					}
+					else if (pass == 0)
+					{
+						for (register int i = begin; i < end; ++i)
+						{
+							register Bits value = KEY::Encode(a[i]);
+							b[offset[value & 0xff]++] = value;
+						}
+					}
+					else if (pass == passes - 1)
+					{
+						for (register int i = begin; i < end; ++i)
+						{
+							register Bits value = a[i];
+							b[offset[value >> shift & 0xff]++] = KEY::Decode(value);
+						}
+					}
+					else
+					{
+						for (register int i = begin; i < end; ++i)
+						{
+							register Bits value = a[i];
+							b[offset[value >> shift & 0xff]++] = value;
+						}
+					}
+
+					#pragma omp barrier
+
+					register Bits* tmp = a;
+					a = b;
+					b = tmp;
+				}
+
+				if (a != vector)
+				{
+					for (register int i = begin; i < end; ++i)
+					{
+						vector[i] = a[i];
+					}
+				}
+			}
+
+			delete [] histogram;
+			delete [] buffer;
+		}
+
+	#endif
+
+
+	template <typename KEY>
+	void InPlaceRadixSort(typename KEY::Bits* __restrict vector, int size) throw()
+	{
+		typedef typename KEY::Bits Bits;
+
+		for (register int i = 0; i < size; ++i)
+		{
+			vector[i] = KEY::Encode(vector[i]);
+		}
+		AmericanFlagSort(vector, size, 8*static_cast<int>(sizeof(Bits)) - 8, RadixEncodedValue<Bits>());
+		for (register int i = 0; i < size; ++i)
+		{
+			vector[i] = KEY::Decode(vector[i]);
+		}
+	}
+
+
+	#if defined(__AVX2__)
+
+		struct SimdSint32
+		{
+			typedef Grok::sint32 Scalar;
+			typedef Grok::sint32 Lane;
+			typedef __m256i Register;
+			enum {lanes = 8};
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a);
+			}
+
+			static inline Register Mask(const Lane* p) throw()
+			{
+				return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			}
+
+			static inline Register Min(Register a, Register b) throw()
+			{
+				return _mm256_min_epi32(a, b);
+			}
+
+			static inline Register Max(Register a, Register b) throw()
+			{
+				return _mm256_max_epi32(a, b);
+			}
+
+			static inline Register Select(Register a, Register b, Register mask) throw()
+			{
+				return _mm256_blendv_epi8(b, a, mask);
+			}
+
+			static inline Register Partner(Register a, int j) throw()
+			{
+				switch (j)
+				{
+					case 1: return _mm256_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1));
+					case 2: return _mm256_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+					default: return _mm256_permute2x128_si256(a, a, 1);
+				}
+			}
+		};
+
+
+		struct SimdSint64
+		{
+			typedef Grok::sint64 Scalar;
+			typedef Grok::sint64 Lane;
+			typedef __m256i Register;
+			enum {lanes = 4};
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a);
+			}
+
+			static inline Register Mask(const Lane* p) throw()
+			{
+				return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			}
+
+			static inline Register Min(Register a, Register b) throw()
+			{
+				return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+			}
+
+			static inline Register Max(Register a, Register b) throw()
+			{
+				return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+			}
+
+			static inline Register Select(Register a, Register b, Register mask) throw()
+			{
+				return _mm256_blendv_epi8(b, a, mask);
+			}
+
+			static inline Register Partner(Register a, int j) throw()
+			{
+				return (j == 1) ? _mm256_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)) : _mm256_permute2x128_si256(a, a, 1);
+			}
+		};
+
+
+		struct SimdFloat
+		{
+			typedef float Scalar;
+			typedef Grok::sint32 Lane;
+			typedef __m256 Register;
+			enum {lanes = 8};
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm256_loadu_ps(p);
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm256_storeu_ps(p, a);
+			}
+
+			static inline Register Mask(const Lane* p) throw()
+			{
+				return _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+			}
+
+			static inline Register Min(Register a, Register b) throw()
+			{
+				return _mm256_min_ps(a, b);
+			}
+
+			static inline Register Max(Register a, Register b) throw()
+			{
+				return _mm256_max_ps(a, b);
+			}
+
+			static inline Register Select(Register a, Register b, Register mask) throw()
+			{
+				return _mm256_blendv_ps(b, a, mask);
+			}
+
+			static inline Register Partner(Register a, int j) throw()
+			{
+				switch (j)
+				{
+					case 1: return _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+					case 2: return _mm256_permute_ps(a, _MM_SHUFFLE(1, 0, 3, 2));
+					default: return _mm256_permute2f128_ps(a, a, 1);
+				}
+			}
+		};
+
+
+		struct SimdDouble
+		{
+			typedef double Scalar;
+			typedef Grok::sint64 Lane;
+			typedef __m256d Register;
+			enum {lanes = 4};
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm256_loadu_pd(p);
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm256_storeu_pd(p, a);
+			}
+
+			static inline Register Mask(const Lane* p) throw()
+			{
+				return _mm256_castsi256_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+			}
+
+			static inline Register Min(Register a, Register b) throw()
+			{
+				return _mm256_min_pd(a, b);
+			}
+
+			static inline Register Max(Register a, Register b) throw()
+			{
+				return _mm256_max_pd(a, b);
+			}
+
+			static inline Register Select(Register a, Register b, Register mask) throw()
+			{
+				return _mm256_blendv_pd(b, a, mask);
+			}
+
+			static inline Register Partner(Register a, int j) throw()
+			{
+				return (j == 1) ? _mm256_permute_pd(a, 5) : _mm256_permute2f128_pd(a, a, 1);
+			}
+		};
+
+	#elif defined(__SSE4_2__)
+
+		struct SimdSint32
+		{
+			typedef Grok::sint32 Scalar;
+			typedef Grok::sint32 Lane;
+			typedef __m128i Register;
+			enum {lanes = 4};
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p), a);
+			}
+
+			static inline Register Mask(const Lane* p) throw()
+			{
+				return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			}
+
+			static inline Register Min(Register a, Register b) throw()
+			{
+				return _mm_min_epi32(a, b);
+			}
+
+			static inline Register Max(Register a, Register b) throw()
+			{
+				return _mm_max_epi32(a, b);
+			}
+
+			static inline Register Select(Register a, Register b, Register mask) throw()
+			{
+				return _mm_blendv_epi8(b, a, mask);
+			}
+
+			static inline Register Partner(Register a, int j) throw()
+			{
+				return (j == 1) ? _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)) : _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+			}
+		};
+
+
+		struct SimdSint64
+		{
+			typedef Grok::sint64 Scalar;
+			typedef Grok::sint64 Lane;
+			typedef __m128i Register;
+			enum {lanes = 2};
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(p), a);
+			}
+
+			static inline Register Mask(const Lane* p) throw()
+			{
+				return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			}
+
+			static inline Register Min(Register a, Register b) throw()
+			{
+				return _mm_blendv_epi8(a, b, _mm_cmpgt_epi64(a, b));
+			}
+
+			static inline Register Max(Register a, Register b) throw()
+			{
+				return _mm_blendv_epi8(b, a, _mm_cmpgt_epi64(a, b));
+			}
+
+			static inline Register Select(Register a, Register b, Register mask) throw()
+			{
+				return _mm_blendv_epi8(b, a, mask);
+			}
+
+			static inline Register Partner(Register a, int) throw()
+			{
+				return _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2));
+			}
+		};
+
+
+		struct SimdFloat
+		{
+			typedef float Scalar;
+			typedef Grok::sint32 Lane;
+			typedef __m128 Register;
+			enum {lanes = 4};
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm_loadu_ps(p);
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm_storeu_ps(p, a);
+			}
+
+			static inline Register Mask(const Lane* p) throw()
+			{
+				return _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+			}
+
+			static inline Register Min(Register a, Register b) throw()
+			{
+				return _mm_min_ps(a, b);
+			}
+
+			static inline Register Max(Register a, Register b) throw()
+			{
+				return _mm_max_ps(a, b);
+			}
+
+			static inline Register Select(Register a, Register b, Register mask) throw()
+			{
+				return _mm_blendv_ps(b, a, mask);
+			}
+
+			static inline Register Partner(Register a, int j) throw()
+			{
+				return (j == 1) ? _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)) : _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 3, 2));
+			}
+		};
+
+
+		struct SimdDouble
+		{
+			typedef double Scalar;
+			typedef Grok::sint64 Lane;
+			typedef __m128d Register;
+			enum {lanes = 2};
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm_loadu_pd(p);
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm_storeu_pd(p, a);
+			}
+
+			static inline Register Mask(const Lane* p) throw()
+			{
+				return _mm_castsi128_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+			}
+
+			static inline Register Min(Register a, Register b) throw()
+			{
+				return _mm_min_pd(a, b);
+			}
+
+			static inline Register Max(Register a, Register b) throw()
+			{
+				return _mm_max_pd(a, b);
+			}
+
+			static inline Register Select(Register a, Register b, Register mask) throw()
+			{
+				return _mm_blendv_pd(b, a, mask);
+			}
+
+			static inline Register Partner(Register a, int) throw()
+			{
+				return _mm_shuffle_pd(a, a, 1);
+			}
+		};
+
+	#endif
+
+
+	#if defined(__AVX2__) || defined(__SSE4_2__)
+
+		// Bitonic sorting network (K. E. Batcher. Sorting networks and their applications. AFIPS Spring
+		// Joint Computer Conference, pp. 307-314. 1968) over SIMD registers. The input is padded to a
+		// power of two with its maximum. Exchanges between elements at least one register apart are
+		// whole-register min/max, closer ones use a lane permutation and a blend.
+		template <typename SIMD>
+		void BitonicSort(typename SIMD::Scalar* __restrict vector, int size) throw()
+		{
+			typedef typename SIMD::Scalar Scalar;
+			typedef typename SIMD::Lane Lane;
+			typedef typename SIMD::Register Register;
+
+			const int lanes = SIMD::lanes;
+
+			register int count = lanes;
+			while (count < size)
+			{
+				count <<= 1;
+			}
+			const int registers = count/lanes;
+
+			Scalar padded[SORT_NETWORK_LIMIT];
+			register Scalar maximum = vector[0];
+			for (register int i = 0; i < size; ++i)
+			{
+				padded[i] = vector[i];
+				if (maximum < vector[i])
+				{
+					maximum = vector[i];
+				}
+			}
+			for (register int i = size; i < count; ++i)
+			{
+				padded[i] = maximum;
+			}
+
+			Register r[SORT_NETWORK_LIMIT/SIMD::lanes];
+			for (register int q = 0; q < registers; ++q)
+			{
+				r[q] = SIMD::Load(padded + q*lanes);
+			}
+
+			for (int k = 2; k <= count; k <<= 1)
+			{
+				for (int j = k >> 1; j > 0; j >>= 1)
+				{
+					if (j >= lanes)
+					{
+						const int distance = j/lanes;
+						for (register int q = 0; q < registers; ++q)
+						{
+							if (!(q & distance))
+							{
+								register Register low = SIMD::Min(r[q], r[q + distance]);
+								register Register high = SIMD::Max(r[q], r[q + distance]);
+								if (!((q*lanes) & k))
+								{
+									r[q] = low;
+									r[q + distance] = high;
+								}
+								else
+								{
+									r[q] = high;
+									r[q + distance] = low;
+								}
+							}
+						}
+					}
+					else
+					{
+						// Lane i keeps the minimum when it is the lower index of an ascending pair or the upper one of a descending pair
+						Lane ascending[lanes];
+						Lane descending[lanes];
+						for (register int l = 0; l < lanes; ++l)
+						{
+							register bool lower = !(l & j);
+							ascending[l] = (lower == !(l & k)) ? -1 : 0;
+							descending[l] = (lower == !(l & k)) ? 0 : -1;
+						}
+						const Register ascending_mask = SIMD::Mask(ascending);
+						const Register descending_mask = SIMD::Mask(descending);
+						for (register int q = 0; q < registers; ++q)
+						{
+							register Register partner = SIMD::Partner(r[q], j);
+							register Register low = SIMD::Min(r[q], partner);
+							register Register high = SIMD::Max(r[q], partner);
+							r[q] = SIMD::Select(low, high, ((k < lanes) || !((q*lanes) & k)) ? ascending_mask : descending_mask);
+						}
+					}
+				}
+			}
+
+			for (register int q = 0; q < registers; ++q)
+			{
+				SIMD::Store(padded + q*lanes, r[q]);
+			}
+			for (register int i = 0; i < size; ++i)
+			{
+				vector[i] = padded[i];
+			}
+		}
+
+	#endif
+}
+
 
 namespace Grok
 {
@@ -884,4 +1516,418 @@ namespace Grok
 
 		delete [] b;
 	}
+
+
+	#if defined(_OPENMP)
+
+		void ParallelRadixSort(uint8* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixUnsigned<uint8> >(vector, size);
+		}
+
+
+		void ParallelRadixSort(sint8* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixSigned<uint8> >(reinterpret_cast<uint8*>(vector), size);
+		}
+
+
+		void ParallelRadixSort(uint16* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixUnsigned<uint16> >(vector, size);
+		}
+
+
+		void ParallelRadixSort(sint16* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixSigned<uint16> >(reinterpret_cast<uint16*>(vector), size);
+		}
+
+
+		void ParallelRadixSort(uint32* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixUnsigned<uint32> >(vector, size);
+		}
+
+
+		void ParallelRadixSort(sint32* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixSigned<uint32> >(reinterpret_cast<uint32*>(vector), size);
+		}
+
+
+		void ParallelRadixSort(uint64* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixUnsigned<uint64> >(vector, size);
+		}
+
+
+		void ParallelRadixSort(sint64* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixSigned<uint64> >(reinterpret_cast<uint64*>(vector), size);
+		}
+
+
+		void ParallelRadixSort(float* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixFloat>(reinterpret_cast<uint32*>(vector), size);
+		}
+
+
+		void ParallelRadixSort(double* vector, int size) throw(MemoryException)
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			GrokInternal::ParallelRadixSort<GrokInternal::RadixDouble>(reinterpret_cast<uint64*>(vector), size);
+		}
+
+	#else
+
+		void ParallelRadixSort(uint8* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(sint8* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(uint16* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(sint16* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(uint32* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(sint32* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(uint64* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(sint64* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(float* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+
+		void ParallelRadixSort(double* vector, int size) throw(MemoryException)
+		{
+			RadixSort(vector, size);
+		}
+
+	#endif
+
+
+	void InPlaceRadixSort(uint8* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixUnsigned<uint8> >(vector, size);
+	}
+
+
+	void InPlaceRadixSort(sint8* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixSigned<uint8> >(reinterpret_cast<uint8*>(vector), size);
+	}
+
+
+	void InPlaceRadixSort(uint16* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixUnsigned<uint16> >(vector, size);
+	}
+
+
+	void InPlaceRadixSort(sint16* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixSigned<uint16> >(reinterpret_cast<uint16*>(vector), size);
+	}
+
+
+	void InPlaceRadixSort(uint32* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixUnsigned<uint32> >(vector, size);
+	}
+
+
+	void InPlaceRadixSort(sint32* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixSigned<uint32> >(reinterpret_cast<uint32*>(vector), size);
+	}
+
+
+	void InPlaceRadixSort(uint64* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixUnsigned<uint64> >(vector, size);
+	}
+
+
+	void InPlaceRadixSort(sint64* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixSigned<uint64> >(reinterpret_cast<uint64*>(vector), size);
+	}
+
+
+	void InPlaceRadixSort(float* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixFloat>(reinterpret_cast<uint32*>(vector), size);
+	}
+
+
+	void InPlaceRadixSort(double* vector, int size) throw()
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		GrokInternal::InPlaceRadixSort<GrokInternal::RadixDouble>(reinterpret_cast<uint64*>(vector), size);
+	}
+
+
+	#if defined(__AVX2__) || defined(__SSE4_2__)
+
+		void NetworkSort(sint32* vector, int size) throw()
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			if ((size > 1) && (size <= SORT_NETWORK_LIMIT))
+			{
+				GrokInternal::BitonicSort<GrokInternal::SimdSint32>(vector, size);
+			}
+			else
+			{
+				CombSort(vector, size);
+			}
+		}
+
+
+		void NetworkSort(sint64* vector, int size) throw()
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			if ((size > 1) && (size <= SORT_NETWORK_LIMIT))
+			{
+				GrokInternal::BitonicSort<GrokInternal::SimdSint64>(vector, size);
+			}
+			else
+			{
+				CombSort(vector, size);
+			}
+		}
+
+
+		void NetworkSort(float* vector, int size) throw()
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			if ((size > 1) && (size <= SORT_NETWORK_LIMIT))
+			{
+				GrokInternal::BitonicSort<GrokInternal::SimdFloat>(vector, size);
+			}
+			else
+			{
+				CombSort(vector, size);
+			}
+		}
+
+
+		void NetworkSort(double* vector, int size) throw()
+		{
+			Assert(vector);
+			Assert(size >= 0);
+
+			if ((size > 1) && (size <= SORT_NETWORK_LIMIT))
+			{
+				GrokInternal::BitonicSort<GrokInternal::SimdDouble>(vector, size);
+			}
+			else
+			{
+				CombSort(vector, size);
+			}
+		}
+
+	#else
+
+		void NetworkSort(sint32* vector, int size) throw()
+		{
+			CombSort(vector, size);
+		}
+
+
+		void NetworkSort(sint64* vector, int size) throw()
+		{
+			CombSort(vector, size);
+		}
+
+
+		void NetworkSort(float* vector, int size) throw()
+		{
+			CombSort(vector, size);
+		}
+
+
+		void NetworkSort(double* vector, int size) throw()
+		{
+			CombSort(vector, size);
+		}
+
+	#endif
+}
+
+
+namespace GrokInternal
+{
+	#if defined(__AVX2__) || defined(__SSE4_2__)
+
+		bool TryNetworkSort(Grok::sint32* vector, int size) throw()
+		{
+			if (size > SORT_NETWORK_LIMIT)
+			{
+				return false;
+			}
+			Grok::NetworkSort(vector, size);
+			return true;
+		}
+
+
+		bool TryNetworkSort(Grok::sint64* vector, int size) throw()
+		{
+			if (size > SORT_NETWORK_LIMIT)
+			{
+				return false;
+			}
+			Grok::NetworkSort(vector, size);
+			return true;
+		}
+
+
+		bool TryNetworkSort(float* vector, int size) throw()
+		{
+			if (size > SORT_NETWORK_LIMIT)
+			{
+				return false;
+			}
+			Grok::NetworkSort(vector, size);
+			return true;
+		}
+
+
+		bool TryNetworkSort(double* vector, int size) throw()
+		{
+			if (size > SORT_NETWORK_LIMIT)
+			{
+				return false;
+			}
+			Grok::NetworkSort(vector, size);
+			return true;
+		}
+
+	#else
+
+		bool TryNetworkSort(Grok::sint32*, int) throw()
+		{
+			return false;
+		}
+
+
+		bool TryNetworkSort(Grok::sint64*, int) throw()
+		{
+			return false;
+		}
+
+
+		bool TryNetworkSort(float*, int) throw()
+		{
+			return false;
+		}
+
+
+		bool TryNetworkSort(double*, int) throw()
+		{
+			return false;
+		}
+
+	#endif
 }
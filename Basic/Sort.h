@@ -22,10 +22,746 @@
 #include <Basic/Memory.h>
 #include <Container/Vector.h>
 
+// Size from which radix sorts beat CombSort and insertion sort (Benchmark/SortBenchmark)
 #if !defined(SORT_RADIX_COMB_LIMIT)
 	#define SORT_RADIX_COMB_LIMIT 64
 #endif
 
+#if !defined(SORT_RADIX_PARALLEL_LIMIT)
+	#define SORT_RADIX_PARALLEL_LIMIT 262144
+#endif
+
+#if !defined(SORT_RADIX_MEMORY_CHECK_LIMIT)
+	#define SORT_RADIX_MEMORY_CHECK_LIMIT 262144
+#endif
+
+#if !defined(SORT_RADIX_RECORD_MOVE_LIMIT)
+	#define SORT_RADIX_RECORD_MOVE_LIMIT 32
+#endif
+
+// Largest size sorted by the bitonic network, a power of 2. Sort() uses the network up to this size when
+// the library is built with SSE4.2/AVX2 and RadixSort above (Benchmark/SortBenchmark).
+#if !defined(SORT_NETWORK_LIMIT)
+	#define SORT_NETWORK_LIMIT 128
+#endif
+
+#if !defined(SORT_MERGE_NETWORK_LIMIT)
+	#define SORT_MERGE_NETWORK_LIMIT 8
+#endif
+
+#if !defined(SORT_MERGE_PARALLEL_LIMIT)
+	#define SORT_MERGE_PARALLEL_LIMIT 16384
+#endif
+
+#if !defined(SORT_MERGE_PARALLEL_GRAIN)
+	#define SORT_MERGE_PARALLEL_GRAIN 4096
+#endif
+
+
+namespace GrokInternal
+{
+	// Bijections from each key type to an unsigned integer with the same order
+	template <typename BITS>
+	struct RadixUnsigned
+	{
+		enum {sortable = true};
+
+		typedef BITS Bits;
+
+		static inline BITS Encode(BITS value) throw()
+		{
+			return value;
+		}
+
+		static inline BITS Decode(BITS value) throw()
+		{
+			return value;
+		}
+	};
+
+
+	template <typename BITS>
+	struct RadixSigned
+	{
+		enum {sortable = true};
+
+		typedef BITS Bits;
+
+		static inline BITS Encode(BITS value) throw()
+		{
+			return static_cast<BITS>(value ^ (static_cast<BITS>(1) << (8*sizeof(BITS) - 1)));
+		}
+
+		static inline BITS Decode(BITS value) throw()
+		{
+			return static_cast<BITS>(value ^ (static_cast<BITS>(1) << (8*sizeof(BITS) - 1)));
+		}
+	};
+
+
+	struct RadixFloat
+	{
+		enum {sortable = true};
+
+		typedef Grok::uint32 Bits;
+
+		static inline Grok::uint32 Encode(Grok::uint32 value) throw()
+		{
+			return value ^ (static_cast<Grok::uint32>(-Grok::sint32(value >> 31)) | 0x80000000); // Michael Herf. Radix Tricks. 2001. http://stereopsis.com/radix.html
+		}
+
+		static inline Grok::uint32 Decode(Grok::uint32 value) throw()
+		{
+			return value ^ (((value >> 31) - 1) | 0x80000000); // Michael Herf. Radix Tricks. 2001. http://stereopsis.com/radix.html
+		}
+	};
+
+
+	struct RadixDouble
+	{
+		enum {sortable = true};
+
+		typedef Grok::uint64 Bits;
+
+		static inline Grok::uint64 Encode(Grok::uint64 value) throw()
+		{
+			return value ^ (static_cast<Grok::uint64>(-static_cast<Grok::sint64>(value >> 63)) | 0x8000000000000000); // Michael Herf. Radix Tricks. 2001. http://stereopsis.com/radix.html
+		}
+
+		static inline Grok::uint64 Decode(Grok::uint64 value) throw()
+		{
+			return value ^ (((value >> 63) - 1) | 0x8000000000000000); // Michael Herf. Radix Tricks. 2001. http://stereopsis.com/radix.html
+		}
+	};
+
+
+	template <typename KEY>
+	struct RadixKey
+	{
+		enum {sortable = false};
+	};
+
+
+	template <>
+	struct RadixKey<Grok::uint8> : public RadixUnsigned<Grok::uint8>
+	{
+	};
+
+
+	template <>
+	struct RadixKey<Grok::sint8> : public RadixSigned<Grok::uint8>
+	{
+	};
+
+
+	template <>
+	struct RadixKey<Grok::uint16> : public RadixUnsigned<Grok::uint16>
+	{
+	};
+
+
+	template <>
+	struct RadixKey<Grok::sint16> : public RadixSigned<Grok::uint16>
+	{
+	};
+
+
+	template <>
+	struct RadixKey<Grok::uint32> : public RadixUnsigned<Grok::uint32>
+	{
+	};
+
+
+	template <>
+	struct RadixKey<Grok::sint32> : public RadixSigned<Grok::uint32>
+	{
+	};
+
+
+	template <>
+	struct RadixKey<Grok::uint64> : public RadixUnsigned<Grok::uint64>
+	{
+	};
+
+
+	template <>
+	struct RadixKey<Grok::sint64> : public RadixSigned<Grok::uint64>
+	{
+	};
+
+
+	template <>
+	struct RadixKey<float> : public RadixFloat
+	{
+	};
+
+
+	template <>
+	struct RadixKey<double> : public RadixDouble
+	{
+	};
+
+
+	template <typename KEY>
+	inline typename RadixKey<KEY>::Bits RadixEncode(KEY key) throw()
+	{
+		union
+		{
+			KEY key;
+			typename RadixKey<KEY>::Bits bits;
+		} value;
+		value.key = key;
+		return RadixKey<KEY>::Encode(value.bits);
+	}
+
+
+	template <typename KEY>
+	inline KEY RadixDecode(typename RadixKey<KEY>::Bits bits) throw()
+	{
+		union
+		{
+			KEY key;
+			typename RadixKey<KEY>::Bits bits;
+		} value;
+		value.bits = RadixKey<KEY>::Decode(bits);
+		return value.key;
+	}
+
+
+	template <typename BITS>
+	struct RadixEncodedValue
+	{
+		typedef BITS Bits;
+
+		inline BITS operator () (BITS value) const throw()
+		{
+			return value;
+		}
+	};
+
+
+	template <typename KEY>
+	struct RadixValue
+	{
+		typedef typename RadixKey<KEY>::Bits Bits;
+
+		inline Bits operator () (KEY value) const throw()
+		{
+			return RadixEncode(value);
+		}
+	};
+
+
+	template <typename BITS>
+	struct RadixPair
+	{
+		BITS value;
+
+		int index;
+	};
+
+
+	template <typename TYPE, typename KEY>
+	struct RadixMemberKey
+	{
+		typedef typename RadixKey<KEY>::Bits Bits;
+
+		KEY TYPE::* key;
+
+		inline RadixMemberKey(KEY TYPE::* key) throw()
+		:	key(key)
+		{
+		}
+
+		inline Bits operator () (const TYPE& record) const throw()
+		{
+			return RadixEncode(record.*key);
+		}
+	};
+
+
+	// Turns the digit counts of every pass into scatter offsets and flags the passes that reorder
+	// something, a pass whose keys all fall in one bucket is skipped. Returns the number of active passes.
+	inline int RadixOffsets(int (*histogram)[256], bool* active, int passes, int size) throw()
+	{
+		register int active_passes = 0;
+		for (register int p = 0; p < passes; ++p)
+		{
+			register int count = 0;
+			active[p] = true;
+			for (register int h = 0; h < 256; ++h)
+			{
+				register int tmp = histogram[p][h];
+				if (tmp == size)
+				{
+					active[p] = false;
+				}
+				histogram[p][h] = count;
+				count += tmp;
+			}
+			if (active[p])
+			{
+				++active_passes;
+			}
+		}
+		return active_passes;
+	}
+
+
+	// Stable LSD passes over (key, index) pairs, ping-ponging between pairs and buffer. Returns the
+	// array that holds the sorted result.
+	template <typename BITS>
+	RadixPair<BITS>* RadixSortPairs(RadixPair<BITS>* pairs, RadixPair<BITS>* buffer, int size, int (*histogram)[256], const bool* active) throw()
+	{
+		register RadixPair<BITS>* a = pairs;
+		register RadixPair<BITS>* b = buffer;
+		for (int p = 0; p < static_cast<int>(sizeof(BITS)); ++p)
+		{
+			if (active[p])
+			{
+				register int* __restrict offset = histogram[p];
+				for (register int i = 0; i < size; ++i)
+				{
+					b[offset[static_cast<int>(a[i].value >> 8*p & 0xff)]++] = a[i];
+				}
+				register RadixPair<BITS>* tmp = a;
+				a = b;
+				b = tmp;
+			}
+		}
+		return a;
+	}
+
+
+	// American flag sort: in-place MSD radix sort, 8 bits per level, permuting each bucket by cycle
+	// leaders so no scratch array is needed. Not stable. P. McIlroy, K. Bostic, M. McIlroy.
+	// Engineering Radix Sort. Computing Systems, Vol. 6, pp. 5-27. 1993.
+	template <typename TYPE, typename EXTRACT>
+	void AmericanFlagSort(TYPE* __restrict vector, int size, int shift, const EXTRACT& extract) throw()
+	{
+		typedef typename EXTRACT::Bits Bits;
+
+		while (size >= SORT_RADIX_COMB_LIMIT)
+		{
+			int head[256] = {0};
+			int tail[256];
+
+			for (register int i = 0; i < size; ++i)
+			{
+				++head[static_cast<int>(extract(vector[i]) >> shift & 0xff)];
+			}
+
+			register int h = 0;
+			while (!head[h])
+			{
+				++h;
+			}
+			if (head[h] == size)
+			{
+				if (shift == 0)
+				{
+					return;
+				}
+				shift -= 8;
+				continue;
+			}
+
+			{
+				register int count = 0;
+				for (h = 0; h < 256; ++h)
+				{
+					tail[h] = count + head[h];
+					head[h] = count;
+					count = tail[h];
+				}
+			}
+
+			for (h = 0; h < 256; ++h)
+			{
+				while (head[h] < tail[h])
+				{
+					TYPE value = vector[head[h]];
+					register int d = static_cast<int>(extract(value) >> shift & 0xff);
+					while (d != h)
+					{
+						TYPE tmp = vector[head[d]];
+						vector[head[d]++] = value;
+						value = tmp;
+						d = static_cast<int>(extract(value) >> shift & 0xff);
+					}
+					vector[head[h]++] = value;
+				}
+			}
+
+			if (shift > 0)
+			{
+				register int begin = 0;
+				for (h = 0; h < 256; ++h)
+				{
+					if (tail[h] - begin > 1)
+					{
+						AmericanFlagSort(vector + begin, tail[h] - begin, shift - 8, extract);
+					}
+					begin = tail[h];
+				}
+			}
+			return;
+		}
+
+		// Insertion sort, keys already agree on every digit above shift
+		for (register int i = 1; i < size; ++i)
+		{
+			TYPE value = vector[i];
+			register Bits key = extract(value);
+			register int j = i;
+			while ((j > 0) && (key < extract(vector[j - 1])))
+			{
+				vector[j] = vector[j - 1];
+				--j;
+			}
+			vector[j] = value;
+		}
+	}
+
+
+	template <typename TYPE>
+	struct Less
+	{
+		inline bool operator () (const TYPE& a, const TYPE& b) const
+		{
+			return a < b;
+		}
+	};
+
+
+	// Odd-even transposition network, only neighbours are exchanged so equal elements keep their order
+	template <typename TYPE, typename COMPARE>
+	inline void SortingNetwork(TYPE* __restrict vector, int size, const COMPARE& compare)
+	{
+		for (register int round = 0; round < size; ++round)
+		{
+			for (register int i = round & 1; i < size - 1; i += 2)
+			{
+				if (compare(vector[i + 1], vector[i]))
+				{
+					TYPE tmp = vector[i];
+					vector[i] = vector[i + 1];
+					vector[i + 1] = tmp;
+				}
+			}
+		}
+	}
+
+
+	// How many elements of a are among the first diagonal outputs of the stable merge of a and b.
+	// S. Odeh, O. Green, Z. Mwassi, O. Shmueli, Y. Birk. Merge Path - Parallel Merging Made Simple.
+	// IPDPS Workshops, pp. 1611-1618. 2012.
+	template <typename TYPE, typename COMPARE>
+	inline int MergeCoRank(const TYPE* a, int a_size, const TYPE* b, int b_size, int diagonal, const COMPARE& compare)
+	{
+		register int low = (diagonal > b_size) ? diagonal - b_size : 0;
+		register int high = (diagonal < a_size) ? diagonal : a_size;
+		while (low < high)
+		{
+			register int middle = (low + high) >> 1;
+			if (compare(b[diagonal - middle - 1], a[middle]))
+			{
+				high = middle;
+			}
+			else
+			{
+				low = middle + 1;
+			}
+		}
+		return low;
+	}
+
+
+	// Stable merge, on ties the element of a goes first
+	template <typename TYPE, typename COMPARE>
+	inline void Merge(const TYPE* __restrict a, int a_size, const TYPE* __restrict b, int b_size, TYPE* __restrict output, const COMPARE& compare)
+	{
+		register int i = 0;
+		register int j = 0;
+		while ((i < a_size) && (j < b_size))
+		{
+			if (compare(b[j], a[i]))
+			{
+				*output++ = b[j++];
+			}
+			else
+			{
+				*output++ = a[i++];
+			}
+		}
+		while (i < a_size)
+		{
+			*output++ = a[i++];
+		}
+		while (j < b_size)
+		{
+			*output++ = b[j++];
+		}
+	}
+
+
+	// MergeSort() with a buffer of size elements, none is needed up to SORT_MERGE_NETWORK_LIMIT elements
+	template <typename TYPE, typename COMPARE>
+	void MergeSort(TYPE* vector, int size, TYPE* buffer, const COMPARE& compare)
+	{
+		const int network = SORT_MERGE_NETWORK_LIMIT;
+		const int blocks = (size + network - 1)/network;
+		const bool parallel = (size >= SORT_MERGE_PARALLEL_LIMIT);
+
+		#if defined(_OPENMP)
+			#pragma omp parallel for schedule(static) if (parallel)
+		#endif
+		for (int b = 0; b < blocks; ++b)
+		{
+			register int start = b*network;
+			SortingNetwork(vector + start, (size - start < network) ? size - start : network, compare);
+		}
+		if (size <= network)
+		{
+			return;
+		}
+
+		const int grain = parallel ? SORT_MERGE_PARALLEL_GRAIN : size;
+		TYPE* source = vector;
+		TYPE* target = buffer;
+		for (int width = network; width < size; width = (width > size/2) ? size : 2*width)
+		{
+			const int segments = (size - 1)/width/2 + 1;
+			const int pieces = static_cast<int>((2*static_cast<Grok::sint64>(width) - 1)/grain + 1);
+			const int tasks = segments*pieces;
+
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (parallel && (tasks > 1))
+			#endif
+			for (int t = 0; t < tasks; ++t)
+			{
+				const int start = 2*(t/pieces)*width;
+				const int a_size = (size - start > width) ? width : size - start;
+				const int b_size = (size - start - a_size > width) ? width : size - start - a_size;
+				const int length = a_size + b_size;
+				const Grok::sint64 begin = static_cast<Grok::sint64>(t % pieces)*grain;
+				if (begin < length)
+				{
+					const int d0 = static_cast<int>(begin);
+					const int d1 = (length - d0 > grain) ? d0 + grain : length;
+					const TYPE* a = source + start;
+					const TYPE* b = a + a_size;
+					const int i0 = MergeCoRank(a, a_size, b, b_size, d0, compare);
+					const int i1 = MergeCoRank(a, a_size, b, b_size, d1, compare);
+					Merge(a + i0, i1 - i0, b + d0 - i0, (d1 - i1) - (d0 - i0), target + start + d0, compare);
+				}
+			}
+
+			TYPE* tmp = source;
+			source = target;
+			target = tmp;
+		}
+
+		if (source != vector)
+		{
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (parallel)
+			#endif
+			for (int i = 0; i < size; ++i)
+			{
+				vector[i] = source[i];
+			}
+		}
+	}
+
+
+	// MSD radix selection: the elements whose digit is below the digit of the k-th element are moved
+	// before it and those above after it, then only its bucket is refined with the next digit.
+	template <typename TYPE, typename EXTRACT>
+	void RadixSelect(TYPE* __restrict vector, int size, int k, int shift, const EXTRACT& extract) throw()
+	{
+		typedef typename EXTRACT::Bits Bits;
+
+		while (size >= SORT_RADIX_COMB_LIMIT)
+		{
+			int count[256] = {0};
+			for (register int i = 0; i < size; ++i)
+			{
+				++count[static_cast<int>(extract(vector[i]) >> shift & 0xff)];
+			}
+
+			register int digit = 0;
+			register int below = 0;
+			while (below + count[digit] <= k)
+			{
+				below += count[digit];
+				++digit;
+			}
+
+			if (count[digit] < size)
+			{
+				// Three-way partition by digit
+				register int less = 0;
+				register int greater = size;
+				register int i = 0;
+				while (i < greater)
+				{
+					register int d = static_cast<int>(extract(vector[i]) >> shift & 0xff);
+					if (d < digit)
+					{
+						TYPE tmp = vector[less];
+						vector[less++] = vector[i];
+						vector[i++] = tmp;
+					}
+					else if (d > digit)
+					{
+						TYPE tmp = vector[--greater];
+						vector[greater] = vector[i];
+						vector[i] = tmp;
+					}
+					else
+					{
+						++i;
+					}
+				}
+				vector += less;
+				size = greater - less;
+				k -= less;
+			}
+			if (shift == 0)
+			{
+				return;
+			}
+			shift -= 8;
+		}
+
+		for (register int i = 1; i < size; ++i)
+		{
+			TYPE value = vector[i];
+			register Bits key = extract(value);
+			register int j = i;
+			while ((j > 0) && (key < extract(vector[j - 1])))
+			{
+				vector[j] = vector[j - 1];
+				--j;
+			}
+			vector[j] = value;
+		}
+	}
+
+
+	// Quickselect with median of three pivots. C. A. R. Hoare. Algorithm 65: Find. Communications of
+	// the ACM, Vol. 4, No. 7, pp. 321-322. 1961.
+	template <typename TYPE, typename COMPARE>
+	void QuickSelect(TYPE* vector, int size, int k, const COMPARE& compare)
+	{
+		register int left = 0;
+		register int right = size - 1;
+		while (right - left >= 16)
+		{
+			register int middle = left + (right - left)/2;
+			if (compare(vector[middle], vector[left]))
+			{
+				TYPE tmp = vector[middle];
+				vector[middle] = vector[left];
+				vector[left] = tmp;
+			}
+			if (compare(vector[right], vector[left]))
+			{
+				TYPE tmp = vector[right];
+				vector[right] = vector[left];
+				vector[left] = tmp;
+			}
+			if (compare(vector[right], vector[middle]))
+			{
+				TYPE tmp = vector[right];
+				vector[right] = vector[middle];
+				vector[middle] = tmp;
+			}
+
+			const TYPE pivot = vector[middle];
+			register int i = left;
+			register int j = right;
+			while (i <= j)
+			{
+				while (compare(vector[i], pivot))
+				{
+					++i;
+				}
+				while (compare(pivot, vector[j]))
+				{
+					--j;
+				}
+				if (i <= j)
+				{
+					TYPE tmp = vector[i];
+					vector[i] = vector[j];
+					vector[j] = tmp;
+					++i;
+					--j;
+				}
+			}
+			if (k <= j)
+			{
+				right = j;
+			}
+			else if (k >= i)
+			{
+				left = i;
+			}
+			else
+			{
+				return;
+			}
+		}
+
+		for (register int i = left + 1; i <= right; ++i)
+		{
+			TYPE value = vector[i];
+			register int j = i;
+			while ((j > left) && compare(value, vector[j - 1]))
+			{
+				vector[j] = vector[j - 1];
+				--j;
+			}
+			vector[j] = value;
+		}
+	}
+
+
+	template <typename TYPE>
+	inline void Reverse(TYPE* vector, int size) throw()
+	{
+		for (register int i = 0, j = size - 1; i < j; ++i, --j)
+		{
+			TYPE tmp = vector[i];
+			vector[i] = vector[j];
+			vector[j] = tmp;
+		}
+	}
+
+
+	// Select() by radix for the primitive key types and by comparisons for anything else
+	template <typename TYPE, bool RADIX>
+	struct SelectKey
+	{
+		static inline void Select(TYPE* vector, int size, int k) throw()
+		{
+			QuickSelect(vector, size, k, Less<TYPE>());
+		}
+	};
+
+
+	template <typename TYPE>
+	struct SelectKey<TYPE, true>
+	{
+		static inline void Select(TYPE* vector, int size, int k) throw()
+		{
+			RadixSelect(vector, size, k, 8*static_cast<int>(sizeof(typename RadixKey<TYPE>::Bits)) - 8, RadixValue<TYPE>());
+		}
+	};
+}
+
 
 namespace Grok
 {
@@ -118,6 +854,52 @@ namespace Grok
 	}
 
 
+	// Stable bottom-up merge sort for any TYPE ordered by compare. Blocks of SORT_MERGE_NETWORK_LIMIT
+	// are sorted with a network, then every level of merges is split by merge path into pieces of
+	// SORT_MERGE_PARALLEL_GRAIN outputs that run in parallel.
+	template <typename TYPE, typename COMPARE>
+	void MergeSort(TYPE* vector, int size, const COMPARE& compare) throw(MemoryException)
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		TYPE* buffer = 0;
+		if (size > SORT_MERGE_NETWORK_LIMIT)
+		{
+			buffer = new(DEFAULT_ALIGNMENT) TYPE[size];
+			if (!buffer)
+			{
+				Throw(MemoryException());
+			}
+		}
+
+		GrokInternal::MergeSort(vector, size, buffer, compare);
+
+		delete [] buffer;
+	}
+
+
+	template <typename TYPE>
+	inline void MergeSort(TYPE* vector, int size) throw(MemoryException)
+	{
+		MergeSort(vector, size, GrokInternal::Less<TYPE>());
+	}
+
+
+	template <typename TYPE, typename COMPARE>
+	inline void MergeSort(Vector<TYPE>& vector, const COMPARE& compare) throw(MemoryException)
+	{
+		MergeSort(vector.entry, vector.size, compare);
+	}
+
+
+	template <typename TYPE>
+	inline void MergeSort(Vector<TYPE>& vector) throw(MemoryException)
+	{
+		MergeSort(vector.entry, vector.size, GrokInternal::Less<TYPE>());
+	}
+
+
 	void RadixSort(uint8* vector, int size) throw(MemoryException);
 
 
@@ -155,514 +937,467 @@ namespace Grok
 	}
 
 
-	template <typename TYPE>
-	void RadixSort(TYPE* vector, int size, sint32 TYPE::* key) throw(MemoryException)
-	{
-		Assert(vector);
-		Assert(size >= 0);
+	void ParallelRadixSort(uint8* vector, int size) throw(MemoryException);
 
-		struct Data
-		{
-			uint32 value;
-			int index;
-		};
 
-		register Data* __restrict a = new(DEFAULT_ALIGNMENT) Data[size];
-		register Data* __restrict b = new(DEFAULT_ALIGNMENT) Data[size];
-		register TYPE* __restrict old = new(DEFAULT_ALIGNMENT) TYPE[size];
-		if ((!a) || (!b) || (!old))
-		{
-			delete [] old;
-			delete [] b;
-			delete [] a;
-			Throw(MemoryException());
-		}
+	void ParallelRadixSort(sint8* vector, int size) throw(MemoryException);
 
-		int histogram0[256] = {0};
-		int histogram1[256] = {0};
-		int histogram2[256] = {0};
-		int histogram3[256] = {0};
 
-		{
-			register char* k = reinterpret_cast<char*>(&(vector[0].*key));
-			for (register int i = 0; i < size; ++i, k += sizeof(TYPE))
-			{
-				old[i] = vector[i];
+	void ParallelRadixSort(uint16* vector, int size) throw(MemoryException);
 
-				register uint32 value = *reinterpret_cast<uint32*>(k) ^ 0x80000000;
-				++histogram0[value & 0xff];
-				++histogram1[value >> 8 & 0xff];
-				++histogram2[value >> 16 & 0xff];
-				++histogram3[value >> 24];
 
-				a[i].value = value;
-				a[i].index = i;
-			}
-		}
+	void ParallelRadixSort(sint16* vector, int size) throw(MemoryException);
 
-		{
-			register int count0 = 0;
-			register int count1 = 0;
-			register int count2 = 0;
-			register int count3 = 0;
-			for (register sint16 h = 0; h < 256; ++h)
-			{
-				register int tmp;
-				
-				tmp = histogram0[h];
-				histogram0[h] = count0;
-				count0 += tmp;
 
-				tmp = histogram1[h];
-				histogram1[h] = count1;
-				count1 += tmp;
+	void ParallelRadixSort(uint32* vector, int size) throw(MemoryException);
 
-				tmp = histogram2[h];
-				histogram2[h] = count2;
-				count2 += tmp;
 
-				tmp = histogram3[h];
-				histogram3[h] = count3;
-				count3 += tmp;
-			}
-		}
+	void ParallelRadixSort(sint32* vector, int size) throw(MemoryException);
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram0[a[i].value & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			a[histogram1[b[i].value >> 8 & 0xff]++] = b[i];
-		}
+	void ParallelRadixSort(uint64* vector, int size) throw(MemoryException);
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram2[a[i].value >> 16 & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			vector[histogram3[b[i].value >> 24]++] = old[b[i].index];
-		}
+	void ParallelRadixSort(sint64* vector, int size) throw(MemoryException);
+
+
+	void ParallelRadixSort(float* vector, int size) throw(MemoryException);
 
-		delete [] old;
-		delete [] b;
-		delete [] a;
-	}
+
+	void ParallelRadixSort(double* vector, int size) throw(MemoryException);
 
 
 	template <typename TYPE>
-	void RadixSort(TYPE* vector, int size, sint64 TYPE::* key) throw(MemoryException)
+	inline void ParallelRadixSort(Vector<TYPE>& vector) throw(MemoryException)
 	{
-		Assert(size >= 0);
+		ParallelRadixSort(vector.entry, vector.size);
+	}
 
-		struct Data
-		{
-			uint64 value;
-			int index;
-		};
 
-		register Data* __restrict a = new(DEFAULT_ALIGNMENT) Data[size];
-		register Data* __restrict b = new(DEFAULT_ALIGNMENT) Data[size];
-		register TYPE* __restrict old = new(DEFAULT_ALIGNMENT) TYPE[size];
-		if ((!a) || (!b) || (!old))
-		{
-			delete [] old;
-			delete [] b;
-			delete [] a;
-			Throw(MemoryException());
-		}
+	void InPlaceRadixSort(uint8* vector, int size) throw();
 
-		int histogram0[256] = {0};
-		int histogram1[256] = {0};
-		int histogram2[256] = {0};
-		int histogram3[256] = {0};
-		int histogram4[256] = {0};
-		int histogram5[256] = {0};
-		int histogram6[256] = {0};
-		int histogram7[256] = {0};
 
-		{
-			register char* k = reinterpret_cast<char*>(&(vector[0].*key));
-			for (register int i = 0; i < size; ++i, k += sizeof(TYPE))
-			{
-				old[i] = vector[i];
+	void InPlaceRadixSort(sint8* vector, int size) throw();
 
-				register uint64 value = *reinterpret_cast<uint64*>(k) ^ 0x8000000000000000;
-				++histogram0[value & 0xff];
-				++histogram1[value >> 8 & 0xff];
-				++histogram2[value >> 16 & 0xff];
-				++histogram3[value >> 24 & 0xff];
-				++histogram4[value >> 32 & 0xff];
-				++histogram5[value >> 40 & 0xff];
-				++histogram6[value >> 48 & 0xff];
-				++histogram7[value >> 56];
 
-				a[i].value = value;
-				a[i].index = i;
-			}
-		}
+	void InPlaceRadixSort(uint16* vector, int size) throw();
 
-		{
-			register int count0 = 0;
-			register int count1 = 0;
-			register int count2 = 0;
-			register int count3 = 0;
-			register int count4 = 0;
-			register int count5 = 0;
-			register int count6 = 0;
-			register int count7 = 0;
-			for (register sint16 h = 0; h < 256; ++h)
-			{
-				register int tmp;
-				
-				tmp = histogram0[h];
-				histogram0[h] = count0;
-				count0 += tmp;
 
-				tmp = histogram1[h];
-				histogram1[h] = count1;
-				count1 += tmp;
+	void InPlaceRadixSort(sint16* vector, int size) throw();
 
-				tmp = histogram2[h];
-				histogram2[h] = count2;
-				count2 += tmp;
 
-				tmp = histogram3[h];
-				histogram3[h] = count3;
-				count3 += tmp;
+	void InPlaceRadixSort(uint32* vector, int size) throw();
 
-				tmp = histogram4[h];
-				histogram4[h] = count4;
-				count4 += tmp;
 
-				tmp = histogram5[h];
-				histogram5[h] = count5;
-				count5 += tmp;
+	void InPlaceRadixSort(sint32* vector, int size) throw();
 
-				tmp = histogram6[h];
-				histogram6[h] = count6;
-				count6 += tmp;
 
-				tmp = histogram7[h];
-				histogram7[h] = count7;
-				count7 += tmp;
-			}
-		}
+	void InPlaceRadixSort(uint64* vector, int size) throw();
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram0[a[i].value & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			a[histogram1[b[i].value >> 8 & 0xff]++] = b[i];
-		}
+	void InPlaceRadixSort(sint64* vector, int size) throw();
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram2[a[i].value >> 16 & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			a[histogram3[b[i].value >> 24 & 0xff]++] = b[i];
-		}
+	void InPlaceRadixSort(float* vector, int size) throw();
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram4[a[i].value >> 32 & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			a[histogram5[b[i].value >> 40 & 0xff]++] = b[i];
-		}
+	void InPlaceRadixSort(double* vector, int size) throw();
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram6[a[i].value >> 48 & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			vector[histogram7[b[i].value >> 56]++] = old[b[i].index];
-		}
+	template <typename TYPE>
+	inline void InPlaceRadixSort(Vector<TYPE>& vector) throw()
+	{
+		InPlaceRadixSort(vector.entry, vector.size);
+	}
 
-		delete [] old;
-		delete [] b;
-		delete [] a;
+
+	// Bitonic network on SSE4.2/AVX2 registers for up to SORT_NETWORK_LIMIT elements, CombSort when
+	// the instruction set is not enabled at compile time or for larger sizes.
+	void NetworkSort(sint32* vector, int size) throw();
+
+
+	void NetworkSort(sint64* vector, int size) throw();
+
+
+	void NetworkSort(float* vector, int size) throw();
+
+
+	void NetworkSort(double* vector, int size) throw();
+
+
+	template <typename TYPE>
+	inline void NetworkSort(TYPE* vector, int size) throw()
+	{
+		CombSort(vector, size);
 	}
 
 
 	template <typename TYPE>
-	void RadixSort(TYPE* vector, int size, float TYPE::* key) throw(MemoryException)
+	inline void NetworkSort(Vector<TYPE>& vector) throw()
+	{
+		NetworkSort(vector.entry, vector.size);
+	}
+
+
+	template <typename TYPE, typename KEY>
+	void InPlaceRadixSort(TYPE* vector, int size, KEY TYPE::* key) throw()
 	{
 		Assert(vector);
 		Assert(size >= 0);
 
-		struct Data
-		{
-			uint32 value;
-			int index;
-		};
+		GrokInternal::AmericanFlagSort(vector, size, 8*static_cast<int>(sizeof(KEY)) - 8, GrokInternal::RadixMemberKey<TYPE, KEY>(key));
+	}
 
-		register Data* __restrict a = new(DEFAULT_ALIGNMENT) Data[size];
-		register Data* __restrict b = new(DEFAULT_ALIGNMENT) Data[size];
-		register TYPE* __restrict old = new(DEFAULT_ALIGNMENT) TYPE[size];
-		if ((!a) || (!b) || (!old))
-		{
-			delete [] old;
-			delete [] b;
-			delete [] a;
-			Throw(MemoryException());
-		}
 
-		int histogram0[256] = {0};
-		int histogram1[256] = {0};
-		int histogram2[256] = {0};
-		int histogram3[256] = {0};
+	template <typename TYPE, typename KEY>
+	inline void InPlaceRadixSort(Vector<TYPE>& vector, KEY TYPE::* key) throw()
+	{
+		InPlaceRadixSort(vector.entry, vector.size, key);
+	}
 
-		{
-			register char* k = reinterpret_cast<char*>(&(vector[0].*key));
-			for (register int i = 0; i < size; ++i, k += sizeof(TYPE))
-			{
-				old[i] = vector[i];
 
-				register uint32 value = *reinterpret_cast<uint32*>(k);
-				value ^= static_cast<uint32>(-sint32(value >> 31)) | 0x80000000; // Michael Herf. Radix Tricks. 2001. http://stereopsis.com/radix.html
-				++histogram0[value & 0xff];
-				++histogram1[value >> 8 & 0xff];
-				++histogram2[value >> 16 & 0xff];
-				++histogram3[value >> 24];
+	// LSD radix sort of records by a member key, stable. Passes where every key falls in one bucket are
+	// skipped. Records up to SORT_RADIX_RECORD_MOVE_LIMIT bytes are moved on every pass, larger ones
+	// are ranked through (key, index) pairs and then permuted in place following the cycles.
+	template <typename TYPE, typename KEY>
+	void RadixSort(TYPE* vector, int size, KEY TYPE::* key) throw(MemoryException)
+	{
+		Assert(vector);
+		Assert(size >= 0);
+
+		typedef typename GrokInternal::RadixKey<KEY>::Bits Bits;
+		typedef GrokInternal::RadixPair<Bits> Pair;
 
-				a[i].value = value;
-				a[i].index = i;
+		const int passes = static_cast<int>(sizeof(Bits));
+		const GrokInternal::RadixMemberKey<TYPE, KEY> extract(key);
+
+		int histogram[sizeof(Bits)][256];
+		bool active[sizeof(Bits)];
+
+		for (register int p = 0; p < passes; ++p)
+		{
+			for (register int h = 0; h < 256; ++h)
+			{
+				histogram[p][h] = 0;
+			}
+		}
+		for (register int i = 0; i < size; ++i)
+		{
+			register Bits value = extract(vector[i]);
+			for (register int p = 0; p < passes; ++p)
+			{
+				++histogram[p][static_cast<int>(value >> 8*p & 0xff)];
 			}
 		}
+		if (!GrokInternal::RadixOffsets(histogram, active, passes, size))
+		{
+			return;
+		}
 
+		if (sizeof(TYPE) <= SORT_RADIX_RECORD_MOVE_LIMIT)
 		{
-			register int count0 = 0;
-			register int count1 = 0;
-			register int count2 = 0;
-			register int count3 = 0;
-			for (register sint16 h = 0; h < 256; ++h)
+			register TYPE* __restrict buffer = new(DEFAULT_ALIGNMENT) TYPE[size];
+			if (!buffer)
+			{
+				Throw(MemoryException());
+			}
+
+			register TYPE* a = vector;
+			register TYPE* b = buffer;
+			for (int p = 0; p < passes; ++p)
+			{
+				if (active[p])
+				{
+					register int* __restrict offset = histogram[p];
+					for (register int i = 0; i < size; ++i)
+					{
+						b[offset[static_cast<int>(extract(a[i]) >> 8*p & 0xff)]++] = a[i];
+					}
+					register TYPE* tmp = a;
+					a = b;
+					b = tmp;
+				}
+			}
+			if (a != vector)
 			{
-				register int tmp;
-				
-				tmp = histogram0[h];
-				histogram0[h] = count0;
-				count0 += tmp;
+				for (register int i = 0; i < size; ++i)
+				{
+					vector[i] = a[i];
+				}
+			}
 
-				tmp = histogram1[h];
-				histogram1[h] = count1;
-				count1 += tmp;
+			delete [] buffer;
+		}
+		else
+		{
+			register Pair* __restrict a = new(DEFAULT_ALIGNMENT) Pair[size];
+			register Pair* __restrict b = new(DEFAULT_ALIGNMENT) Pair[size];
+			if ((!a) || (!b))
+			{
+				delete [] b;
+				delete [] a;
+				Throw(MemoryException());
+			}
 
-				tmp = histogram2[h];
-				histogram2[h] = count2;
-				count2 += tmp;
+			for (register int i = 0; i < size; ++i)
+			{
+				a[i].value = extract(vector[i]);
+				a[i].index = i;
+			}
+			register Pair* sorted = GrokInternal::RadixSortPairs(a, b, size, histogram, active);
 
-				tmp = histogram3[h];
-				histogram3[h] = count3;
-				count3 += tmp;
+			// Record i receives the old record sorted[i].index, visited positions are marked with index == i
+			for (register int i = 0; i < size; ++i)
+			{
+				register int j = sorted[i].index;
+				if (j != i)
+				{
+					TYPE tmp = vector[i];
+					register int k = i;
+					do
+					{
+						vector[k] = vector[j];
+						sorted[k].index = k;
+						k = j;
+						j = sorted[k].index;
+					} while (j != i);
+					vector[k] = tmp;
+					sorted[k].index = k;
+				}
 			}
+
+			delete [] b;
+			delete [] a;
 		}
+	}
 
-		for (register int i = 0; i < size; ++i)
+
+	template <typename TYPE, typename KEY>
+	inline void RadixSort(Vector<TYPE>& vector, KEY TYPE::* key) throw(MemoryException)
+	{
+		RadixSort(vector.entry, vector.size, key);
+	}
+
+
+	// Sorts keys (stable) and sets permutation[i] to the original position of the i-th sorted key
+	template <typename KEY>
+	void RadixSortPermutation(KEY* keys, int size, int* permutation) throw(MemoryException)
+	{
+		Assert(keys);
+		Assert(permutation);
+		Assert(size >= 0);
+
+		typedef typename GrokInternal::RadixKey<KEY>::Bits Bits;
+		typedef GrokInternal::RadixPair<Bits> Pair;
+
+		register Pair* __restrict a = new(DEFAULT_ALIGNMENT) Pair[size];
+		if (!a)
 		{
-			b[histogram0[a[i].value & 0xff]++] = a[i];
+			Throw(MemoryException());
 		}
-
 		for (register int i = 0; i < size; ++i)
 		{
-			a[histogram1[b[i].value >> 8 & 0xff]++] = b[i];
+			a[i].value = GrokInternal::RadixEncode(keys[i]);
+			a[i].index = i;
 		}
 
-		for (register int i = 0; i < size; ++i)
+		register Pair* sorted = a;
+		if (size < SORT_RADIX_COMB_LIMIT)
+		{
+			for (register int i = 1; i < size; ++i)
+			{
+				Pair pair = a[i];
+				register int j = i;
+				while ((j > 0) && (pair.value < a[j - 1].value))
+				{
+					a[j] = a[j - 1];
+					--j;
+				}
+				a[j] = pair;
+			}
+		}
+		else
 		{
-			b[histogram2[a[i].value >> 16 & 0xff]++] = a[i];
+			const int passes = static_cast<int>(sizeof(Bits));
+
+			int histogram[sizeof(Bits)][256];
+			bool active[sizeof(Bits)];
+
+			for (register int p = 0; p < passes; ++p)
+			{
+				for (register int h = 0; h < 256; ++h)
+				{
+					histogram[p][h] = 0;
+				}
+			}
+			for (register int i = 0; i < size; ++i)
+			{
+				register Bits value = a[i].value;
+				for (register int p = 0; p < passes; ++p)
+				{
+					++histogram[p][static_cast<int>(value >> 8*p & 0xff)];
+				}
+			}
+			if (GrokInternal::RadixOffsets(histogram, active, passes, size))
+			{
+				register Pair* __restrict b = new(DEFAULT_ALIGNMENT) Pair[size];
+				if (!b)
+				{
+					delete [] a;
+					Throw(MemoryException());
+				}
+				sorted = GrokInternal::RadixSortPairs(a, b, size, histogram, active);
+				if (sorted != a)
+				{
+					delete [] a;
+					a = b;
+				}
+				else
+				{
+					delete [] b;
+				}
+			}
 		}
 
 		for (register int i = 0; i < size; ++i)
 		{
-			vector[histogram3[b[i].value >> 24]++] = old[b[i].index];
+			keys[i] = GrokInternal::RadixDecode<KEY>(sorted[i].value);
+			permutation[i] = sorted[i].index;
 		}
 
-		delete [] old;
-		delete [] b;
 		delete [] a;
 	}
 
 
+	// vector[i] = old vector[permutation[i]]
 	template <typename TYPE>
-	void RadixSort(TYPE* vector, int size, double TYPE::* key) throw(MemoryException)
+	void Permute(TYPE* vector, const int* permutation, int size) throw(MemoryException)
 	{
+		Assert(vector);
+		Assert(permutation);
 		Assert(size >= 0);
 
-		struct Data
-		{
-			uint64 value;
-			int index;
-		};
-
-		register Data* __restrict a = new(DEFAULT_ALIGNMENT) Data[size];
-		register Data* __restrict b = new(DEFAULT_ALIGNMENT) Data[size];
 		register TYPE* __restrict old = new(DEFAULT_ALIGNMENT) TYPE[size];
-		if ((!a) || (!b) || (!old))
+		if (!old)
 		{
-			delete [] old;
-			delete [] b;
-			delete [] a;
 			Throw(MemoryException());
 		}
+		for (register int i = 0; i < size; ++i)
+		{
+			old[i] = vector[i];
+		}
+		for (register int i = 0; i < size; ++i)
+		{
+			vector[i] = old[permutation[i]];
+		}
+		delete [] old;
+	}
 
-		int histogram0[256] = {0};
-		int histogram1[256] = {0};
-		int histogram2[256] = {0};
-		int histogram3[256] = {0};
-		int histogram4[256] = {0};
-		int histogram5[256] = {0};
-		int histogram6[256] = {0};
-		int histogram7[256] = {0};
 
-		{
-			register char* k = reinterpret_cast<char*>(&(vector[0].*key));
-			for (register int i = 0; i < size; ++i, k += sizeof(TYPE))
-			{
-				old[i] = vector[i];
+	template <typename TYPE>
+	inline void Permute(Vector<TYPE>& vector, const Vector<int>& permutation) throw(MemoryException)
+	{
+		Assert(vector.size == permutation.size);
+
+		Permute(vector.entry, permutation.entry, vector.size);
+	}
 
-				register uint64 value = *reinterpret_cast<uint64*>(k);
-				value ^= static_cast<uint64>(-static_cast<sint64>(value >> 63)) | 0x8000000000000000; // Michael Herf. Radix Tricks. 2001. http://stereopsis.com/radix.html
-				++histogram0[value & 0xff];
-				++histogram1[value >> 8 & 0xff];
-				++histogram2[value >> 16 & 0xff];
-				++histogram3[value >> 24 & 0xff];
-				++histogram4[value >> 32 & 0xff];
-				++histogram5[value >> 40 & 0xff];
-				++histogram6[value >> 48 & 0xff];
-				++histogram7[value >> 56];
 
-				a[i].value = value;
-				a[i].index = i;
-			}
-		}
+}
 
-		{
-			register int count0 = 0;
-			register int count1 = 0;
-			register int count2 = 0;
-			register int count3 = 0;
-			register int count4 = 0;
-			register int count5 = 0;
-			register int count6 = 0;
-			register int count7 = 0;
-			for (register sint16 h = 0; h < 256; ++h)
-			{
-				register int tmp;
-				
-				tmp = histogram0[h];
-				histogram0[h] = count0;
-				count0 += tmp;
 
-				tmp = histogram1[h];
-				histogram1[h] = count1;
-				count1 += tmp;
+namespace GrokInternal
+{
+	// Sorts with the bitonic network and returns true when the library was built with one for the type
+	// (SSE4.2/AVX2) and size is at most SORT_NETWORK_LIMIT, otherwise returns false and leaves vector as is.
+	// Decided where NetworkSort is compiled, so the caller's instruction set flags do not matter.
+	bool TryNetworkSort(Grok::sint32* vector, int size) throw();
 
-				tmp = histogram2[h];
-				histogram2[h] = count2;
-				count2 += tmp;
 
-				tmp = histogram3[h];
-				histogram3[h] = count3;
-				count3 += tmp;
+	bool TryNetworkSort(Grok::sint64* vector, int size) throw();
 
-				tmp = histogram4[h];
-				histogram4[h] = count4;
-				count4 += tmp;
 
-				tmp = histogram5[h];
-				histogram5[h] = count5;
-				count5 += tmp;
+	bool TryNetworkSort(float* vector, int size) throw();
 
-				tmp = histogram6[h];
-				histogram6[h] = count6;
-				count6 += tmp;
 
-				tmp = histogram7[h];
-				histogram7[h] = count7;
-				count7 += tmp;
-			}
-		}
+	bool TryNetworkSort(double* vector, int size) throw();
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram0[a[i].value & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			a[histogram1[b[i].value >> 8 & 0xff]++] = b[i];
-		}
+	template <typename TYPE>
+	inline bool TryNetworkSort(TYPE*, int) throw()
+	{
+		return false;
+	}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram2[a[i].value >> 16 & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
+	// Sort() of sizes above 4, radix for the primitive key types and merge sort for anything else, or
+	// CombSort in place when there is no memory for the merge buffer
+	template <typename TYPE, bool RADIX>
+	struct SortLarge
+	{
+		static void Sort(TYPE* vector, int size) throw(Grok::MemoryException)
 		{
-			a[histogram3[b[i].value >> 24 & 0xff]++] = b[i];
-		}
+			TYPE* buffer = 0;
+			if (size > SORT_MERGE_NETWORK_LIMIT)
+			{
+				buffer = new(DEFAULT_ALIGNMENT) TYPE[size];
+				if (!buffer)
+				{
+					Grok::CombSort(vector, size);
+					return;
+				}
+			}
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram4[a[i].value >> 32 & 0xff]++] = a[i];
-		}
+			MergeSort(vector, size, buffer, Less<TYPE>());
 
-		for (register int i = 0; i < size; ++i)
-		{
-			a[histogram5[b[i].value >> 40 & 0xff]++] = b[i];
+			delete [] buffer;
 		}
+	};
 
-		for (register int i = 0; i < size; ++i)
-		{
-			b[histogram6[a[i].value >> 48 & 0xff]++] = a[i];
-		}
 
-		for (register int i = 0; i < size; ++i)
+	template <typename TYPE>
+	struct SortLarge<TYPE, true>
+	{
+		static void Sort(TYPE* vector, int size) throw(Grok::MemoryException)
 		{
-			vector[histogram7[b[i].value >> 56]++] = old[b[i].index];
+			if ((size >= SORT_RADIX_MEMORY_CHECK_LIMIT) && (static_cast<size_t>(size)*sizeof(TYPE) > Grok::AvailableMemory()))
+			{
+				Grok::InPlaceRadixSort(vector, size);
+			}
+			else if (size >= SORT_RADIX_PARALLEL_LIMIT)
+			{
+				Grok::ParallelRadixSort(vector, size);
+			}
+			else if (!TryNetworkSort(vector, size))
+			{
+				if (size >= SORT_RADIX_COMB_LIMIT)
+				{
+					Grok::RadixSort(vector, size);
+				}
+				else
+				{
+					Grok::CombSort(vector, size);
+				}
+			}
 		}
-
-		delete [] old;
-		delete [] b;
-		delete [] a;
-	}
-
-
-	template <typename TYPE, typename KEY>
-	inline void RadixSort(Vector<TYPE>& vector, KEY TYPE::* key) throw(MemoryException)
-	{
-		RadixSort(vector.entry, vector.size, key);
-	}
+	};
+}
 
 
+namespace Grok
+{
+	// Ascending sort with operator <. Primitive key types use the radix and bitonic sorts, which need
+	// scratch memory and may throw, anything else uses MergeSort, or CombSort when its buffer of size
+	// elements cannot be allocated.
 	template <typename TYPE>
 	void Sort(TYPE* vector, int size) throw(MemoryException)
 	{
 		Assert(vector);
 		Assert(size >= 0);
 
-		if (size >= SORT_RADIX_COMB_LIMIT)
+		if (size > 4)
 		{
-			RadixSort(vector, size);
-		}
-		else if (size > 4)
-		{
-			CombSort(vector, size);
+			GrokInternal::SortLarge<TYPE, GrokInternal::RadixKey<TYPE>::sortable>::Sort(vector, size);
 		}
 		else if (size == 4)
 		{
@@ -758,7 +1493,7 @@ namespace Grok
 			register TYPE a = vector[0];
 			register TYPE b = vector[1];
 
-			if (a > b)
+			if (b < a)
 			{
 				vector[0] = b;
 				vector[1] = a;
@@ -780,7 +1515,11 @@ namespace Grok
 		Assert(vector);
 		Assert(size >= 0);
 
-		if (size >= SORT_RADIX_COMB_LIMIT)
+		if ((size >= SORT_RADIX_MEMORY_CHECK_LIMIT) && (static_cast<size_t>(size)*((sizeof(TYPE) <= SORT_RADIX_RECORD_MOVE_LIMIT) ? sizeof(TYPE) : 2*sizeof(GrokInternal::RadixPair<typename GrokInternal::RadixKey<KEY>::Bits>)) > AvailableMemory()))
+		{
+			InPlaceRadixSort(vector, size, key);
+		}
+		else if (size >= SORT_RADIX_COMB_LIMIT)
 		{
 			RadixSort(vector, size, key);
 		}
@@ -896,4 +1635,349 @@ namespace Grok
 	{
 		Sort(vector.entry, vector.size, key);
 	}
+
+
+	// Rearranges vector so vector[k] holds the element that a full sort would put there, with no
+	// larger element before it and no smaller one after it. Linear time, by radix for primitive keys.
+	template <typename TYPE>
+	void Select(TYPE* vector, int size, int k) throw()
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k < size));
+
+		GrokInternal::SelectKey<TYPE, GrokInternal::RadixKey<TYPE>::sortable>::Select(vector, size, k);
+	}
+
+
+	template <typename TYPE>
+	inline void Select(Vector<TYPE>& vector, int k) throw()
+	{
+		Select(vector.entry, vector.size, k);
+	}
+
+
+	template <typename TYPE, typename COMPARE>
+	void Select(TYPE* vector, int size, int k, const COMPARE& compare)
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k < size));
+
+		GrokInternal::QuickSelect(vector, size, k, compare);
+	}
+
+
+	template <typename TYPE, typename COMPARE>
+	inline void Select(Vector<TYPE>& vector, int k, const COMPARE& compare)
+	{
+		Select(vector.entry, vector.size, k, compare);
+	}
+
+
+	template <typename TYPE, typename KEY>
+	void Select(TYPE* vector, int size, int k, KEY TYPE::* key) throw()
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k < size));
+
+		GrokInternal::RadixSelect(vector, size, k, 8*static_cast<int>(sizeof(typename GrokInternal::RadixKey<KEY>::Bits)) - 8, GrokInternal::RadixMemberKey<TYPE, KEY>(key));
+	}
+
+
+	template <typename TYPE, typename KEY>
+	inline void Select(Vector<TYPE>& vector, int k, KEY TYPE::* key) throw()
+	{
+		Select(vector.entry, vector.size, k, key);
+	}
+
+
+	// Sorts the k smallest elements into vector[0 .. k - 1], the rest are left in any order
+	template <typename TYPE>
+	void PartialSort(TYPE* vector, int size, int k) throw(MemoryException)
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k <= size));
+
+		if (k < size)
+		{
+			Select(vector, size, k);
+		}
+		Sort(vector, k);
+	}
+
+
+	template <typename TYPE>
+	inline void PartialSort(Vector<TYPE>& vector, int k) throw(MemoryException)
+	{
+		PartialSort(vector.entry, vector.size, k);
+	}
+
+
+	template <typename TYPE, typename COMPARE>
+	void PartialSort(TYPE* vector, int size, int k, const COMPARE& compare) throw(MemoryException)
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k <= size));
+
+		if (k < size)
+		{
+			Select(vector, size, k, compare);
+		}
+		MergeSort(vector, k, compare);
+	}
+
+
+	template <typename TYPE, typename COMPARE>
+	inline void PartialSort(Vector<TYPE>& vector, int k, const COMPARE& compare) throw(MemoryException)
+	{
+		PartialSort(vector.entry, vector.size, k, compare);
+	}
+
+
+	template <typename TYPE, typename KEY>
+	void PartialSort(TYPE* vector, int size, int k, KEY TYPE::* key) throw(MemoryException)
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k <= size));
+
+		if (k < size)
+		{
+			Select(vector, size, k, key);
+		}
+		Sort(vector, k, key);
+	}
+
+
+	template <typename TYPE, typename KEY>
+	inline void PartialSort(Vector<TYPE>& vector, int k, KEY TYPE::* key) throw(MemoryException)
+	{
+		PartialSort(vector.entry, vector.size, k, key);
+	}
+
+
+	// Moves the k largest elements into vector[0 .. k - 1], largest first, the rest are left in any order
+	template <typename TYPE>
+	void TopK(TYPE* vector, int size, int k) throw(MemoryException)
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k <= size));
+
+		if (k > 0)
+		{
+			Select(vector, size, size - k);
+		}
+		Sort(vector + size - k, k);
+		GrokInternal::Reverse(vector, size);
+	}
+
+
+	template <typename TYPE>
+	inline void TopK(Vector<TYPE>& vector, int k) throw(MemoryException)
+	{
+		TopK(vector.entry, vector.size, k);
+	}
+
+
+	template <typename TYPE, typename COMPARE>
+	void TopK(TYPE* vector, int size, int k, const COMPARE& compare) throw(MemoryException)
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k <= size));
+
+		if (k > 0)
+		{
+			Select(vector, size, size - k, compare);
+		}
+		MergeSort(vector + size - k, k, compare);
+		GrokInternal::Reverse(vector, size);
+	}
+
+
+	template <typename TYPE, typename COMPARE>
+	inline void TopK(Vector<TYPE>& vector, int k, const COMPARE& compare) throw(MemoryException)
+	{
+		TopK(vector.entry, vector.size, k, compare);
+	}
+
+
+	template <typename TYPE, typename KEY>
+	void TopK(TYPE* vector, int size, int k, KEY TYPE::* key) throw(MemoryException)
+	{
+		Assert(vector);
+		Assert((k >= 0) && (k <= size));
+
+		if (k > 0)
+		{
+			Select(vector, size, size - k, key);
+		}
+		Sort(vector + size - k, k, key);
+		GrokInternal::Reverse(vector, size);
+	}
+
+
+	template <typename TYPE, typename KEY>
+	inline void TopK(Vector<TYPE>& vector, int k, KEY TYPE::* key) throw(MemoryException)
+	{
+		TopK(vector.entry, vector.size, k, key);
+	}
+
+
+	// Sorts keys (stable radix sort) and reorders up to four payload arrays the same way. For more payloads,
+	// or payloads only known at run time, sort with RadixSortPermutation and Permute each array with the
+	// permutation it returns, which is what these overloads do.
+	template <typename KEY, typename VALUE>
+	void SortByKey(KEY* keys, VALUE* values, int size) throw(MemoryException)
+	{
+		Assert(keys);
+		Assert(values);
+		Assert(size >= 0);
+
+		register int* __restrict permutation = new(DEFAULT_ALIGNMENT) int[size];
+		if (!permutation)
+		{
+			Throw(MemoryException());
+		}
+		try
+		{
+			RadixSortPermutation(keys, size, permutation);
+			Permute(values, permutation, size);
+		}
+		catch (MemoryException&)
+		{
+			delete [] permutation;
+			ReThrow();
+		}
+		delete [] permutation;
+	}
+
+
+	template <typename KEY, typename VALUE>
+	inline void SortByKey(Vector<KEY>& keys, Vector<VALUE>& values) throw(MemoryException)
+	{
+		Assert(keys.size == values.size);
+
+		SortByKey(keys.entry, values.entry, keys.size);
+	}
+
+
+	template <typename KEY, typename VALUE1, typename VALUE2>
+	void SortByKey(KEY* keys, VALUE1* values1, VALUE2* values2, int size) throw(MemoryException)
+	{
+		Assert(keys);
+		Assert(values1);
+		Assert(values2);
+		Assert(size >= 0);
+
+		register int* __restrict permutation = new(DEFAULT_ALIGNMENT) int[size];
+		if (!permutation)
+		{
+			Throw(MemoryException());
+		}
+		try
+		{
+			RadixSortPermutation(keys, size, permutation);
+			Permute(values1, permutation, size);
+			Permute(values2, permutation, size);
+		}
+		catch (MemoryException&)
+		{
+			delete [] permutation;
+			ReThrow();
+		}
+		delete [] permutation;
+	}
+
+
+	template <typename KEY, typename VALUE1, typename VALUE2>
+	inline void SortByKey(Vector<KEY>& keys, Vector<VALUE1>& values1, Vector<VALUE2>& values2) throw(MemoryException)
+	{
+		Assert(keys.size == values1.size);
+		Assert(keys.size == values2.size);
+
+		SortByKey(keys.entry, values1.entry, values2.entry, keys.size);
+	}
+
+
+	template <typename KEY, typename VALUE1, typename VALUE2, typename VALUE3>
+	void SortByKey(KEY* keys, VALUE1* values1, VALUE2* values2, VALUE3* values3, int size) throw(MemoryException)
+	{
+		Assert(keys);
+		Assert(values1);
+		Assert(values2);
+		Assert(values3);
+		Assert(size >= 0);
+
+		register int* __restrict permutation = new(DEFAULT_ALIGNMENT) int[size];
+		if (!permutation)
+		{
+			Throw(MemoryException());
+		}
+		try
+		{
+			RadixSortPermutation(keys, size, permutation);
+			Permute(values1, permutation, size);
+			Permute(values2, permutation, size);
+			Permute(values3, permutation, size);
+		}
+		catch (MemoryException&)
+		{
+			delete [] permutation;
+			ReThrow();
+		}
+		delete [] permutation;
+	}
+
+
+	template <typename KEY, typename VALUE1, typename VALUE2, typename VALUE3>
+	inline void SortByKey(Vector<KEY>& keys, Vector<VALUE1>& values1, Vector<VALUE2>& values2, Vector<VALUE3>& values3) throw(MemoryException)
+	{
+		Assert(keys.size == values1.size);
+		Assert(keys.size == values2.size);
+		Assert(keys.size == values3.size);
+
+		SortByKey(keys.entry, values1.entry, values2.entry, values3.entry, keys.size);
+	}
+
+
+	template <typename KEY, typename VALUE1, typename VALUE2, typename VALUE3, typename VALUE4>
+	void SortByKey(KEY* keys, VALUE1* values1, VALUE2* values2, VALUE3* values3, VALUE4* values4, int size) throw(MemoryException)
+	{
+		Assert(keys);
+		Assert(values1);
+		Assert(values2);
+		Assert(values3);
+		Assert(values4);
+		Assert(size >= 0);
+
+		register int* __restrict permutation = new(DEFAULT_ALIGNMENT) int[size];
+		if (!permutation)
+		{
+			Throw(MemoryException());
+		}
+		try
+		{
+			RadixSortPermutation(keys, size, permutation);
+			Permute(values1, permutation, size);
+			Permute(values2, permutation, size);
+			Permute(values3, permutation, size);
+			Permute(values4, permutation, size);
+		}
+		catch (MemoryException&)
+		{
+			delete [] permutation;
+			ReThrow();
+		}
+		delete [] permutation;
+	}
+
+
+	template <typename KEY, typename VALUE1, typename VALUE2, typename VALUE3, typename VALUE4>
+	inline void SortByKey(Vector<KEY>& keys, Vector<VALUE1>& values1, Vector<VALUE2>& values2, Vector<VALUE3>& values3, Vector<VALUE4>& values4) throw(MemoryException)
+	{
+		Assert(keys.size == values1.size);
+		Assert(keys.size == values2.size);
+		Assert(keys.size == values3.size);
+		Assert(keys.size == values4.size);
+
+		SortByKey(keys.entry, values1.entry, values2.entry, values3.entry, values4.entry, keys.size);
+	}
 }
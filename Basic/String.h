@@ -51,6 +51,19 @@ namespace Grok
 			String(const char* string, int length) throw(MemoryException);
 
 
+			#if defined(RVALUE_REFERENCES)
+
+				inline String(String&& string) throw()
+				:	entry(string.entry),
+					size(string.size)
+				{
+					string.entry = static_cast<char*>(0);
+					string.size = 0;
+				}
+
+			#endif
+
+
 			inline ~String() throw()
 			{
 				delete [] entry;
@@ -60,6 +73,50 @@ namespace Grok
 			String& operator = (const String& string) throw(MemoryException);
 
 
+			#if defined(RVALUE_REFERENCES)
+
+				inline String& operator = (String&& string) throw()
+				{
+					Swap(string);
+					return *this;
+				}
+
+			#endif
+
+
+			// Exchanges the buffers, nothing is allocated nor copied
+			inline void Swap(String& string) throw()
+			{
+				register char* swap_entry = entry;
+				entry = string.entry;
+				string.entry = swap_entry;
+				register int swap_size = size;
+				size = string.size;
+				string.size = swap_size;
+			}
+
+
+			// Takes ownership of a buffer of size bytes allocated with new [], the current one is released
+			inline void Adopt(char* entry, int size) throw()
+			{
+				Assert(entry || (size == 0));
+
+				delete [] this->entry;
+				this->entry = entry;
+				this->size = size;
+			}
+
+
+			// Gives up the buffer, which the caller has to delete [], and leaves the string empty
+			inline char* Release() throw()
+			{
+				register char* buffer = entry;
+				entry = static_cast<char*>(0);
+				size = 0;
+				return buffer;
+			}
+
+
 			String& operator = (const char* string) throw(MemoryException);
 
 
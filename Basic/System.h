@@ -130,3 +130,25 @@
 #define BUILD_TIME __TIME__
 
 #define DEFAULT_ALIGNMENT 16
+
+// Bytes of a cache line, fields written by different threads are kept this far apart
+#define CACHE_LINE_SIZE 64
+
+
+// Move constructors and move assignments are only declared by compilers that support rvalue references
+#if (__cplusplus >= 201103L) || (defined(CC_Microsoft) && (_MSC_VER >= 1600))
+
+	#define RVALUE_REFERENCES
+
+#endif
+
+
+#if defined(CC_Microsoft)
+
+	#define THREAD_LOCAL __declspec(thread)
+
+#else
+
+	#define THREAD_LOCAL __thread
+
+#endif
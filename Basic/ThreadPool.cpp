@@ -0,0 +1,504 @@
+// ThreadPool.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include <Basic/Assert.h>
+#include <Basic/Atomic.h>
+#include <Basic/Memory.h>
+#include <Basic/ThreadPool.h>
+#include <Container/ConcurrentQueue.h>
+
+#if defined(OS_Windows)
+
+	#define WINVER         0x0600
+	#define _WIN32_WINNT   0x0600
+	#define _WIN32_WINDOWS 0x0600
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+
+#else
+
+	#include <pthread.h>
+	#include <sched.h>
+	#include <unistd.h>
+
+#endif
+
+
+namespace GrokInternal
+{
+	// Chase-Lev deque of a worker and its thread. Only the owner moves bottom, thieves move top.
+	struct Worker
+	{
+		ThreadPoolData* pool;
+
+		int index;
+
+		#if defined(OS_Windows)
+			HANDLE thread;
+		#else
+			pthread_t thread;
+		#endif
+
+		char padding_0[CACHE_LINE_SIZE];
+
+		volatile Grok::sint64 top;
+
+		char padding_1[CACHE_LINE_SIZE];
+
+		volatile Grok::sint64 bottom;
+
+		char padding_2[CACHE_LINE_SIZE];
+
+		Grok::Task* volatile slot[THREAD_POOL_DEQUE_SIZE];
+	};
+
+
+	struct ThreadPoolData
+	{
+		int threads;
+
+		bool pin;
+
+		int workers;
+
+		// Workers whose thread started, the deques of the others stay empty
+		int started;
+
+		Grok::Vector<Worker> worker;
+
+		// Spawns from threads outside the pool
+		Grok::MPMCQueue<Grok::Task*> injected;
+
+		volatile Grok::sint32 stop;
+
+		// Incremented by each spawn, a worker only sleeps if it did not change since it last looked for work
+		volatile Grok::sint32 epoch;
+
+		volatile Grok::sint32 sleepers;
+
+		#if defined(OS_Windows)
+			SRWLOCK lock;
+			CONDITION_VARIABLE wake;
+		#else
+			pthread_mutex_t lock;
+			pthread_cond_t wake;
+		#endif
+
+
+		ThreadPoolData(int threads) throw(Grok::MemoryException)
+		:	threads(threads),
+			pin(false),
+			workers(threads - 1),
+			started(0),
+			worker(threads - 1, CACHE_LINE_SIZE),
+			injected(THREAD_POOL_DEQUE_SIZE),
+			stop(0),
+			epoch(0),
+			sleepers(0)
+		{
+		}
+	};
+
+
+	// Pool and worker index of the calling thread, null and -1 outside any pool
+	static THREAD_LOCAL ThreadPoolData* current_pool = static_cast<ThreadPoolData*>(0);
+
+	static THREAD_LOCAL int current_worker = -1;
+
+
+	static int Processors() throw()
+	{
+		#if defined(OS_Windows)
+			SYSTEM_INFO information;
+			GetSystemInfo(&information);
+			return static_cast<int>(information.dwNumberOfProcessors);
+		#else
+			register long processors = sysconf(_SC_NPROCESSORS_ONLN);
+			return (processors > 0) ? static_cast<int>(processors) : 1;
+		#endif
+	}
+
+
+	static void PinThread(int processor) throw()
+	{
+		processor %= Processors();
+		#if defined(OS_Windows)
+			if (processor < 8*static_cast<int>(sizeof(DWORD_PTR)))
+			{
+				SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << processor);
+			}
+		#elif defined(OS_Linux)
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(processor, &set);
+			pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		#else
+			(void)processor;
+		#endif
+	}
+
+
+	// Owner only, false when the deque is full
+	static inline bool Push(Worker& worker, Grok::Task* task) throw()
+	{
+		register Grok::sint64 b = worker.bottom;
+		if (b - Grok::AtomicLoad(&worker.top) >= THREAD_POOL_DEQUE_SIZE)
+		{
+			return false;
+		}
+		Grok::AtomicStore(&worker.slot[b & (THREAD_POOL_DEQUE_SIZE - 1)], task);
+		Grok::AtomicStore(&worker.bottom, b + 1);
+		return true;
+	}
+
+
+	// Owner only, takes the newest task
+	static inline Grok::Task* Pop(Worker& worker) throw()
+	{
+		register Grok::sint64 b = worker.bottom - 1;
+		Grok::AtomicStore(&worker.bottom, b);
+		Grok::AtomicFence();
+		register Grok::sint64 t = Grok::AtomicLoad(&worker.top);
+		if (t > b)
+		{
+			Grok::AtomicStore(&worker.bottom, b + 1);
+			return static_cast<Grok::Task*>(0);
+		}
+		register Grok::Task* task = worker.slot[b & (THREAD_POOL_DEQUE_SIZE - 1)];
+		if (t == b)
+		{
+			// Last task, race the thieves for it
+			if (!Grok::AtomicCompareExchange(&worker.top, t, t + 1))
+			{
+				task = static_cast<Grok::Task*>(0);
+			}
+			Grok::AtomicStore(&worker.bottom, b + 1);
+		}
+		return task;
+	}
+
+
+	// Any thread, takes the oldest task
+	static inline Grok::Task* Steal(Worker& worker) throw()
+	{
+		register Grok::sint64 t = Grok::AtomicLoad(&worker.top);
+		Grok::AtomicFence();
+		register Grok::sint64 b = Grok::AtomicLoad(&worker.bottom);
+		if (t >= b)
+		{
+			return static_cast<Grok::Task*>(0);
+		}
+		register Grok::Task* task = Grok::AtomicLoad(&worker.slot[t & (THREAD_POOL_DEQUE_SIZE - 1)]);
+		if (!Grok::AtomicCompareExchange(&worker.top, t, t + 1))
+		{
+			return static_cast<Grok::Task*>(0);
+		}
+		return task;
+	}
+
+
+	// Own deque first, then the injected tasks, then the other workers starting from a rotating victim
+	static Grok::Task* FindTask(ThreadPoolData& pool, int index, int& victim) throw()
+	{
+		Grok::Task* task;
+		if (index >= 0)
+		{
+			task = Pop(pool.worker.entry[index]);
+			if (task)
+			{
+				return task;
+			}
+		}
+		if (pool.injected.Dequeue(task))
+		{
+			return task;
+		}
+		for (register int w = 0; w < pool.workers; ++w)
+		{
+			victim = (victim + 1 < pool.workers) ? victim + 1 : 0;
+			if (victim != index)
+			{
+				task = Steal(pool.worker.entry[victim]);
+				if (task)
+				{
+					return task;
+				}
+			}
+		}
+		return static_cast<Grok::Task*>(0);
+	}
+
+
+	// The task may be gone once its group is notified
+	static inline void Execute(Grok::Task* task) throw()
+	{
+		register Grok::TaskGroup* group = task->group;
+		task->Run();
+		Grok::AtomicAdd(&group->pending, -1);
+	}
+
+
+	static void WaitForSpawn(ThreadPoolData& pool, Grok::sint32 seen_epoch) throw()
+	{
+		#if defined(OS_Windows)
+			AcquireSRWLockExclusive(&pool.lock);
+			Grok::AtomicAdd(&pool.sleepers, 1);
+			if ((Grok::AtomicLoad(&pool.epoch) == seen_epoch) && !Grok::AtomicLoad(&pool.stop))
+			{
+				SleepConditionVariableSRW(&pool.wake, &pool.lock, INFINITE, 0);
+			}
+			Grok::AtomicAdd(&pool.sleepers, -1);
+			ReleaseSRWLockExclusive(&pool.lock);
+		#else
+			pthread_mutex_lock(&pool.lock);
+			Grok::AtomicAdd(&pool.sleepers, 1);
+			if ((Grok::AtomicLoad(&pool.epoch) == seen_epoch) && !Grok::AtomicLoad(&pool.stop))
+			{
+				pthread_cond_wait(&pool.wake, &pool.lock);
+			}
+			Grok::AtomicAdd(&pool.sleepers, -1);
+			pthread_mutex_unlock(&pool.lock);
+		#endif
+	}
+
+
+	static void WakeAll(ThreadPoolData& pool) throw()
+	{
+		#if defined(OS_Windows)
+			AcquireSRWLockExclusive(&pool.lock);
+			WakeAllConditionVariable(&pool.wake);
+			ReleaseSRWLockExclusive(&pool.lock);
+		#else
+			pthread_mutex_lock(&pool.lock);
+			pthread_cond_broadcast(&pool.wake);
+			pthread_mutex_unlock(&pool.lock);
+		#endif
+	}
+
+
+	static void WorkerLoop(Worker& worker) throw()
+	{
+		register ThreadPoolData& pool = *worker.pool;
+		current_pool = &pool;
+		current_worker = worker.index;
+		if (pool.pin)
+		{
+			PinThread(worker.index + 1);
+		}
+		int victim = worker.index;
+		register int idle = 0;
+		while (!Grok::AtomicLoad(&pool.stop))
+		{
+			register Grok::sint32 seen_epoch = Grok::AtomicLoad(&pool.epoch);
+			register Grok::Task* task = FindTask(pool, worker.index, victim);
+			if (task)
+			{
+				Execute(task);
+				idle = 0;
+			}
+			else if (++idle < THREAD_POOL_SPIN)
+			{
+				if (idle % 64 == 0)
+				{
+					Grok::YieldThread();
+				}
+				else
+				{
+					Grok::CpuRelax();
+				}
+			}
+			else
+			{
+				WaitForSpawn(pool, seen_epoch);
+				idle = 0;
+			}
+		}
+	}
+
+
+	#if defined(OS_Windows)
+
+		static DWORD WINAPI WorkerMain(LPVOID argument)
+		{
+			WorkerLoop(*static_cast<Worker*>(argument));
+			return 0;
+		}
+
+	#else
+
+		static void* WorkerMain(void* argument)
+		{
+			WorkerLoop(*static_cast<Worker*>(argument));
+			return static_cast<void*>(0);
+		}
+
+	#endif
+}
+
+
+namespace Grok
+{
+	void YieldThread() throw()
+	{
+		#if defined(OS_Windows)
+			SwitchToThread();
+		#else
+			sched_yield();
+		#endif
+	}
+
+
+	ThreadPool::ThreadPool(int threads, bool pin) throw(MemoryException)
+	:	data(static_cast<GrokInternal::ThreadPoolData*>(0))
+	{
+		Assert(threads >= 0);
+
+		try
+		{
+			if (threads == 0)
+			{
+				threads = GrokInternal::Processors();
+			}
+			data = new GrokInternal::ThreadPoolData(threads);
+			if (!data)
+			{
+				Throw(MemoryException());
+			}
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+		data->pin = pin;
+		#if defined(OS_Windows)
+			InitializeSRWLock(&data->lock);
+			InitializeConditionVariable(&data->wake);
+		#else
+			pthread_mutex_init(&data->lock, static_cast<pthread_mutexattr_t*>(0));
+			pthread_cond_init(&data->wake, static_cast<pthread_condattr_t*>(0));
+		#endif
+		for (register int w = 0; w < threads - 1; ++w)
+		{
+			register GrokInternal::Worker& worker = data->worker.entry[w];
+			worker.pool = data;
+			worker.index = w;
+			worker.top = 0;
+			worker.bottom = 0;
+		}
+		AtomicFence();
+
+		// A thread that fails to start leaves the pool smaller
+		for (register int w = 0; w < threads - 1; ++w)
+		{
+			register GrokInternal::Worker& worker = data->worker.entry[w];
+			#if defined(OS_Windows)
+				worker.thread = CreateThread(static_cast<LPSECURITY_ATTRIBUTES>(0), 0, GrokInternal::WorkerMain, &worker, 0, static_cast<LPDWORD>(0));
+				if (!worker.thread)
+				{
+					break;
+				}
+			#else
+				if (pthread_create(&worker.thread, static_cast<pthread_attr_t*>(0), GrokInternal::WorkerMain, &worker) != 0)
+				{
+					break;
+				}
+			#endif
+			++data->started;
+		}
+		data->threads = data->started + 1;
+	}
+
+
+	ThreadPool::~ThreadPool() throw()
+	{
+		AtomicStore(&data->stop, static_cast<sint32>(1));
+		GrokInternal::WakeAll(*data);
+		for (register int w = 0; w < data->started; ++w)
+		{
+			#if defined(OS_Windows)
+				WaitForSingleObject(data->worker.entry[w].thread, INFINITE);
+				CloseHandle(data->worker.entry[w].thread);
+			#else
+				pthread_join(data->worker.entry[w].thread, static_cast<void**>(0));
+			#endif
+		}
+		#if !defined(OS_Windows)
+			pthread_cond_destroy(&data->wake);
+			pthread_mutex_destroy(&data->lock);
+		#endif
+		delete data;
+	}
+
+
+	int ThreadPool::Threads() const throw()
+	{
+		return data->threads;
+	}
+
+
+	void ThreadPool::Spawn(Task& task, TaskGroup& group) throw()
+	{
+		Assert(&group.pool == this);
+
+		task.group = &group;
+		AtomicAdd(&group.pending, 1);
+		register bool queued;
+		if ((GrokInternal::current_pool == data) && (GrokInternal::current_worker >= 0))
+		{
+			queued = GrokInternal::Push(data->worker.entry[GrokInternal::current_worker], &task);
+		}
+		else
+		{
+			queued = data->injected.Enqueue(&task);
+		}
+		if (!queued)
+		{
+			GrokInternal::Execute(&task);
+			return;
+		}
+		AtomicAdd(&data->epoch, 1);
+		if (AtomicLoad(&data->sleepers) > 0)
+		{
+			GrokInternal::WakeAll(*data);
+		}
+	}
+
+
+	void ThreadPool::Wait(TaskGroup& group) throw()
+	{
+		register int index = (GrokInternal::current_pool == data) ? GrokInternal::current_worker : -1;
+		int victim = (index >= 0) ? index : 0;
+		register int idle = 0;
+		while (AtomicLoad(&group.pending) > 0)
+		{
+			register Task* task = GrokInternal::FindTask(*data, index, victim);
+			if (task)
+			{
+				GrokInternal::Execute(task);
+				idle = 0;
+			}
+			else if (++idle % 64 == 0)
+			{
+				YieldThread();
+			}
+			else
+			{
+				CpuRelax();
+			}
+		}
+	}
+}
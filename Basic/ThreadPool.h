@@ -0,0 +1,324 @@
+// ThreadPool.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Atomic.h>
+#include <Basic/Integer.h>
+#include <Basic/Memory.h>
+#include <Basic/System.h>
+#include <Container/Vector.h>
+
+
+// Tasks each worker can hold, a power of 2. Spawns that find the deque full run right away.
+#if !defined(THREAD_POOL_DEQUE_SIZE)
+	#define THREAD_POOL_DEQUE_SIZE 4096
+#endif
+
+// Rounds without finding work before an idle worker goes to sleep
+#if !defined(THREAD_POOL_SPIN)
+	#define THREAD_POOL_SPIN 2048
+#endif
+
+
+namespace GrokInternal
+{
+	struct ThreadPoolData;
+}
+
+
+namespace Grok
+{
+	struct TaskGroup;
+
+
+	// Unit of work for a ThreadPool. Run must not throw. The task object has to outlive the Wait of its
+	// group.
+	struct Task
+	{
+		TaskGroup* group;
+
+
+		inline Task() throw()
+		:	group(static_cast<TaskGroup*>(0))
+		{
+		}
+
+
+		virtual ~Task() throw()
+		{
+		}
+
+
+		virtual void Run() throw() = 0;
+	};
+
+
+	// Work-stealing thread pool. Each worker owns a Chase-Lev deque (D. Chase, Y. Lev, Dynamic Circular
+	// Work-Stealing Deque. SPAA 2005; N. M. Le et al., Correct and Efficient Work-Stealing for Weak
+	// Memory Models. PPoPP 2013): it pushes and pops its own spawns at the bottom, idle workers steal from
+	// the top. Threads outside the pool spawn through a shared MPMCQueue. A thread waiting for a group runs
+	// tasks meanwhile, so nested parallel loops do not block workers. Idle workers spin THREAD_POOL_SPIN
+	// rounds and then sleep until the next spawn.
+	class ThreadPool
+	{
+		public:
+
+			// threads counts the thread that waits on the pool, which also runs tasks, so threads - 1 workers
+			// are started; 0 takes one thread per processor. With pin, worker w is bound to processor w + 1.
+			ThreadPool(int threads = 0, bool pin = false) throw(MemoryException);
+
+
+			~ThreadPool() throw();
+
+
+			int Threads() const throw();
+
+
+			void Spawn(Task& task, TaskGroup& group) throw();
+
+
+			// Runs tasks until every task spawned in the group is done
+			void Wait(TaskGroup& group) throw();
+
+
+		private:
+
+			GrokInternal::ThreadPoolData* data;
+
+
+			ThreadPool(const ThreadPool&);
+
+
+			ThreadPool& operator = (const ThreadPool&);
+	};
+
+
+	// Tasks that are waited for together. The destructor waits.
+	struct TaskGroup
+	{
+		ThreadPool& pool;
+
+		volatile sint32 pending;
+
+
+		inline TaskGroup(ThreadPool& pool) throw()
+		:	pool(pool),
+			pending(0)
+		{
+		}
+
+
+		inline ~TaskGroup() throw()
+		{
+			pool.Wait(*this);
+		}
+
+
+		inline void Spawn(Task& task) throw()
+		{
+			pool.Spawn(task, *this);
+		}
+
+
+		inline void Wait() throw()
+		{
+			pool.Wait(*this);
+		}
+
+
+		private:
+
+			TaskGroup(const TaskGroup&);
+
+
+			TaskGroup& operator = (const TaskGroup&);
+	};
+
+
+	namespace ParallelSchedule
+	{
+		enum ID
+		{
+			// One contiguous block per thread
+			blocks,
+
+			// Threads take chunks from a shared counter as they finish the previous ones
+			chunks
+		};
+	}
+}
+
+
+namespace GrokInternal
+{
+	template <typename BODY>
+	struct ParallelForTask : public Grok::Task
+	{
+		const BODY* body;
+
+		int begin;
+
+		int end;
+
+		int chunk;
+
+		// Next chunk, null for blocks
+		volatile Grok::sint64* next;
+
+
+		virtual void Run() throw()
+		{
+			if (!next)
+			{
+				(*body)(begin, end);
+				return;
+			}
+			for (;;)
+			{
+				register Grok::sint64 i = Grok::AtomicAdd(next, static_cast<Grok::sint64>(chunk)) - chunk;
+				if (i >= end)
+				{
+					break;
+				}
+				(*body)(static_cast<int>(i), (i + chunk < end) ? static_cast<int>(i + chunk) : end);
+			}
+		}
+	};
+
+
+	template <typename VALUE, typename BODY>
+	struct ParallelReduceTask : public Grok::Task
+	{
+		const BODY* body;
+
+		int begin;
+
+		int end;
+
+		VALUE* result;
+
+
+		virtual void Run() throw()
+		{
+			*result = (*body)(begin, end);
+		}
+	};
+}
+
+
+namespace Grok
+{
+	// Calls body(i_begin, i_end) over disjoint ranges covering [begin, end), from every thread of the pool.
+	// With ParallelSchedule::chunks the ranges have chunk indices (the last may be shorter).
+	template <typename BODY>
+	void ParallelFor(ThreadPool& pool, int begin, int end, const BODY& body, ParallelSchedule::ID schedule = ParallelSchedule::blocks, int chunk = 1) throw(MemoryException)
+	{
+		Assert(chunk > 0);
+
+		if (end <= begin)
+		{
+			return;
+		}
+		const int size = end - begin;
+		const int parts = (pool.Threads() < size) ? pool.Threads() : size;
+		if (parts == 1)
+		{
+			body(begin, end);
+			return;
+		}
+		try
+		{
+			Vector<GrokInternal::ParallelForTask<BODY> > task(parts);
+			volatile sint64 next = begin;
+			TaskGroup group(pool);
+			for (register int p = 0; p < parts; ++p)
+			{
+				task.entry[p].body = &body;
+				task.entry[p].chunk = chunk;
+				task.entry[p].end = end;
+				if (schedule == ParallelSchedule::blocks)
+				{
+					task.entry[p].begin = begin + static_cast<int>(static_cast<sint64>(size)*p/parts);
+					task.entry[p].end = begin + static_cast<int>(static_cast<sint64>(size)*(p + 1)/parts);
+					task.entry[p].next = static_cast<volatile sint64*>(0);
+				}
+				else
+				{
+					task.entry[p].next = &next;
+				}
+			}
+			for (register int p = 1; p < parts; ++p)
+			{
+				group.Spawn(task.entry[p]);
+			}
+			task.entry[0].Run();
+			group.Wait();
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	// join(... join(join(identity, body(b_0, e_0)), body(b_1, e_1)) ..., body(b_n, e_n)) over one block
+	// [b_p, e_p) per thread, in order, so the result does not depend on timing.
+	template <typename VALUE, typename BODY, typename JOIN>
+	VALUE ParallelReduce(ThreadPool& pool, int begin, int end, const VALUE& identity, const BODY& body, const JOIN& join) throw(MemoryException)
+	{
+		if (end <= begin)
+		{
+			return identity;
+		}
+		const int size = end - begin;
+		const int parts = (pool.Threads() < size) ? pool.Threads() : size;
+		try
+		{
+			Vector<VALUE> result(parts);
+			Vector<GrokInternal::ParallelReduceTask<VALUE, BODY> > task(parts);
+			{
+				TaskGroup group(pool);
+				for (register int p = 0; p < parts; ++p)
+				{
+					task.entry[p].body = &body;
+					task.entry[p].begin = begin + static_cast<int>(static_cast<sint64>(size)*p/parts);
+					task.entry[p].end = begin + static_cast<int>(static_cast<sint64>(size)*(p + 1)/parts);
+					task.entry[p].result = result.entry + p;
+				}
+				for (register int p = 1; p < parts; ++p)
+				{
+					group.Spawn(task.entry[p]);
+				}
+				task.entry[0].Run();
+				group.Wait();
+			}
+			VALUE total = identity;
+			for (register int p = 0; p < parts; ++p)
+			{
+				total = join(total, result.entry[p]);
+			}
+			return total;
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+		return identity;
+	}
+}
@@ -0,0 +1,47 @@
+// Benchmark.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Time.h>
+
+#if defined(_OPENMP)
+	#include <omp.h>
+#endif
+
+
+// Helpers shared by the benchmark programs
+
+// Seconds elapsed since begin, with the millisecond resolution of Time
+inline double Seconds(const Grok::Time& begin) throw()
+{
+	Grok::Time now;
+	now.UseCurrentTime();
+	Grok::Time elapsed = now - begin;
+	return static_cast<double>(elapsed.seconds) + static_cast<double>(elapsed.milliseconds)/1000.0;
+}
+
+
+// Threads of an OpenMP parallel region, 1 without OpenMP
+inline int Threads() throw()
+{
+	#if defined(_OPENMP)
+		return omp_get_max_threads();
+	#else
+		return 1;
+	#endif
+}
@@ -0,0 +1,270 @@
+// GemmBenchmark.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// GFLOP/s of Gemm and Gemv for float and double against the peak of the machine with the instruction
+// set of this build. The peak is measured by every thread running independent chains of multiply-adds
+// on registers, or given in GFLOP/s for double as the first argument. The GEMM_BLOCK_* tile sizes are
+// compiled into the library, to try others rebuild it, e.g.
+// make clean benchmark RELEASE_CPPFLAGS="-DNDEBUG -I. -DGEMM_BLOCK_ROWS=144 -DGEMM_BLOCK_DEPTH=384"
+
+#include <Basic/Random.h>
+#include <Basic/Time.h>
+#include <Benchmark/Benchmark.h>
+#include <Container/DenseMatrix.h>
+#include <Container/Vector.h>
+#include <Math/LinearAlgebra.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+
+// Seconds each measurement runs at least
+#define BENCHMARK_SECONDS 0.5
+
+// Independent multiply-add chains of the peak measurement, enough to cover the latency of a separate
+// multiply and add on two ports while fitting the 16 SIMD registers with the two constants
+#if !defined(BENCHMARK_CHAINS)
+	#define BENCHMARK_CHAINS 12
+#endif
+
+
+using namespace Grok;
+
+
+// Double precision flops of one thread in count rounds of BENCHMARK_CHAINS independent multiply-add chains
+static double PeakKernel(long count) throw()
+{
+	#if defined(__AVX__)
+		const int lanes = 4;
+		__m256d m = _mm256_set1_pd(0.9999999);
+		__m256d c = _mm256_set1_pd(1e-7);
+		__m256d a[BENCHMARK_CHAINS];
+		for (register int k = 0; k < BENCHMARK_CHAINS; ++k)
+		{
+			a[k] = _mm256_set1_pd(1.0 + k);
+		}
+		for (register long i = 0; i < count; ++i)
+		{
+			for (register int k = 0; k < BENCHMARK_CHAINS; ++k)
+			{
+				#if defined(__FMA__)
+					a[k] = _mm256_fmadd_pd(a[k], m, c);
+				#else
+					a[k] = _mm256_add_pd(_mm256_mul_pd(a[k], m), c);
+				#endif
+			}
+		}
+		double sum[4];
+		_mm256_storeu_pd(sum, a[0]);
+		for (register int k = 1; k < BENCHMARK_CHAINS; ++k)
+		{
+			double part[4];
+			_mm256_storeu_pd(part, a[k]);
+			sum[0] += part[0];
+		}
+	#elif defined(__SSE2__)
+		const int lanes = 2;
+		__m128d m = _mm_set1_pd(0.9999999);
+		__m128d c = _mm_set1_pd(1e-7);
+		__m128d a[BENCHMARK_CHAINS];
+		for (register int k = 0; k < BENCHMARK_CHAINS; ++k)
+		{
+			a[k] = _mm_set1_pd(1.0 + k);
+		}
+		for (register long i = 0; i < count; ++i)
+		{
+			for (register int k = 0; k < BENCHMARK_CHAINS; ++k)
+			{
+				a[k] = _mm_add_pd(_mm_mul_pd(a[k], m), c);
+			}
+		}
+		double sum[2];
+		_mm_storeu_pd(sum, a[0]);
+		for (register int k = 1; k < BENCHMARK_CHAINS; ++k)
+		{
+			double part[2];
+			_mm_storeu_pd(part, a[k]);
+			sum[0] += part[0];
+		}
+	#else
+		const int lanes = 1;
+		double a[BENCHMARK_CHAINS];
+		for (register int k = 0; k < BENCHMARK_CHAINS; ++k)
+		{
+			a[k] = 1.0 + k;
+		}
+		for (register long i = 0; i < count; ++i)
+		{
+			for (register int k = 0; k < BENCHMARK_CHAINS; ++k)
+			{
+				a[k] = a[k]*0.9999999 + 1e-7;
+			}
+		}
+		double sum[1] = {a[0]};
+		for (register int k = 1; k < BENCHMARK_CHAINS; ++k)
+		{
+			sum[0] += a[k];
+		}
+	#endif
+
+	// Keeps the chains from being optimized away
+	if (sum[0] == 0.123)
+	{
+		printf(" ");
+	}
+	return 2.0*BENCHMARK_CHAINS*lanes*static_cast<double>(count);
+}
+
+
+// Double precision GFLOP/s of all threads, the best of three runs
+static double MeasurePeak() throw()
+{
+	double peak = 0;
+	for (register int run = 0; run < 3; ++run)
+	{
+		register long count = 1000000;
+		double flops;
+		double elapsed;
+		Time begin;
+		do
+		{
+			count *= 2;
+			flops = 0;
+			begin.UseCurrentTime();
+			#if defined(_OPENMP)
+				#pragma omp parallel reduction(+: flops)
+			#endif
+			{
+				flops += PeakKernel(count);
+			}
+			elapsed = Seconds(begin);
+		}
+		while (elapsed < BENCHMARK_SECONDS);
+		if (flops/elapsed*1e-9 > peak)
+		{
+			peak = flops/elapsed*1e-9;
+		}
+	}
+	return peak;
+}
+
+
+template <typename TYPE>
+void Fill(DenseMatrix<TYPE>& a, Random& random) throw()
+{
+	for (register int i = 0; i < a.rows; ++i)
+	{
+		for (register int j = 0; j < a.columns; ++j)
+		{
+			a(i, j) = static_cast<TYPE>(random.Get() % 2001)/static_cast<TYPE>(1000) - static_cast<TYPE>(1);
+		}
+	}
+}
+
+
+template <typename TYPE>
+void BenchmarkGemm(const char* type_name, double peak) throw(MemoryException)
+{
+	static const int sizes[] = {64, 128, 256, 384, 512, 768, 1024, 1536, 2048};
+	const int size_count = static_cast<int>(sizeof(sizes)/sizeof(sizes[0]));
+
+	printf("\nGemm %s, C = A*B with n x n row-major matrices, peak %.1f GFLOP/s\n", type_name, peak);
+	printf("%6s %10s %8s\n", "n", "GFLOP/s", "% peak");
+	Random random(12345);
+	for (register int s = 0; s < size_count; ++s)
+	{
+		const int n = sizes[s];
+		DenseMatrix<TYPE> a(n, n);
+		DenseMatrix<TYPE> b(n, n);
+		DenseMatrix<TYPE> c(n, n);
+		Fill(a, random);
+		Fill(b, random);
+		register long runs = 0;
+		double elapsed;
+		Time begin;
+		begin.UseCurrentTime();
+		do
+		{
+			Gemm(static_cast<TYPE>(1), a, b, static_cast<TYPE>(0), c);
+			++runs;
+			elapsed = Seconds(begin);
+		}
+		while (elapsed < BENCHMARK_SECONDS);
+		const double gflops = 2.0*n*n*static_cast<double>(n)*static_cast<double>(runs)/elapsed*1e-9;
+		printf("%6i %10.2f %8.1f\n", n, gflops, 100.0*gflops/peak);
+	}
+}
+
+
+template <typename TYPE>
+void BenchmarkGemv(const char* type_name, double peak) throw(MemoryException)
+{
+	static const int sizes[] = {256, 512, 1024, 2048, 4096, 8192};
+	const int size_count = static_cast<int>(sizeof(sizes)/sizeof(sizes[0]));
+
+	printf("\nGemv %s, y = A*x with an n x n row-major matrix, peak %.1f GFLOP/s\n", type_name, peak);
+	printf("%6s %10s %8s %10s\n", "n", "GFLOP/s", "% peak", "GB/s of A");
+	Random random(12345);
+	for (register int s = 0; s < size_count; ++s)
+	{
+		const int n = sizes[s];
+		DenseMatrix<TYPE> a(n, n);
+		Vector<TYPE> x(n);
+		Vector<TYPE> y(n);
+		Fill(a, random);
+		x.Fill(static_cast<TYPE>(1));
+		register long runs = 0;
+		double elapsed;
+		Time begin;
+		begin.UseCurrentTime();
+		do
+		{
+			Gemv(static_cast<TYPE>(1), a, x, static_cast<TYPE>(0), y);
+			++runs;
+			elapsed = Seconds(begin);
+		}
+		while (elapsed < BENCHMARK_SECONDS);
+		const double gflops = 2.0*n*static_cast<double>(n)*static_cast<double>(runs)/elapsed*1e-9;
+		printf("%6i %10.2f %8.1f %10.2f\n", n, gflops, 100.0*gflops/peak, gflops/2.0*sizeof(TYPE));
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		const double peak = (argc > 1) ? atof(argv[1]) : MeasurePeak();
+		printf("Threads %i, GEMM_BLOCK_ROWS %i, GEMM_BLOCK_DEPTH %i, GEMM_BLOCK_COLUMNS %i\n", Threads(), GEMM_BLOCK_ROWS, GEMM_BLOCK_DEPTH, GEMM_BLOCK_COLUMNS);
+		printf("Peak for double %.1f GFLOP/s (%s)\n", peak, (argc > 1) ? "given" : "measured");
+		BenchmarkGemm<double>("double", peak);
+		BenchmarkGemm<float>("float", 2.0*peak);
+		BenchmarkGemv<double>("double", peak);
+		BenchmarkGemv<float>("float", 2.0*peak);
+	}
+	catch (Exception&)
+	{
+		return 1;
+	}
+	return 0;
+}
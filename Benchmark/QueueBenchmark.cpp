@@ -0,0 +1,288 @@
+// QueueBenchmark.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// Millions of values per second passed from producer threads to consumer threads through MPMCQueue,
+// SPSCQueue (one producer and one consumer) and a Queue guarded by a lock, one value per call and in
+// batches. The queues hold the same number of values, a thread that finds its queue full or empty
+// yields the processor and tries again. Run with more threads than processors to see how the batch
+// calls wait on preempted threads, and rebuild to change how long they spin before yielding, e.g.
+// make clean benchmark RELEASE_CPPFLAGS="-DNDEBUG -I. -DCONCURRENT_QUEUE_SPIN=1000000000"
+
+#include <Basic/Atomic.h>
+#include <Basic/Time.h>
+#include <Benchmark/Benchmark.h>
+#include <Container/ConcurrentQueue.h>
+#include <Container/Queue.h>
+
+#include <stdio.h>
+
+#if defined(_OPENMP)
+	#include <omp.h>
+#endif
+
+
+// Values passed in each run
+#define BENCHMARK_VALUES 16000000
+
+// Values each queue holds
+#define BENCHMARK_CAPACITY 1024
+
+// Values per call of the batch runs
+#define BENCHMARK_BATCH 16
+
+
+using namespace Grok;
+
+
+#if defined(_OPENMP)
+
+	// Queue with the interface of MPMCQueue, each call holds a lock
+	struct LockedQueue
+	{
+		LockedQueue() throw()
+		:	queue()
+		{
+			omp_init_lock(&lock);
+		}
+
+
+		~LockedQueue() throw()
+		{
+			omp_destroy_lock(&lock);
+		}
+
+
+		bool Enqueue(const int& value) throw(MemoryException)
+		{
+			return Enqueue(&value, 1) == 1;
+		}
+
+
+		bool Dequeue(int& value) throw()
+		{
+			return Dequeue(&value, 1) == 1;
+		}
+
+
+		int Enqueue(const int* values, int count) throw(MemoryException)
+		{
+			omp_set_lock(&lock);
+			register int n = (BENCHMARK_CAPACITY - queue.size < count) ? BENCHMARK_CAPACITY - queue.size : count;
+			try
+			{
+				for (register int i = 0; i < n; ++i)
+				{
+					queue.Enqueue(values[i]);
+				}
+			}
+			catch (MemoryException&)
+			{
+				omp_unset_lock(&lock);
+				ReThrow();
+			}
+			omp_unset_lock(&lock);
+			return n;
+		}
+
+
+		int Dequeue(int* values, int count) throw()
+		{
+			omp_set_lock(&lock);
+			register int n = (queue.size < count) ? queue.size : count;
+			for (register int i = 0; i < n; ++i)
+			{
+				queue.Dequeue(values[i]);
+			}
+			omp_unset_lock(&lock);
+			return n;
+		}
+
+
+		private:
+
+			Queue<int, 64> queue;
+
+			omp_lock_t lock;
+
+
+			LockedQueue(const LockedQueue&);
+
+
+			LockedQueue& operator = (const LockedQueue&);
+	};
+
+
+	// Batch interface over the calls for one value
+	template <typename QUEUE>
+	struct OneByOne
+	{
+		QUEUE& queue;
+
+
+		OneByOne(QUEUE& queue) throw()
+		:	queue(queue)
+		{
+		}
+
+
+		int Enqueue(const int* values, int count) throw(MemoryException)
+		{
+			register int n = 0;
+			while ((n < count) && queue.Enqueue(values[n]))
+			{
+				++n;
+			}
+			return n;
+		}
+
+
+		int Dequeue(int* values, int count) throw()
+		{
+			register int n = 0;
+			while ((n < count) && queue.Dequeue(values[n]))
+			{
+				++n;
+			}
+			return n;
+		}
+	};
+
+
+	// Millions of values per second, 0 when the values consumed are not the ones produced
+	template <typename QUEUE>
+	double Run(QUEUE& queue, int producers, int consumers, int batch) throw()
+	{
+		volatile sint64 consumed = 0;
+		volatile sint64 sum = 0;
+		volatile sint32 failed = 0;
+		Time begin;
+		begin.UseCurrentTime();
+		#pragma omp parallel num_threads(producers + consumers)
+		{
+			const int thread = omp_get_thread_num();
+			int values[BENCHMARK_BATCH];
+			try
+			{
+				if (thread < producers)
+				{
+					register int next = static_cast<int>(static_cast<sint64>(BENCHMARK_VALUES)*thread/producers);
+					const int end = static_cast<int>(static_cast<sint64>(BENCHMARK_VALUES)*(thread + 1)/producers);
+					while (next < end)
+					{
+						register int count = (end - next < batch) ? end - next : batch;
+						for (register int i = 0; i < count; ++i)
+						{
+							values[i] = next + i;
+						}
+						register int done = 0;
+						while (done < count)
+						{
+							register int n = queue.Enqueue(values + done, count - done);
+							if (n == 0)
+							{
+								YieldThread();
+							}
+							done += n;
+						}
+						next += count;
+					}
+				}
+				else
+				{
+					register sint64 local_sum = 0;
+					while (AtomicLoad(&consumed) < BENCHMARK_VALUES)
+					{
+						register int n = queue.Dequeue(values, batch);
+						if (n == 0)
+						{
+							YieldThread();
+							continue;
+						}
+						for (register int i = 0; i < n; ++i)
+						{
+							local_sum += values[i];
+						}
+						AtomicAdd(&consumed, static_cast<sint64>(n));
+					}
+					AtomicAdd(&sum, local_sum);
+				}
+			}
+			catch (MemoryException&)
+			{
+				AtomicStore(&failed, static_cast<sint32>(1));
+				AtomicAdd(&consumed, static_cast<sint64>(BENCHMARK_VALUES));
+			}
+		}
+		const double elapsed = Seconds(begin);
+		const sint64 expected = static_cast<sint64>(BENCHMARK_VALUES)*(BENCHMARK_VALUES - 1)/2;
+		if (failed || (consumed != BENCHMARK_VALUES) || (sum != expected))
+		{
+			return 0;
+		}
+		return static_cast<double>(BENCHMARK_VALUES)/elapsed*1e-6;
+	}
+
+
+	void Benchmark(int producers, int consumers) throw(MemoryException)
+	{
+		MPMCQueue<int> mpmc(BENCHMARK_CAPACITY);
+		OneByOne<MPMCQueue<int> > mpmc_one(mpmc);
+		LockedQueue locked;
+		OneByOne<LockedQueue> locked_one(locked);
+
+		printf("%9i %9i %9.2f %9.2f", producers, consumers, Run(mpmc_one, producers, consumers, 1), Run(mpmc, producers, consumers, BENCHMARK_BATCH));
+		if ((producers == 1) && (consumers == 1))
+		{
+			SPSCQueue<int> spsc(BENCHMARK_CAPACITY);
+			OneByOne<SPSCQueue<int> > spsc_one(spsc);
+			printf(" %9.2f %9.2f", Run(spsc_one, 1, 1, 1), Run(spsc, 1, 1, BENCHMARK_BATCH));
+		}
+		else
+		{
+			printf(" %9s %9s", "", "");
+		}
+		printf(" %9.2f %9.2f\n", Run(locked_one, producers, consumers, 1), Run(locked, producers, consumers, BENCHMARK_BATCH));
+	}
+
+#endif
+
+
+int main()
+{
+	#if defined(_OPENMP)
+		static const int threads[][2] = {{1, 1}, {2, 2}, {4, 4}, {1, 4}, {4, 1}, {8, 8}};
+		const int thread_count = static_cast<int>(sizeof(threads)/sizeof(threads[0]));
+
+		try
+		{
+			printf("Processors %i, CONCURRENT_QUEUE_SPIN %i, capacity %i, batch %i, Mvalues/s (0 on a wrong result)\n", omp_get_num_procs(), CONCURRENT_QUEUE_SPIN, BENCHMARK_CAPACITY, BENCHMARK_BATCH);
+			printf("%9s %9s %9s %9s %9s %9s %9s %9s\n", "producers", "consumers", "MPMC", "batch", "SPSC", "batch", "locked", "batch");
+			for (register int t = 0; t < thread_count; ++t)
+			{
+				Benchmark(threads[t][0], threads[t][1]);
+			}
+		}
+		catch (Exception&)
+		{
+			return 1;
+		}
+		return 0;
+	#else
+		printf("Build with OpenMP to run the threads\n");
+		return 1;
+	#endif
+}
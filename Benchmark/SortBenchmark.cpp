@@ -0,0 +1,199 @@
+// SortBenchmark.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// Time per element of the small-array sorts, to place SORT_NETWORK_LIMIT (largest size Sort hands to
+// the bitonic network, RadixSort above it) and SORT_RADIX_COMB_LIMIT (size from which radix sorts beat
+// CombSort). Many arrays of each size are copied from random data and sorted; the copy alone is timed
+// and subtracted. NetworkSort falls back to CombSort above SORT_NETWORK_LIMIT, so to time the network
+// past it rebuild with a larger power of 2:
+// make clean benchmark RELEASE_CPPFLAGS="-DNDEBUG -I. -DSORT_NETWORK_LIMIT=1024"
+
+#include <Basic/Random.h>
+#include <Basic/Sort.h>
+#include <Basic/Time.h>
+#include <Benchmark/Benchmark.h>
+#include <Container/Vector.h>
+
+#include <stdio.h>
+#include <string.h>
+
+
+// Elements sorted per round, small enough to stay in the L2 cache
+#define BENCHMARK_ELEMENTS 32768
+
+// Seconds each measurement runs at least
+#define BENCHMARK_SECONDS 0.2
+
+
+using namespace Grok;
+
+
+struct CopyOnly
+{
+	template <typename TYPE>
+	inline void operator () (TYPE*, int) const throw()
+	{
+	}
+};
+
+
+struct CallNetworkSort
+{
+	template <typename TYPE>
+	inline void operator () (TYPE* vector, int size) const throw()
+	{
+		NetworkSort(vector, size);
+	}
+};
+
+
+struct CallCombSort
+{
+	template <typename TYPE>
+	inline void operator () (TYPE* vector, int size) const throw()
+	{
+		CombSort(vector, size);
+	}
+};
+
+
+struct CallRadixSort
+{
+	template <typename TYPE>
+	inline void operator () (TYPE* vector, int size) const throw(MemoryException)
+	{
+		RadixSort(vector, size);
+	}
+};
+
+
+struct CallInPlaceRadixSort
+{
+	template <typename TYPE>
+	inline void operator () (TYPE* vector, int size) const throw()
+	{
+		InPlaceRadixSort(vector, size);
+	}
+};
+
+
+struct CallSort
+{
+	template <typename TYPE>
+	inline void operator () (TYPE* vector, int size) const throw(MemoryException)
+	{
+		Sort(vector, size);
+	}
+};
+
+
+// Nanoseconds per element to copy and sort every array of the given size in source
+template <typename TYPE, typename SORT>
+double Measure(const Vector<TYPE>& source, Vector<TYPE>& work, int size, const SORT& sort, bool check = true) throw(MemoryException)
+{
+	const int arrays = source.size/size;
+	register long rounds = 0;
+	double elapsed;
+	Time begin;
+	begin.UseCurrentTime();
+	do
+	{
+		for (register int r = 0; r < 16; ++r)
+		{
+			memcpy(work.entry, source.entry, sizeof(TYPE)*static_cast<size_t>(arrays)*static_cast<size_t>(size));
+			for (register int a = 0; a < arrays; ++a)
+			{
+				sort(work.entry + a*size, size);
+			}
+		}
+		rounds += 16;
+		elapsed = Seconds(begin);
+	}
+	while (elapsed < BENCHMARK_SECONDS);
+
+	for (register int a = 0; check && (a < arrays); ++a)
+	{
+		for (register int i = a*size + 1; i < (a + 1)*size; ++i)
+		{
+			if (work.entry[i] < work.entry[i - 1])
+			{
+				printf("error: array not sorted\n");
+				return 0;
+			}
+		}
+	}
+	return elapsed*1e9/(static_cast<double>(rounds)*static_cast<double>(arrays)*static_cast<double>(size));
+}
+
+
+template <typename TYPE>
+void Benchmark(const char* type_name) throw(MemoryException)
+{
+	static const int sizes[] = {8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+	const int size_count = static_cast<int>(sizeof(sizes)/sizeof(sizes[0]));
+
+	Random random(12345);
+	Vector<TYPE> source(BENCHMARK_ELEMENTS);
+	Vector<TYPE> work(BENCHMARK_ELEMENTS);
+	for (register int i = 0; i < BENCHMARK_ELEMENTS; ++i)
+	{
+		register uint64 bits = (static_cast<uint64>(random.Get()) << 32) | random.Get();
+		source.entry[i] = static_cast<TYPE>(static_cast<sint64>(bits) >> (64 - 8*sizeof(TYPE) + 1));
+	}
+
+	printf("\n%s, ns per element (SORT_NETWORK_LIMIT %i, SORT_RADIX_COMB_LIMIT %i)\n", type_name, SORT_NETWORK_LIMIT, SORT_RADIX_COMB_LIMIT);
+	printf("%6s %9s %9s %9s %9s %9s\n", "size", "network", "comb", "radix", "in-place", "Sort");
+	int network_crossover = 0;
+	int comb_crossover = 0;
+	for (register int s = 0; s < size_count; ++s)
+	{
+		const int size = sizes[s];
+		const double copy = Measure(source, work, size, CopyOnly(), false);
+		const double network = Measure(source, work, size, CallNetworkSort()) - copy;
+		const double comb = Measure(source, work, size, CallCombSort()) - copy;
+		const double radix = Measure(source, work, size, CallRadixSort()) - copy;
+		const double in_place = Measure(source, work, size, CallInPlaceRadixSort()) - copy;
+		const double sort = Measure(source, work, size, CallSort()) - copy;
+		printf("%6i %9.2f %9.2f %9.2f %9.2f %9.2f\n", size, network, comb, radix, in_place, sort);
+		if (!network_crossover && (radix < network))
+		{
+			network_crossover = size;
+		}
+		if (!comb_crossover && (radix < comb))
+		{
+			comb_crossover = size;
+		}
+	}
+	printf("RadixSort is first faster than NetworkSort at size %i and than CombSort at size %i\n", network_crossover, comb_crossover);
+}
+
+
+int main()
+{
+	try
+	{
+		Benchmark<sint32>("sint32");
+		Benchmark<sint64>("sint64");
+		Benchmark<float>("float");
+		Benchmark<double>("double");
+	}
+	catch (Exception&)
+	{
+		return 1;
+	}
+	return 0;
+}
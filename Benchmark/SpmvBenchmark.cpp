@@ -0,0 +1,226 @@
+// SpmvBenchmark.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// Effective bandwidth of Spmv with CSR and SELL matrices against the STREAM copy and triad bandwidth of
+// the machine. The effective bandwidth counts the least traffic of a product: values and columns of the
+// stored entries, the row pointers, x once and y once, so SELL padding and repeated reads of x show up
+// as lower bandwidth. Matrices with equal row lengths place SPMV_GATHER_LIMIT (the AVX2 gathers are used
+// only with -mavx2), matrices with a few long rows among short ones show what SELL gains. Each case is run
+// with a matrix in memory, bound by bandwidth, and with one in the L2 cache, where the cost of the
+// arithmetic and the gathers shows. To try another limit rebuild the library, e.g.
+// make clean benchmark RELEASE_CXXFLAGS="-ffast-math -march=native -fopenmp -O3" RELEASE_CPPFLAGS="-DNDEBUG -I. -DSPMV_GATHER_LIMIT=32"
+
+#include <Basic/Random.h>
+#include <Basic/Time.h>
+#include <Benchmark/Benchmark.h>
+#include <Container/CSRMatrix.h>
+#include <Container/SELLMatrix.h>
+#include <Container/Vector.h>
+#include <Math/LinearAlgebra.h>
+
+#include <stdio.h>
+
+
+// Stored entries of the matrices in memory, far larger than the caches
+#define BENCHMARK_NONZEROS 16777216
+
+// Stored entries of the matrices in the L2 cache
+#define BENCHMARK_CACHED_NONZEROS 65536
+
+// Entries of each STREAM array
+#define BENCHMARK_STREAM_ELEMENTS 33554432
+
+// Columns of a row are taken from a band this wide around the diagonal, so x is reused from cache
+#define BENCHMARK_BAND 4096
+
+// Seconds each measurement runs at least
+#define BENCHMARK_SECONDS 0.5
+
+
+using namespace Grok;
+
+
+// GB/s of the STREAM copy c = a (copy true) or triad a = b + s*c for double arrays
+static double Stream(bool copy) throw(MemoryException)
+{
+	const int size = BENCHMARK_STREAM_ELEMENTS;
+	Vector<double> a(size);
+	Vector<double> b(size);
+	Vector<double> c(size);
+	double* __restrict a_e = a.entry;
+	double* __restrict b_e = b.entry;
+	double* __restrict c_e = c.entry;
+	#if defined(_OPENMP)
+		#pragma omp parallel for schedule(static)
+	#endif
+	for (int i = 0; i < size; ++i)
+	{
+		a_e[i] = 1.0;
+		b_e[i] = 2.0;
+		c_e[i] = 0.5;
+	}
+
+	register long runs = 0;
+	double elapsed;
+	Time begin;
+	begin.UseCurrentTime();
+	do
+	{
+		if (copy)
+		{
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static)
+			#endif
+			for (int i = 0; i < size; ++i)
+			{
+				c_e[i] = a_e[i];
+			}
+		}
+		else
+		{
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static)
+			#endif
+			for (int i = 0; i < size; ++i)
+			{
+				a_e[i] = b_e[i] + 0.5*c_e[i];
+			}
+		}
+		++runs;
+		elapsed = Seconds(begin);
+	}
+	while (elapsed < BENCHMARK_SECONDS);
+	return (copy ? 2.0 : 3.0)*sizeof(double)*static_cast<double>(size)*static_cast<double>(runs)/elapsed*1e-9;
+}
+
+
+// Square matrix with about the given nonzeros in rows of the given length, or when length is 0 mostly rows
+// of 2 to 7 entries with one in 64 rows holding 64 to 1087 entries
+template <typename TYPE>
+void Generate(SparseMatrixCSR<TYPE>& a, int nonzeros, int length, Random& random) throw(MemoryException)
+{
+	const int rows = (length > 0) ? nonzeros/length : nonzeros/14;
+	Vector<int> row_length(rows);
+	register int stored = 0;
+	for (register int i = 0; i < rows; ++i)
+	{
+		if (length > 0)
+		{
+			row_length.entry[i] = length;
+		}
+		else
+		{
+			row_length.entry[i] = (random.Get() % 64 == 0) ? 64 + static_cast<int>(random.Get() % 1024) : 2 + static_cast<int>(random.Get() % 6);
+		}
+		stored += row_length.entry[i];
+	}
+
+	a.Resize(rows, rows, stored);
+	register int k = 0;
+	for (register int i = 0; i < rows; ++i)
+	{
+		a.row_begin.entry[i] = k;
+
+		// One column picked at random in each of row_length equal parts of the band
+		int band = (row_length.entry[i] > BENCHMARK_BAND) ? row_length.entry[i] : BENCHMARK_BAND;
+		band = (band > rows) ? rows : band;
+		register int first = i - band/2;
+		first = (first + band > rows) ? rows - band : first;
+		first = (first < 0) ? 0 : first;
+		const int step = band/row_length.entry[i];
+		for (register int p = 0; p < row_length.entry[i]; ++p, ++k)
+		{
+			a.column.entry[k] = first + p*step + static_cast<int>(random.Get() % static_cast<unsigned int>(step));
+			a.value.entry[k] = static_cast<TYPE>(random.Get() % 2001)/static_cast<TYPE>(1000) - static_cast<TYPE>(1);
+		}
+	}
+	a.row_begin.entry[rows] = k;
+}
+
+
+// Seconds per product y = A*x
+template <typename TYPE, typename MATRIX>
+double Measure(const MATRIX& a, const Vector<TYPE>& x, Vector<TYPE>& y) throw()
+{
+	register long runs = 0;
+	double elapsed;
+	Time begin;
+	begin.UseCurrentTime();
+	do
+	{
+		Spmv(static_cast<TYPE>(1), a, x, static_cast<TYPE>(0), y);
+		++runs;
+		elapsed = Seconds(begin);
+	}
+	while (elapsed < BENCHMARK_SECONDS);
+	return elapsed/static_cast<double>(runs);
+}
+
+
+template <typename TYPE>
+void Benchmark(const char* type_name, int nonzeros, double stream) throw(MemoryException)
+{
+	static const int lengths[] = {2, 4, 6, 8, 12, 16, 24, 32, 48, 64, 128, 0};
+	const int length_count = static_cast<int>(sizeof(lengths)/sizeof(lengths[0]));
+
+	printf("\n%s, %i entries, effective GB/s and %% of the STREAM triad (SPMV_GATHER_LIMIT %i)\n", type_name, nonzeros, SPMV_GATHER_LIMIT);
+	printf("%10s %9s %7s %9s %7s %8s\n", "row length", "CSR", "%", "SELL", "%", "padding");
+	Random random(12345);
+	for (register int l = 0; l < length_count; ++l)
+	{
+		SparseMatrixCSR<TYPE> a;
+		Generate(a, nonzeros, lengths[l], random);
+		SparseMatrixSELL<TYPE> sell(a);
+		Vector<TYPE> x(a.columns);
+		Vector<TYPE> y(a.rows);
+		x.Fill(static_cast<TYPE>(1));
+
+		const double bytes = static_cast<double>(a.NonZeros())*(sizeof(TYPE) + sizeof(int)) + static_cast<double>(a.rows + 1)*sizeof(int) + static_cast<double>(a.columns + a.rows)*sizeof(TYPE);
+		const double csr = bytes/Measure(a, x, y)*1e-9;
+		const double sell_bandwidth = bytes/Measure(sell, x, y)*1e-9;
+		const double padding = static_cast<double>(sell.Size())/static_cast<double>(a.NonZeros());
+		if (lengths[l] > 0)
+		{
+			printf("%10i", lengths[l]);
+		}
+		else
+		{
+			printf("%10s", "irregular");
+		}
+		printf(" %9.2f %7.1f %9.2f %7.1f %8.2f\n", csr, 100.0*csr/stream, sell_bandwidth, 100.0*sell_bandwidth/stream, padding);
+	}
+}
+
+
+int main()
+{
+	try
+	{
+		const double copy = Stream(true);
+		const double triad = Stream(false);
+		printf("Threads %i, STREAM copy %.2f GB/s, triad %.2f GB/s\n", Threads(), copy, triad);
+		Benchmark<double>("double", BENCHMARK_NONZEROS, triad);
+		Benchmark<float>("float", BENCHMARK_NONZEROS, triad);
+		Benchmark<double>("double", BENCHMARK_CACHED_NONZEROS, triad);
+		Benchmark<float>("float", BENCHMARK_CACHED_NONZEROS, triad);
+	}
+	catch (Exception&)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,160 @@
+// ThreadPoolBenchmark.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+// Overhead of the ThreadPool: nanoseconds per empty task spawned and waited for, from a thread outside
+// the pool (through the shared queue) and from a task inside it (through the worker's deque), and
+// microseconds per ParallelFor call with an empty body, for pools of several sizes and one with a thread
+// per processor. Pools with more threads than processors show the cost of oversubscription. A pool of
+// one thread has no workers, so its tasks inside spawn through the shared queue too.
+
+#include <Basic/ThreadPool.h>
+#include <Basic/Time.h>
+#include <Benchmark/Benchmark.h>
+#include <Container/Vector.h>
+
+#include <stdio.h>
+
+
+// Tasks spawned in each group, below THREAD_POOL_DEQUE_SIZE so none runs on the spot
+#define BENCHMARK_TASKS 1024
+
+// Seconds each measurement runs at least
+#define BENCHMARK_SECONDS 0.5
+
+
+using namespace Grok;
+
+
+struct EmptyTask : public Task
+{
+	virtual void Run() throw()
+	{
+	}
+};
+
+
+// Spawns count tasks into a group of its own and waits for them
+struct SpawnTask : public Task
+{
+	ThreadPool* pool;
+
+	EmptyTask* task;
+
+	int count;
+
+
+	virtual void Run() throw()
+	{
+		TaskGroup group(*pool);
+		for (register int t = 0; t < count; ++t)
+		{
+			group.Spawn(task[t]);
+		}
+		group.Wait();
+	}
+};
+
+
+struct EmptyBody
+{
+	inline void operator () (int, int) const throw()
+	{
+	}
+};
+
+
+// Nanoseconds per task spawned from this thread, or from a task in the pool when inside
+static double MeasureSpawn(ThreadPool& pool, bool inside) throw(MemoryException)
+{
+	Vector<EmptyTask> task(BENCHMARK_TASKS);
+	SpawnTask spawn;
+	spawn.pool = &pool;
+	spawn.task = task.entry;
+	spawn.count = BENCHMARK_TASKS;
+
+	register long rounds = 0;
+	double elapsed;
+	Time begin;
+	begin.UseCurrentTime();
+	do
+	{
+		if (inside)
+		{
+			TaskGroup group(pool);
+			group.Spawn(spawn);
+			group.Wait();
+		}
+		else
+		{
+			spawn.Run();
+		}
+		++rounds;
+		elapsed = Seconds(begin);
+	}
+	while (elapsed < BENCHMARK_SECONDS);
+	return elapsed*1e9/(static_cast<double>(rounds)*BENCHMARK_TASKS);
+}
+
+
+// Microseconds per ParallelFor call over one index per thread
+static double MeasureParallelFor(ThreadPool& pool, ParallelSchedule::ID schedule) throw(MemoryException)
+{
+	const EmptyBody body;
+	register long calls = 0;
+	double elapsed;
+	Time begin;
+	begin.UseCurrentTime();
+	do
+	{
+		for (register int c = 0; c < 64; ++c)
+		{
+			ParallelFor(pool, 0, pool.Threads(), body, schedule);
+		}
+		calls += 64;
+		elapsed = Seconds(begin);
+	}
+	while (elapsed < BENCHMARK_SECONDS);
+	return elapsed*1e6/static_cast<double>(calls);
+}
+
+
+int main()
+{
+	// 0 is one thread per processor
+	static const int threads[] = {1, 2, 4, 8, 0};
+	const int thread_count = static_cast<int>(sizeof(threads)/sizeof(threads[0]));
+
+	try
+	{
+		printf("Empty tasks, %i per group\n", BENCHMARK_TASKS);
+		printf("%7s %14s %14s %14s %14s\n", "threads", "outside ns", "inside ns", "blocks us", "chunks us");
+		for (register int t = 0; t < thread_count; ++t)
+		{
+			ThreadPool pool(threads[t]);
+			const double outside = MeasureSpawn(pool, false);
+			const double inside = MeasureSpawn(pool, true);
+			const double blocks = MeasureParallelFor(pool, ParallelSchedule::blocks);
+			const double chunks = MeasureParallelFor(pool, ParallelSchedule::chunks);
+			printf("%7i %14.1f %14.1f %14.2f %14.2f\n", pool.Threads(), outside, inside, blocks, chunks);
+		}
+	}
+	catch (Exception&)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -19,6 +19,7 @@
 
 #include <Basic/Assert.h>
 #include <Basic/Memory.h>
+#include <Container/MatrixView.h>
 
 
 namespace Grok
@@ -38,8 +39,7 @@ namespace Grok
 		:	entry(static_cast<TYPE***>(0)),
 			pages(0),
 			rows(0),
-			columns(0),
-			manage(true)
+			columns(0)
 		{
 		}
 
@@ -58,6 +58,20 @@ namespace Grok
 		}
 
 
+		Array3(int pages, int rows, int columns, const MemoryPolicy& policy) throw(MemoryException)
+		{
+			try
+			{
+				entry = static_cast<TYPE***>(0);
+				Resize(pages, rows, columns, policy);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
 		Array3(const Array3& array3, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
 		{
 		try
@@ -84,6 +98,23 @@ namespace Grok
 		}
 
 
+		#if defined(RVALUE_REFERENCES)
+
+			inline Array3(Array3&& array3) throw()
+			:	entry(array3.entry),
+				pages(array3.pages),
+				rows(array3.rows),
+				columns(array3.columns)
+			{
+				array3.entry = static_cast<TYPE***>(0);
+				array3.pages = 0;
+				array3.rows = 0;
+				array3.columns = 0;
+			}
+
+		#endif
+
+
 		inline ~Array3() throw()
 		{
 			if (entry)
@@ -117,24 +148,126 @@ namespace Grok
 		}
 
 
+		#if defined(RVALUE_REFERENCES)
+
+			// Unlike the copy, a move may change the dimensions
+			inline Array3& operator = (Array3&& array3) throw()
+			{
+				Swap(array3);
+				return *this;
+			}
+
+		#endif
+
+
+		// Exchanges the buffers, nothing is allocated nor copied
+		inline void Swap(Array3& array3) throw()
+		{
+			register TYPE*** swap_entry = entry;
+			entry = array3.entry;
+			array3.entry = swap_entry;
+			register int swap_pages = pages;
+			pages = array3.pages;
+			array3.pages = swap_pages;
+			register int swap_rows = rows;
+			rows = array3.rows;
+			array3.rows = swap_rows;
+			register int swap_columns = columns;
+			columns = array3.columns;
+			array3.columns = swap_columns;
+		}
+
+
+		// Takes ownership of buffers laid out as Reallocate does (page array, row array in entry[0], data
+		// block in entry[0][0]), the current ones are released
+		inline void Adopt(TYPE*** entry, int pages, int rows, int columns) throw()
+		{
+			Assert(entry || (pages == 0));
+
+			if (this->entry)
+			{
+				delete [] this->entry[0][0];
+				delete [] this->entry[0];
+				delete [] this->entry;
+			}
+			this->entry = entry;
+			this->pages = pages;
+			this->rows = rows;
+			this->columns = columns;
+		}
+
+
+		// Gives up the buffers, the caller has to delete [] entry[0][0], entry[0] and entry, and leaves the
+		// array empty
+		inline TYPE*** Release() throw()
+		{
+			register TYPE*** buffer = entry;
+			entry = static_cast<TYPE***>(0);
+			pages = 0;
+			rows = 0;
+			columns = 0;
+			return buffer;
+		}
+
+
+		// Row-major view of one page, rows of all pages share the stride Reallocate gives them
+		MatrixView<TYPE> View(int page) const throw()
+		{
+			Assert((page >= 0) && (page < pages));
+
+			register int leading = columns;
+			if (rows > 1)
+			{
+				register size_t row_size = static_cast<size_t>(reinterpret_cast<const char*>(entry[page][1]) - reinterpret_cast<const char*>(entry[page][0]));
+
+				Assert(row_size % sizeof(TYPE) == 0);
+
+				leading = static_cast<int>(row_size/sizeof(TYPE));
+			}
+			return MatrixView<TYPE>(entry[page][0], rows, columns, leading, MatrixLayout::row_major);
+		}
+
+
+		// Rows of all pages are filled in parallel with a static schedule to place each memory page by first touch
 		void Fill(const TYPE& value) throw()
 		{
-			for (int h = 0; h < pages; ++h)
+			if (!entry)
+			{
+				return;
+			}
+			TYPE** __restrict entry_0 = entry[0];
+			const int pages_rows = pages*rows;
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (static_cast<size_t>(pages_rows)*static_cast<size_t>(columns) >= PARALLEL_FILL_LIMIT)
+			#endif
+			for (int k = 0; k < pages_rows; ++k)
 			{
-				for (register int i = 0; i < rows; ++i)
+				register TYPE* __restrict entry_h_i = entry_0[k];
+				for (register int j = 0; j < columns; ++j)
 				{
-					register TYPE* __restrict entry_h_i = entry[h][i];
-					for (register int j = 0; j < columns; ++j)
-					{
-						entry_h_i[j] = value;
-					}
+					entry_h_i[j] = value;
 				}
 			}
 		}
 
 
-		void Resize(int pages, int rows, int columns, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
+		inline void Resize(int pages, int rows, int columns, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
+		{
+			Reallocate(pages, rows, columns, alignment);
+		}
+
+
+		inline void Resize(int pages, int rows, int columns, const MemoryPolicy& policy) throw(MemoryException)
+		{
+			Reallocate(pages, rows, columns, policy);
+		}
+
+
+		template <typename ALLOCATION>
+		void Reallocate(int pages, int rows, int columns, const ALLOCATION& allocation) throw(MemoryException)
 		{
+			const unsigned short alignment = GrokInternal::AllocationAlignment(allocation);
+
 			Assert(pages > 0);
 			Assert(rows > 0);
 			Assert(columns > 0);
@@ -153,8 +286,8 @@ namespace Grok
 					register TYPE** entry_h = new(alignment) TYPE*[(size_t)pages*rows];
 					if (entry_h)
 					{
-						unsigned int row_size = SIZE_WITH_PAD(TYPE, columns, align);
-						register char* __restrict entry_h_i = new(alignment) char[(size_t)pages*(unsigned int)rows*(unsigned int)row_size];
+						unsigned int row_size = SIZE_WITH_PAD(TYPE, columns, alignment);
+						register char* __restrict entry_h_i = new(allocation) char[(size_t)pages*(unsigned int)rows*(unsigned int)row_size];
 						if (entry_h_i)
 						{
 							for (register int h = 0; h < pages; ++h)
@@ -0,0 +1,1187 @@
+// BTree.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Memory.h>
+#include <Basic/System.h>
+#include <Container/Vector.h>
+
+
+// Bytes of a tree node, a multiple of the cache line. Nodes hold as many keys as fit, at least 4.
+#if !defined(BTREE_NODE_BYTES)
+	#define BTREE_NODE_BYTES 256
+#endif
+
+
+namespace GrokInternal
+{
+	enum
+	{
+		// Nodes are at least half full and have 4 keys or more, so 2^31 keys need fewer levels
+		btree_maximum_height = 32
+	};
+
+
+	// Value type of the sets, not stored
+	struct BTreeNoValue
+	{
+	};
+
+
+	template <typename KEY, typename VALUE>
+	struct BTreeLeaf : public Grok::PoolObject
+	{
+		enum
+		{
+			capacity = ((BTREE_NODE_BYTES - 3*sizeof(void*))/(sizeof(KEY) + sizeof(VALUE)) < 4) ? 4 : (BTREE_NODE_BYTES - 3*sizeof(void*))/(sizeof(KEY) + sizeof(VALUE))
+		};
+
+		BTreeLeaf* previous;
+
+		BTreeLeaf* next;
+
+		int count;
+
+		KEY key[capacity];
+
+		VALUE value[capacity];
+
+
+		inline void Insert(int i, const KEY& k, const VALUE& v) throw()
+		{
+			for (register int j = count; j > i; --j)
+			{
+				key[j] = key[j - 1];
+				value[j] = value[j - 1];
+			}
+			key[i] = k;
+			value[i] = v;
+			++count;
+		}
+
+
+		inline void Erase(int i) throw()
+		{
+			--count;
+			for (register int j = i; j < count; ++j)
+			{
+				key[j] = key[j + 1];
+				value[j] = value[j + 1];
+			}
+		}
+
+
+		// Appends the entries [begin, count) to leaf
+		inline void MoveTo(int begin, BTreeLeaf* __restrict leaf) throw()
+		{
+			for (register int j = begin; j < count; ++j)
+			{
+				leaf->key[leaf->count] = key[j];
+				leaf->value[leaf->count] = value[j];
+				++leaf->count;
+			}
+			count = begin;
+		}
+
+
+		// Moves entry i to position j of leaf
+		inline void Transfer(int i, BTreeLeaf* __restrict leaf, int j) throw()
+		{
+			leaf->Insert(j, key[i], value[i]);
+			Erase(i);
+		}
+	};
+
+
+	template <typename KEY>
+	struct BTreeLeaf<KEY, BTreeNoValue> : public Grok::PoolObject
+	{
+		enum
+		{
+			capacity = ((BTREE_NODE_BYTES - 3*sizeof(void*))/sizeof(KEY) < 4) ? 4 : (BTREE_NODE_BYTES - 3*sizeof(void*))/sizeof(KEY)
+		};
+
+		BTreeLeaf* previous;
+
+		BTreeLeaf* next;
+
+		int count;
+
+		KEY key[capacity];
+
+
+		inline void Insert(int i, const KEY& k, const BTreeNoValue&) throw()
+		{
+			for (register int j = count; j > i; --j)
+			{
+				key[j] = key[j - 1];
+			}
+			key[i] = k;
+			++count;
+		}
+
+
+		inline void Erase(int i) throw()
+		{
+			--count;
+			for (register int j = i; j < count; ++j)
+			{
+				key[j] = key[j + 1];
+			}
+		}
+
+
+		inline void MoveTo(int begin, BTreeLeaf* __restrict leaf) throw()
+		{
+			for (register int j = begin; j < count; ++j)
+			{
+				leaf->key[leaf->count++] = key[j];
+			}
+			count = begin;
+		}
+
+
+		inline void Transfer(int i, BTreeLeaf* __restrict leaf, int j) throw()
+		{
+			leaf->Insert(j, key[i], BTreeNoValue());
+			Erase(i);
+		}
+	};
+
+
+	// key[i] is the smallest key under child[i + 1]
+	template <typename KEY>
+	struct BTreeInner : public Grok::PoolObject
+	{
+		enum
+		{
+			capacity = ((BTREE_NODE_BYTES - 2*sizeof(void*))/(sizeof(KEY) + sizeof(void*)) < 4) ? 4 : (BTREE_NODE_BYTES - 2*sizeof(void*))/(sizeof(KEY) + sizeof(void*))
+		};
+
+		int count;
+
+		KEY key[capacity];
+
+		void* child[capacity + 1];
+
+
+		inline void Insert(int i, const KEY& k, void* right) throw()
+		{
+			for (register int j = count; j > i; --j)
+			{
+				key[j] = key[j - 1];
+				child[j + 1] = child[j];
+			}
+			key[i] = k;
+			child[i + 1] = right;
+			++count;
+		}
+
+
+		// Removes key[i] and child[i + 1]
+		inline void Erase(int i) throw()
+		{
+			--count;
+			for (register int j = i; j < count; ++j)
+			{
+				key[j] = key[j + 1];
+				child[j + 1] = child[j + 2];
+			}
+		}
+	};
+
+
+	// B+tree shared by BTreeSet and BTreeMap. Every entry is in a leaf, leaves are linked in order both
+	// ways, inner nodes only route searches. All leaves are at the same depth, height is the number of
+	// inner levels above them.
+	template <typename KEY, typename VALUE>
+	struct BTree
+	{
+		typedef BTreeLeaf<KEY, VALUE> Leaf;
+
+		typedef BTreeInner<KEY> Inner;
+
+
+		// Position of an entry, past the end (or before the beginning) when leaf is null
+		struct Iterator
+		{
+			Leaf* leaf;
+
+			int index;
+
+
+			inline bool Valid() const throw()
+			{
+				return leaf != static_cast<Leaf*>(0);
+			}
+
+
+			inline const KEY& Key() const throw()
+			{
+				return leaf->key[index];
+			}
+
+
+			inline VALUE& Value() const throw()
+			{
+				return leaf->value[index];
+			}
+
+
+			inline void Next() throw()
+			{
+				if (++index == leaf->count)
+				{
+					leaf = leaf->next;
+					index = 0;
+				}
+			}
+
+
+			inline void Previous() throw()
+			{
+				if (index-- == 0)
+				{
+					leaf = leaf->previous;
+					index = leaf ? leaf->count - 1 : 0;
+				}
+			}
+		};
+
+
+		int size;
+
+
+		BTree() throw()
+		:	size(0),
+			root(static_cast<void*>(0)),
+			first(static_cast<Leaf*>(0)),
+			last(static_cast<Leaf*>(0)),
+			height(0)
+		{
+		}
+
+
+		// Copies the leaves as they are and rebuilds the inner levels
+		BTree(const BTree<KEY, VALUE>& tree) throw(Grok::MemoryException)
+		:	size(0),
+			root(static_cast<void*>(0)),
+			first(static_cast<Leaf*>(0)),
+			last(static_cast<Leaf*>(0)),
+			height(0)
+		{
+			try
+			{
+				register int leaves = 0;
+				for (register const Leaf* __restrict leaf = tree.first; leaf; leaf = leaf->next)
+				{
+					++leaves;
+				}
+				Grok::Vector<void*> level(leaves);
+				Grok::Vector<KEY> lowest(leaves);
+				register int l = 0;
+				for (register const Leaf* __restrict leaf = tree.first; leaf; leaf = leaf->next)
+				{
+					register Leaf* __restrict copy = NewLeaf();
+					*copy = *leaf;
+					Link(copy);
+					level.entry[l] = copy;
+					lowest.entry[l] = copy->key[0];
+					++l;
+				}
+				if (leaves > 0)
+				{
+					BuildInner(level, lowest);
+				}
+				size = tree.size;
+			}
+			catch (Grok::MemoryException&)
+			{
+				ReleaseChain();
+				ReThrow();
+			}
+		}
+
+
+		~BTree() throw()
+		{
+			Clear();
+		}
+
+
+		BTree<KEY, VALUE>& operator = (const BTree<KEY, VALUE>& tree) throw(Grok::MemoryException)
+		{
+			if (this != &tree)
+			{
+				BTree<KEY, VALUE> copy(tree);
+				Swap(copy);
+			}
+			return *this;
+		}
+
+
+		void Swap(BTree<KEY, VALUE>& tree) throw()
+		{
+			register int swap_size = size;
+			size = tree.size;
+			tree.size = swap_size;
+			register void* swap_root = root;
+			root = tree.root;
+			tree.root = swap_root;
+			register Leaf* swap_leaf = first;
+			first = tree.first;
+			tree.first = swap_leaf;
+			swap_leaf = last;
+			last = tree.last;
+			tree.last = swap_leaf;
+			register int swap_height = height;
+			height = tree.height;
+			tree.height = swap_height;
+		}
+
+
+		void Clear() throw()
+		{
+			if (root)
+			{
+				Free(root, height);
+			}
+			size = 0;
+			root = static_cast<void*>(0);
+			first = static_cast<Leaf*>(0);
+			last = static_cast<Leaf*>(0);
+			height = 0;
+		}
+
+
+		bool Delete(const KEY& k) throw()
+		{
+			if (!root)
+			{
+				return false;
+			}
+			Inner* path[btree_maximum_height];
+			int slot[btree_maximum_height];
+			register Leaf* __restrict leaf = Descend(k, path, slot);
+			register int i = LowerBound(leaf, k);
+			if ((i == leaf->count) || !(leaf->key[i] == k))
+			{
+				return false;
+			}
+			leaf->Erase(i);
+			--size;
+
+			if (height == 0)
+			{
+				if (leaf->count == 0)
+				{
+					delete leaf;
+					root = static_cast<void*>(0);
+					first = static_cast<Leaf*>(0);
+					last = static_cast<Leaf*>(0);
+				}
+				return true;
+			}
+			if (leaf->count >= leaf_minimum)
+			{
+				return true;
+			}
+
+			// Borrow an entry from a sibling, else merge with it
+			register Inner* __restrict parent = path[height - 1];
+			register int c = slot[height - 1];
+			if (c > 0)
+			{
+				register Leaf* __restrict left = static_cast<Leaf*>(parent->child[c - 1]);
+				if (left->count > leaf_minimum)
+				{
+					left->Transfer(left->count - 1, leaf, 0);
+					parent->key[c - 1] = leaf->key[0];
+					return true;
+				}
+			}
+			if (c < parent->count)
+			{
+				register Leaf* __restrict right = static_cast<Leaf*>(parent->child[c + 1]);
+				if (right->count > leaf_minimum)
+				{
+					right->Transfer(0, leaf, leaf->count);
+					parent->key[c] = right->key[0];
+					return true;
+				}
+			}
+			if (c > 0)
+			{
+				MergeLeaves(static_cast<Leaf*>(parent->child[c - 1]), leaf);
+				parent->Erase(c - 1);
+			}
+			else
+			{
+				MergeLeaves(leaf, static_cast<Leaf*>(parent->child[c + 1]));
+				parent->Erase(c);
+			}
+
+			// Same for the inner nodes that lost a key
+			for (register int l = height - 1; (l > 0) && (path[l]->count < inner_minimum); --l)
+			{
+				register Inner* __restrict node = path[l];
+				parent = path[l - 1];
+				c = slot[l - 1];
+				if (c > 0)
+				{
+					register Inner* __restrict left = static_cast<Inner*>(parent->child[c - 1]);
+					if (left->count > inner_minimum)
+					{
+						for (register int j = node->count; j > 0; --j)
+						{
+							node->key[j] = node->key[j - 1];
+						}
+						for (register int j = node->count + 1; j > 0; --j)
+						{
+							node->child[j] = node->child[j - 1];
+						}
+						node->key[0] = parent->key[c - 1];
+						node->child[0] = left->child[left->count];
+						++node->count;
+						parent->key[c - 1] = left->key[left->count - 1];
+						--left->count;
+						break;
+					}
+				}
+				if (c < parent->count)
+				{
+					register Inner* __restrict right = static_cast<Inner*>(parent->child[c + 1]);
+					if (right->count > inner_minimum)
+					{
+						node->key[node->count] = parent->key[c];
+						node->child[node->count + 1] = right->child[0];
+						++node->count;
+						parent->key[c] = right->key[0];
+						right->child[0] = right->child[1];
+						right->Erase(0);
+						break;
+					}
+				}
+				if (c > 0)
+				{
+					MergeInner(static_cast<Inner*>(parent->child[c - 1]), parent->key[c - 1], node);
+					parent->Erase(c - 1);
+				}
+				else
+				{
+					MergeInner(node, parent->key[c], static_cast<Inner*>(parent->child[c + 1]));
+					parent->Erase(c);
+				}
+			}
+
+			register Inner* __restrict top = static_cast<Inner*>(root);
+			if (top->count == 0)
+			{
+				root = top->child[0];
+				--height;
+				delete top;
+			}
+			return true;
+		}
+
+
+		Iterator First() const throw()
+		{
+			Iterator position = {first, 0};
+			return position;
+		}
+
+
+		Iterator Last() const throw()
+		{
+			Iterator position = {last, last ? last->count - 1 : 0};
+			return position;
+		}
+
+
+		// First entry with a key not less than k
+		Iterator LowerBound(const KEY& k) const throw()
+		{
+			Iterator position = {static_cast<Leaf*>(0), 0};
+			if (root)
+			{
+				position.leaf = Descend(k, static_cast<Inner**>(0), static_cast<int*>(0));
+				position.index = LowerBound(position.leaf, k);
+				if (position.index == position.leaf->count)
+				{
+					position.leaf = position.leaf->next;
+					position.index = 0;
+				}
+			}
+			return position;
+		}
+
+
+		// First entry with a key greater than k
+		Iterator UpperBound(const KEY& k) const throw()
+		{
+			Iterator position = {static_cast<Leaf*>(0), 0};
+			if (root)
+			{
+				position.leaf = Descend(k, static_cast<Inner**>(0), static_cast<int*>(0));
+				position.index = UpperBound(position.leaf->key, position.leaf->count, k);
+				if (position.index == position.leaf->count)
+				{
+					position.leaf = position.leaf->next;
+					position.index = 0;
+				}
+			}
+			return position;
+		}
+
+
+		// Entry with key k, not valid when absent
+		Iterator Find(const KEY& k) const throw()
+		{
+			Iterator position = LowerBound(k);
+			if (position.leaf && !(position.leaf->key[position.index] == k))
+			{
+				position.leaf = static_cast<Leaf*>(0);
+			}
+			return position;
+		}
+
+
+		protected:
+
+			enum
+			{
+				leaf_minimum = Leaf::capacity/2,
+
+				inner_minimum = (Inner::capacity + 1)/2 - 1
+			};
+
+			void* root;
+
+			Leaf* first;
+
+			Leaf* last;
+
+			int height;
+
+
+			// Position of k, inserted with value v when absent (inserted tells which case it was). The
+			// nodes a split needs are allocated before the tree is touched, so it is left unchanged when
+			// memory runs out.
+			Iterator Insert(const KEY& k, const VALUE& v, bool& inserted) throw(Grok::MemoryException)
+			{
+				Iterator position = {static_cast<Leaf*>(0), 0};
+				inserted = false;
+				if (!root)
+				{
+					register Leaf* __restrict leaf = NewLeaf();
+					Link(leaf);
+					leaf->Insert(0, k, v);
+					root = leaf;
+					size = 1;
+					inserted = true;
+					position.leaf = leaf;
+					return position;
+				}
+
+				Inner* path[btree_maximum_height];
+				int slot[btree_maximum_height];
+				register Leaf* __restrict leaf = Descend(k, path, slot);
+				register int i = LowerBound(leaf, k);
+				if ((i < leaf->count) && (leaf->key[i] == k))
+				{
+					position.leaf = leaf;
+					position.index = i;
+					return position;
+				}
+				inserted = true;
+				++size;
+				if (leaf->count < Leaf::capacity)
+				{
+					leaf->Insert(i, k, v);
+					position.leaf = leaf;
+					position.index = i;
+					return position;
+				}
+
+				register int full = 0;
+				while ((full < height) && (path[height - 1 - full]->count == Inner::capacity))
+				{
+					++full;
+				}
+				const int splits = (full == height) ? full + 1 : full;
+				Leaf* right;
+				Inner* spare[btree_maximum_height + 1];
+				register int allocated = 0;
+				try
+				{
+					right = NewLeaf();
+					for (; allocated < splits; ++allocated)
+					{
+						spare[allocated] = NewInner();
+					}
+				}
+				catch (Grok::MemoryException&)
+				{
+					--size;
+					for (register int s = 0; s < allocated; ++s)
+					{
+						delete spare[s];
+					}
+					ReThrow();
+				}
+
+				// Split the leaf, the left half keeps the extra entry when the count is odd
+				const int half = (Leaf::capacity + 2)/2;
+				if (i < half)
+				{
+					leaf->MoveTo(half - 1, right);
+					leaf->Insert(i, k, v);
+					position.leaf = leaf;
+					position.index = i;
+				}
+				else
+				{
+					leaf->MoveTo(half, right);
+					right->Insert(i - half, k, v);
+					position.leaf = right;
+					position.index = i - half;
+				}
+				right->previous = leaf;
+				right->next = leaf->next;
+				if (right->next)
+				{
+					right->next->previous = right;
+				}
+				else
+				{
+					last = right;
+				}
+				leaf->next = right;
+
+				// Push the separator up, splitting the full inner nodes
+				KEY separator = right->key[0];
+				void* new_child = right;
+				register int used = 0;
+				for (register int l = height - 1; l >= 0; --l)
+				{
+					register Inner* __restrict node = path[l];
+					register int c = slot[l];
+					if (node->count < Inner::capacity)
+					{
+						node->Insert(c, separator, new_child);
+						return position;
+					}
+
+					KEY key[Inner::capacity + 1];
+					void* child[Inner::capacity + 2];
+					for (register int j = 0; j < c; ++j)
+					{
+						key[j] = node->key[j];
+					}
+					key[c] = separator;
+					for (register int j = c; j < Inner::capacity; ++j)
+					{
+						key[j + 1] = node->key[j];
+					}
+					for (register int j = 0; j <= c; ++j)
+					{
+						child[j] = node->child[j];
+					}
+					child[c + 1] = new_child;
+					for (register int j = c + 1; j <= Inner::capacity; ++j)
+					{
+						child[j + 1] = node->child[j];
+					}
+
+					const int middle = (Inner::capacity + 1)/2;
+					register Inner* __restrict sibling = spare[used++];
+					node->count = middle;
+					for (register int j = 0; j < middle; ++j)
+					{
+						node->key[j] = key[j];
+						node->child[j] = child[j];
+					}
+					node->child[middle] = child[middle];
+					sibling->count = Inner::capacity - middle;
+					for (register int j = 0; j < sibling->count; ++j)
+					{
+						sibling->key[j] = key[middle + 1 + j];
+						sibling->child[j] = child[middle + 1 + j];
+					}
+					sibling->child[sibling->count] = child[Inner::capacity + 1];
+					separator = key[middle];
+					new_child = sibling;
+				}
+
+				register Inner* __restrict top = spare[used];
+				top->count = 1;
+				top->key[0] = separator;
+				top->child[0] = root;
+				top->child[1] = new_child;
+				root = top;
+				++height;
+				return position;
+			}
+
+
+			// Replaces the contents with n entries of strictly increasing keys (values may be null for
+			// sets). Leaves are filled evenly, as full as the count allows.
+			void Build(const KEY* __restrict keys, const VALUE* __restrict values, int n) throw(Grok::MemoryException)
+			{
+				Assert(n >= 0);
+
+				Clear();
+				if (n == 0)
+				{
+					return;
+				}
+				try
+				{
+					const int leaves = (n + Leaf::capacity - 1)/Leaf::capacity;
+					Grok::Vector<void*> level(leaves);
+					Grok::Vector<KEY> lowest(leaves);
+					register int k = 0;
+					for (register int l = 0; l < leaves; ++l)
+					{
+						register Leaf* __restrict leaf = NewLeaf();
+						Link(leaf);
+						const int count = n/leaves + ((l < n % leaves) ? 1 : 0);
+						for (register int j = 0; j < count; ++j, ++k)
+						{
+							Assert((k == 0) || (keys[k - 1] < keys[k]));
+
+							leaf->Insert(j, keys[k], values ? values[k] : VALUE());
+						}
+						level.entry[l] = leaf;
+						lowest.entry[l] = leaf->key[0];
+					}
+					BuildInner(level, lowest);
+					size = n;
+				}
+				catch (Grok::MemoryException&)
+				{
+					ReleaseChain();
+					ReThrow();
+				}
+			}
+
+
+		private:
+
+			static inline Leaf* NewLeaf() throw(Grok::MemoryException)
+			{
+				register Leaf* __restrict leaf = new Leaf;
+				if (!leaf)
+				{
+					Throw(Grok::MemoryException());
+				}
+				leaf->previous = static_cast<Leaf*>(0);
+				leaf->next = static_cast<Leaf*>(0);
+				leaf->count = 0;
+				return leaf;
+			}
+
+
+			static inline Inner* NewInner() throw(Grok::MemoryException)
+			{
+				register Inner* __restrict inner = new Inner;
+				if (!inner)
+				{
+					Throw(Grok::MemoryException());
+				}
+				inner->count = 0;
+				return inner;
+			}
+
+
+			// Appends a leaf to the chain, used while building
+			inline void Link(Leaf* leaf) throw()
+			{
+				leaf->previous = last;
+				leaf->next = static_cast<Leaf*>(0);
+				if (last)
+				{
+					last->next = leaf;
+				}
+				else
+				{
+					first = leaf;
+				}
+				last = leaf;
+				root = leaf;
+			}
+
+
+			// Releases the leaves of a build that failed before its inner levels were complete
+			void ReleaseChain() throw()
+			{
+				while (first)
+				{
+					register Leaf* __restrict next = first->next;
+					delete first;
+					first = next;
+				}
+				size = 0;
+				root = static_cast<void*>(0);
+				last = static_cast<Leaf*>(0);
+				height = 0;
+			}
+
+
+			// Builds the inner levels over the nodes of level, whose smallest keys are in lowest. The
+			// inner nodes are all allocated first, on failure the leaves are left to the caller.
+			void BuildInner(Grok::Vector<void*>& level, Grok::Vector<KEY>& lowest) throw(Grok::MemoryException)
+			{
+				register int nodes = level.size;
+				register int total = 0;
+				for (register int n = nodes; n > 1; n = (n + Inner::capacity)/(Inner::capacity + 1))
+				{
+					total += (n + Inner::capacity)/(Inner::capacity + 1);
+				}
+				Grok::Vector<Inner*> created(total);
+				register int allocated = 0;
+				try
+				{
+					for (; allocated < total; ++allocated)
+					{
+						created.entry[allocated] = NewInner();
+					}
+				}
+				catch (Grok::MemoryException&)
+				{
+					for (register int s = 0; s < allocated; ++s)
+					{
+						delete created.entry[s];
+					}
+					ReThrow();
+				}
+
+				register int used = 0;
+				register int levels = 0;
+				while (nodes > 1)
+				{
+					const int groups = (nodes + Inner::capacity)/(Inner::capacity + 1);
+					register int n = 0;
+					for (register int g = 0; g < groups; ++g)
+					{
+						register Inner* __restrict inner = created.entry[used++];
+						const int children = nodes/groups + ((g < nodes % groups) ? 1 : 0);
+						inner->child[0] = level.entry[n];
+						KEY smallest = lowest.entry[n];
+						for (register int j = 1; j < children; ++j)
+						{
+							inner->key[j - 1] = lowest.entry[n + j];
+							inner->child[j] = level.entry[n + j];
+						}
+						inner->count = children - 1;
+						n += children;
+						level.entry[g] = inner;
+						lowest.entry[g] = smallest;
+					}
+					nodes = groups;
+					++levels;
+				}
+				root = level.entry[0];
+				height = levels;
+			}
+
+
+			static void Free(void* node, int level) throw()
+			{
+				if (level == 0)
+				{
+					delete static_cast<Leaf*>(node);
+					return;
+				}
+				register Inner* __restrict inner = static_cast<Inner*>(node);
+				for (register int c = 0; c <= inner->count; ++c)
+				{
+					Free(inner->child[c], level - 1);
+				}
+				delete inner;
+			}
+
+
+			// Leaf that holds k if present, recording the inner nodes and child slots on the way
+			Leaf* Descend(const KEY& k, Inner** path, int* slot) const throw()
+			{
+				register void* node = root;
+				for (register int l = 0; l < height; ++l)
+				{
+					register Inner* __restrict inner = static_cast<Inner*>(node);
+					register int c = UpperBound(inner->key, inner->count, k);
+					if (path)
+					{
+						path[l] = inner;
+						slot[l] = c;
+					}
+					node = inner->child[c];
+				}
+				return static_cast<Leaf*>(node);
+			}
+
+
+			static inline int LowerBound(const Leaf* leaf, const KEY& k) throw()
+			{
+				register int begin = 0;
+				register int end = leaf->count;
+				while (begin < end)
+				{
+					register int middle = (begin + end)/2;
+					if (leaf->key[middle] < k)
+					{
+						begin = middle + 1;
+					}
+					else
+					{
+						end = middle;
+					}
+				}
+				return begin;
+			}
+
+
+			static inline int UpperBound(const KEY* key, int count, const KEY& k) throw()
+			{
+				register int begin = 0;
+				register int end = count;
+				while (begin < end)
+				{
+					register int middle = (begin + end)/2;
+					if (k < key[middle])
+					{
+						end = middle;
+					}
+					else
+					{
+						begin = middle + 1;
+					}
+				}
+				return begin;
+			}
+
+
+			// Moves the entries of right into left and releases right
+			void MergeLeaves(Leaf* left, Leaf* right) throw()
+			{
+				right->MoveTo(0, left);
+				left->next = right->next;
+				if (right->next)
+				{
+					right->next->previous = left;
+				}
+				else
+				{
+					last = left;
+				}
+				delete right;
+			}
+
+
+			// Moves the separator and the contents of right into left and releases right
+			static void MergeInner(Inner* left, const KEY& separator, Inner* right) throw()
+			{
+				left->key[left->count] = separator;
+				left->child[left->count + 1] = right->child[0];
+				++left->count;
+				for (register int j = 0; j < right->count; ++j)
+				{
+					left->key[left->count] = right->key[j];
+					left->child[left->count + 1] = right->child[j + 1];
+					++left->count;
+				}
+				delete right;
+			}
+	};
+}
+
+
+namespace Grok
+{
+	// Ordered set as a B+tree with nodes of BTREE_NODE_BYTES, so a search touches a few cache lines
+	// per level and scans run along the linked leaves. KEY needs operator < and operator ==.
+	// Entries in [low, high) are visited with
+	//
+	//     for (BTreeSet<int>::Iterator i = set.LowerBound(low); i.Valid() && (i.Key() < high); i.Next())
+	//
+	// Iterators are invalidated by Append and Delete.
+	template <typename KEY>
+	struct BTreeSet : public GrokInternal::BTree<KEY, GrokInternal::BTreeNoValue>
+	{
+		typedef GrokInternal::BTree<KEY, GrokInternal::BTreeNoValue> Tree;
+
+		typedef typename Tree::Iterator Iterator;
+
+
+		inline BTreeSet() throw()
+		:	Tree()
+		{
+		}
+
+
+		// From keys in strictly increasing order, in linear time
+		BTreeSet(const Vector<KEY>& keys) throw(MemoryException)
+		:	Tree()
+		{
+			try
+			{
+				Tree::Build(keys.entry, static_cast<const GrokInternal::BTreeNoValue*>(0), keys.size);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Returns false when the key was already in the set
+		bool Append(const KEY& k) throw(MemoryException)
+		{
+			try
+			{
+				bool inserted;
+				Tree::Insert(k, GrokInternal::BTreeNoValue(), inserted);
+				return inserted;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return false;
+		}
+
+
+		// Replaces the contents with keys in strictly increasing order, in linear time
+		void Build(const Vector<KEY>& keys) throw(MemoryException)
+		{
+			try
+			{
+				Tree::Build(keys.entry, static_cast<const GrokInternal::BTreeNoValue*>(0), keys.size);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// The stored key, null when absent
+		const KEY* Search(const KEY& k) const throw()
+		{
+			Iterator position = Tree::Find(k);
+			return position.Valid() ? &position.Key() : static_cast<const KEY*>(0);
+		}
+	};
+
+
+	// Ordered map as a B+tree, laid out as BTreeSet with the values next to the keys in the leaves.
+	// Iterator::Value gives the value of an entry.
+	template <typename KEY, typename VALUE>
+	struct BTreeMap : public GrokInternal::BTree<KEY, VALUE>
+	{
+		typedef GrokInternal::BTree<KEY, VALUE> Tree;
+
+		typedef typename Tree::Iterator Iterator;
+
+
+		inline BTreeMap() throw()
+		:	Tree()
+		{
+		}
+
+
+		// From keys in strictly increasing order, in linear time
+		BTreeMap(const Vector<KEY>& keys, const Vector<VALUE>& values) throw(MemoryException)
+		:	Tree()
+		{
+			Assert(keys.size == values.size);
+
+			try
+			{
+				Tree::Build(keys.entry, values.entry, keys.size);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Replaces the value when the key is already in the map, then returns false
+		bool Append(const KEY& k, const VALUE& v) throw(MemoryException)
+		{
+			try
+			{
+				bool inserted;
+				Iterator position = Tree::Insert(k, v, inserted);
+				if (!inserted)
+				{
+					position.Value() = v;
+				}
+				return inserted;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return false;
+		}
+
+
+		// The value of a key, appended with VALUE() when absent
+		VALUE& operator [] (const KEY& k) throw(MemoryException)
+		{
+			try
+			{
+				bool inserted;
+				return Tree::Insert(k, VALUE(), inserted).Value();
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return Tree::first->value[0];
+		}
+
+
+		// Replaces the contents with keys in strictly increasing order, in linear time
+		void Build(const Vector<KEY>& keys, const Vector<VALUE>& values) throw(MemoryException)
+		{
+			Assert(keys.size == values.size);
+
+			try
+			{
+				Tree::Build(keys.entry, values.entry, keys.size);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// The value of a key, null when absent
+		VALUE* Search(const KEY& k) const throw()
+		{
+			Iterator position = Tree::Find(k);
+			return position.Valid() ? &position.Value() : static_cast<VALUE*>(0);
+		}
+	};
+}
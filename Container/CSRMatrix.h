@@ -0,0 +1,433 @@
+// CSRMatrix.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Integer.h>
+#include <Basic/Memory.h>
+#include <Basic/Sort.h>
+#include <Container/Vector.h>
+
+
+namespace Grok
+{
+	// Coordinate (COO) list of entries, in any order and with repetitions, to assemble a SparseMatrixCSR.
+	// Entries can be appended one by one, or written directly into row, column and value after a Reserve
+	// (setting size), for instance by threads filling disjoint ranges.
+	template <typename TYPE>
+	struct SparseTriplets
+	{
+		Vector<int> row;
+
+		Vector<int> column;
+
+		Vector<TYPE> value;
+
+		int size;
+
+
+		inline SparseTriplets() throw()
+		:	row(),
+			column(),
+			value(),
+			size(0)
+		{
+		}
+
+
+		SparseTriplets(int capacity) throw(MemoryException)
+		:	row(),
+			column(),
+			value(),
+			size(0)
+		{
+			try
+			{
+				Reserve(capacity);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		inline void Append(int i, int j, const TYPE& a) throw(MemoryException)
+		{
+			if (size == value.size)
+			{
+				Reserve((size < 16) ? 32 : 2*size);
+			}
+			row.entry[size] = i;
+			column.entry[size] = j;
+			value.entry[size] = a;
+			++size;
+		}
+
+
+		inline void Clear() throw()
+		{
+			size = 0;
+		}
+
+
+		// Grows the capacity keeping the entries, never shrinks it
+		void Reserve(int capacity) throw(MemoryException)
+		{
+			if (capacity <= value.size)
+			{
+				return;
+			}
+			try
+			{
+				Vector<int> new_row(capacity);
+				Vector<int> new_column(capacity);
+				Vector<TYPE> new_value(capacity);
+				for (register int k = 0; k < size; ++k)
+				{
+					new_row.entry[k] = row.entry[k];
+					new_column.entry[k] = column.entry[k];
+					new_value.entry[k] = value.entry[k];
+				}
+				row.Swap(new_row);
+				column.Swap(new_column);
+				value.Swap(new_value);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		private:
+
+			SparseTriplets(const SparseTriplets&);
+
+
+			SparseTriplets& operator = (const SparseTriplets&);
+	};
+
+
+	// Compressed sparse row matrix. Row i has the entries [row_begin[i], row_begin[i + 1]) of column and
+	// value, with increasing columns.
+	template <typename TYPE>
+	struct SparseMatrixCSR
+	{
+		int rows;
+
+		int columns;
+
+		Vector<int> row_begin;
+
+		Vector<int> column;
+
+		Vector<TYPE> value;
+
+
+		inline SparseMatrixCSR() throw()
+		:	rows(0),
+			columns(0),
+			row_begin(),
+			column(),
+			value()
+		{
+		}
+
+
+		SparseMatrixCSR(int rows, int columns, int nonzeros) throw(MemoryException)
+		:	rows(0),
+			columns(0),
+			row_begin(),
+			column(),
+			value()
+		{
+			try
+			{
+				Resize(rows, columns, nonzeros);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		SparseMatrixCSR(int rows, int columns, const SparseTriplets<TYPE>& triplets) throw(MemoryException)
+		:	rows(0),
+			columns(0),
+			row_begin(),
+			column(),
+			value()
+		{
+			try
+			{
+				Assemble(rows, columns, triplets);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		SparseMatrixCSR(const SparseMatrixCSR<TYPE>& matrix) throw(MemoryException)
+		:	rows(matrix.rows),
+			columns(matrix.columns),
+			row_begin(matrix.row_begin),
+			column(matrix.column),
+			value(matrix.value)
+		{
+		}
+
+
+		#if defined(RVALUE_REFERENCES)
+
+			inline SparseMatrixCSR(SparseMatrixCSR<TYPE>&& matrix) throw()
+			:	rows(0),
+				columns(0),
+				row_begin(),
+				column(),
+				value()
+			{
+				Swap(matrix);
+			}
+
+		#endif
+
+
+		SparseMatrixCSR& operator = (const SparseMatrixCSR& matrix) throw(MemoryException)
+		{
+			if (this != &matrix)
+			{
+				try
+				{
+					Resize(matrix.rows, matrix.columns, matrix.NonZeros());
+					row_begin = matrix.row_begin;
+					column = matrix.column;
+					value = matrix.value;
+				}
+				catch (MemoryException&)
+				{
+					ReThrow();
+				}
+			}
+			return *this;
+		}
+
+
+		#if defined(RVALUE_REFERENCES)
+
+			inline SparseMatrixCSR& operator = (SparseMatrixCSR&& matrix) throw()
+			{
+				Swap(matrix);
+				return *this;
+			}
+
+		#endif
+
+
+		inline int NonZeros() const throw()
+		{
+			return value.size;
+		}
+
+
+		// Entry (i, j) or null when it is not stored, by binary search in the row
+		TYPE* Find(int i, int j) const throw()
+		{
+			Assert((i >= 0) && (i < rows));
+
+			register int begin = row_begin.entry[i];
+			register int end = row_begin.entry[i + 1];
+			while (begin < end)
+			{
+				register int middle = begin + (end - begin)/2;
+				if (column.entry[middle] < j)
+				{
+					begin = middle + 1;
+				}
+				else
+				{
+					end = middle;
+				}
+			}
+			return ((begin < row_begin.entry[i + 1]) && (column.entry[begin] == j)) ? &value.entry[begin] : static_cast<TYPE*>(0);
+		}
+
+
+		// Rows [begin, end) of the part-th of parts consecutive row ranges holding about equal numbers of
+		// entries, to balance threads over rows of different lengths. The last part ends at rows.
+		void Partition(int parts, int part, int& begin, int& end) const throw()
+		{
+			Assert(parts > 0);
+			Assert((part >= 0) && (part < parts));
+
+			const sint64 nonzeros = NonZeros();
+			begin = FirstRowReaching(static_cast<int>(nonzeros*part/parts));
+			end = (part == parts - 1) ? rows : FirstRowReaching(static_cast<int>(nonzeros*(part + 1)/parts));
+		}
+
+
+		// Storage for nonzeros entries, row_begin, column and value are left to the caller
+		void Resize(int rows, int columns, int nonzeros) throw(MemoryException)
+		{
+			Assert(rows >= 0);
+			Assert(columns >= 0);
+			Assert(nonzeros >= 0);
+
+			try
+			{
+				this->rows = 0;
+				this->columns = 0;
+				row_begin.Resize(rows + 1);
+				column.Resize(nonzeros);
+				value.Resize(nonzeros);
+				this->rows = rows;
+				this->columns = columns;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Builds the matrix from triplets in O(nonzeros) time: the (row, column) pairs are radix sorted as
+		// the 64-bit keys row << 32 | column (passes over bytes equal in all keys are skipped, so only the
+		// bytes needed by the row and column ranges cost a pass), then repeated entries are summed while
+		// the rows are compressed.
+		void Assemble(int rows, int columns, const SparseTriplets<TYPE>& triplets) throw(MemoryException)
+		{
+			Assert(rows >= 0);
+			Assert(columns >= 0);
+
+			const int size = triplets.size;
+			try
+			{
+				// No entries, every row is empty
+				if (size == 0)
+				{
+					Resize(rows, columns, 0);
+					for (register int i = 0; i <= rows; ++i)
+					{
+						row_begin.entry[i] = 0;
+					}
+					return;
+				}
+
+				Vector<uint64> key(size);
+				Vector<int> permutation(size);
+
+				const int* __restrict triplets_row = triplets.row.entry;
+				const int* __restrict triplets_column = triplets.column.entry;
+				#if defined(_OPENMP)
+					#pragma omp parallel for schedule(static) if (size >= PARALLEL_FILL_LIMIT)
+				#endif
+				for (int k = 0; k < size; ++k)
+				{
+					Assert((triplets_row[k] >= 0) && (triplets_row[k] < rows));
+					Assert((triplets_column[k] >= 0) && (triplets_column[k] < columns));
+
+					key.entry[k] = static_cast<uint64>(triplets_row[k]) << 32 | static_cast<uint64>(triplets_column[k]);
+				}
+				RadixSortPermutation(key.entry, size, permutation.entry);
+
+				register int nonzeros = 0;
+				for (register int k = 0; k < size; ++k)
+				{
+					if ((k == 0) || (key.entry[k] != key.entry[k - 1]))
+					{
+						++nonzeros;
+					}
+				}
+				Resize(rows, columns, nonzeros);
+
+				register int* __restrict row_begin_entry = row_begin.entry;
+				register int* __restrict column_entry = column.entry;
+				register TYPE* __restrict value_entry = value.entry;
+				const TYPE* __restrict triplets_value = triplets.value.entry;
+				for (register int i = 0; i <= rows; ++i)
+				{
+					row_begin_entry[i] = 0;
+				}
+				register int n = -1;
+				for (register int k = 0; k < size; ++k)
+				{
+					if ((k == 0) || (key.entry[k] != key.entry[k - 1]))
+					{
+						++n;
+						++row_begin_entry[static_cast<int>(key.entry[k] >> 32) + 1];
+						column_entry[n] = static_cast<int>(key.entry[k] & 0xffffffff);
+						value_entry[n] = triplets_value[permutation.entry[k]];
+					}
+					else
+					{
+						value_entry[n] += triplets_value[permutation.entry[k]];
+					}
+				}
+				for (register int i = 0; i < rows; ++i)
+				{
+					row_begin_entry[i + 1] += row_begin_entry[i];
+				}
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Exchanges the buffers, nothing is allocated nor copied
+		inline void Swap(SparseMatrixCSR<TYPE>& matrix) throw()
+		{
+			register int swap_rows = rows;
+			rows = matrix.rows;
+			matrix.rows = swap_rows;
+			register int swap_columns = columns;
+			columns = matrix.columns;
+			matrix.columns = swap_columns;
+			row_begin.Swap(matrix.row_begin);
+			column.Swap(matrix.column);
+			value.Swap(matrix.value);
+		}
+
+
+		private:
+
+			// First row whose entries begin at or after entry
+			inline int FirstRowReaching(int entry) const throw()
+			{
+				register int begin = 0;
+				register int end = rows;
+				while (begin < end)
+				{
+					register int middle = begin + (end - begin)/2;
+					if (row_begin.entry[middle] < entry)
+					{
+						begin = middle + 1;
+					}
+					else
+					{
+						end = middle;
+					}
+				}
+				return begin;
+			}
+	};
+}
@@ -0,0 +1,417 @@
+// ConcurrentQueue.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Atomic.h>
+#include <Basic/Integer.h>
+#include <Basic/Memory.h>
+#include <Basic/System.h>
+#include <Container/Vector.h>
+
+
+// Rounds a batch Enqueue or Dequeue spins on a cell still held by another thread before it starts
+// yielding the processor
+#if !defined(CONCURRENT_QUEUE_SPIN)
+	#define CONCURRENT_QUEUE_SPIN 128
+#endif
+
+
+namespace GrokInternal
+{
+	// Smallest power of 2 not below capacity, at least 2
+	inline int QueueCapacity(int capacity) throw()
+	{
+		register int power = 2;
+		while (power < capacity)
+		{
+			power *= 2;
+		}
+		return power;
+	}
+
+
+	template <typename TYPE>
+	struct MPMCQueueCell
+	{
+		// Position that may use the cell next: p to enqueue, p + 1 to dequeue
+		volatile Grok::sint64 sequence;
+
+		TYPE value;
+	};
+
+
+	// Wait step of a batch on a cell, spin is the number of rounds it has waited
+	inline void QueueWait(int& spin) throw()
+	{
+		if (++spin < CONCURRENT_QUEUE_SPIN)
+		{
+			Grok::CpuRelax();
+		}
+		else
+		{
+			Grok::YieldThread();
+		}
+	}
+}
+
+
+namespace Grok
+{
+	// Bounded queue for any number of producer and consumer threads (D. Vyukov, Bounded MPMC queue.
+	// 1024cores.net. 2010). A ring of cells, each with a sequence number telling the position that can use
+	// it next, so producers and consumers only contend on their own position counter, each alone in its
+	// cache line. Enqueue and Dequeue of one value are lock-free and never wait, they fail when the queue
+	// is full or empty. The batch versions are blocking: they claim a run of positions with one
+	// compare-exchange and then wait for the threads that hold those cells from the previous lap to finish
+	// copying, spinning CONCURRENT_QUEUE_SPIN rounds and then yielding, so a thread preempted in the middle
+	// of a copy stalls the batches behind it until it runs again.
+	template <typename TYPE>
+	struct MPMCQueue
+	{
+		// Rounded up to a power of 2
+		const int capacity;
+
+
+		MPMCQueue(int capacity) throw(MemoryException)
+		:	capacity(GrokInternal::QueueCapacity(capacity)),
+			cell(),
+			enqueue_position(0),
+			dequeue_position(0)
+		{
+			Assert(capacity > 0);
+
+			try
+			{
+				cell.Resize(this->capacity);
+				for (register int c = 0; c < this->capacity; ++c)
+				{
+					cell.entry[c].sequence = c;
+				}
+				AtomicFence();
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// False when full
+		bool Enqueue(const TYPE& value) throw()
+		{
+			register sint64 position = AtomicLoad(&enqueue_position);
+			for (;;)
+			{
+				register GrokInternal::MPMCQueueCell<TYPE>* __restrict c = cell.entry + (position & (capacity - 1));
+				register sint64 difference = AtomicLoad(&c->sequence) - position;
+				if (difference == 0)
+				{
+					if (AtomicCompareExchange(&enqueue_position, position, position + 1))
+					{
+						c->value = value;
+						AtomicStore(&c->sequence, position + 1);
+						return true;
+					}
+					position = AtomicLoad(&enqueue_position);
+				}
+				else if (difference < 0)
+				{
+					return false;
+				}
+				else
+				{
+					position = AtomicLoad(&enqueue_position);
+				}
+			}
+		}
+
+
+		// False when empty
+		bool Dequeue(TYPE& value) throw()
+		{
+			register sint64 position = AtomicLoad(&dequeue_position);
+			for (;;)
+			{
+				register GrokInternal::MPMCQueueCell<TYPE>* __restrict c = cell.entry + (position & (capacity - 1));
+				register sint64 difference = AtomicLoad(&c->sequence) - (position + 1);
+				if (difference == 0)
+				{
+					if (AtomicCompareExchange(&dequeue_position, position, position + 1))
+					{
+						value = c->value;
+						AtomicStore(&c->sequence, position + capacity);
+						return true;
+					}
+					position = AtomicLoad(&dequeue_position);
+				}
+				else if (difference < 0)
+				{
+					return false;
+				}
+				else
+				{
+					position = AtomicLoad(&dequeue_position);
+				}
+			}
+		}
+
+
+		// Enqueues up to count values in order, as many as there is room for, returns how many. Blocks
+		// while a cell claimed is still being read by a consumer of the previous lap.
+		int Enqueue(const TYPE* values, int count) throw()
+		{
+			Assert(count >= 0);
+
+			register sint64 position;
+			register int claimed;
+			do
+			{
+				position = AtomicLoad(&enqueue_position);
+				register sint64 room = capacity - (position - AtomicLoad(&dequeue_position));
+				claimed = (room < count) ? static_cast<int>(room) : count;
+				if (claimed <= 0)
+				{
+					return 0;
+				}
+			}
+			while (!AtomicCompareExchange(&enqueue_position, position, position + claimed));
+
+			for (register int i = 0; i < claimed; ++i)
+			{
+				register GrokInternal::MPMCQueueCell<TYPE>* __restrict c = cell.entry + ((position + i) & (capacity - 1));
+				int spin = 0;
+				while (AtomicLoad(&c->sequence) != position + i)
+				{
+					GrokInternal::QueueWait(spin);
+				}
+				c->value = values[i];
+				AtomicStore(&c->sequence, position + i + 1);
+			}
+			return claimed;
+		}
+
+
+		// Dequeues up to count values in order, as many as there are, returns how many. Blocks while a
+		// cell claimed is still being written by its producer.
+		int Dequeue(TYPE* values, int count) throw()
+		{
+			Assert(count >= 0);
+
+			register sint64 position;
+			register int claimed;
+			do
+			{
+				position = AtomicLoad(&dequeue_position);
+				register sint64 available = AtomicLoad(&enqueue_position) - position;
+				claimed = (available < count) ? static_cast<int>(available) : count;
+				if (claimed <= 0)
+				{
+					return 0;
+				}
+			}
+			while (!AtomicCompareExchange(&dequeue_position, position, position + claimed));
+
+			for (register int i = 0; i < claimed; ++i)
+			{
+				register GrokInternal::MPMCQueueCell<TYPE>* __restrict c = cell.entry + ((position + i) & (capacity - 1));
+				int spin = 0;
+				while (AtomicLoad(&c->sequence) != position + i + 1)
+				{
+					GrokInternal::QueueWait(spin);
+				}
+				values[i] = c->value;
+				AtomicStore(&c->sequence, position + i + capacity);
+			}
+			return claimed;
+		}
+
+
+		// Approximate while other threads are working on the queue
+		int Size() const throw()
+		{
+			register sint64 size = AtomicLoad(&enqueue_position) - AtomicLoad(&dequeue_position);
+			return (size < 0) ? 0 : ((size > capacity) ? capacity : static_cast<int>(size));
+		}
+
+
+		private:
+
+			Vector<GrokInternal::MPMCQueueCell<TYPE> > cell;
+
+			char padding_0[CACHE_LINE_SIZE];
+
+			volatile sint64 enqueue_position;
+
+			char padding_1[CACHE_LINE_SIZE];
+
+			volatile sint64 dequeue_position;
+
+			char padding_2[CACHE_LINE_SIZE];
+
+
+			MPMCQueue(const MPMCQueue&);
+
+
+			MPMCQueue& operator = (const MPMCQueue&);
+	};
+
+
+	// Bounded queue for one producer thread and one consumer thread, without locks or read-modify-write
+	// operations. Each side owns its position and keeps a copy of the other's, which it reloads only when
+	// the queue looks full (or empty), so most calls touch no cache line written by the other thread.
+	template <typename TYPE>
+	struct SPSCQueue
+	{
+		// Rounded up to a power of 2
+		const int capacity;
+
+
+		SPSCQueue(int capacity) throw(MemoryException)
+		:	capacity(GrokInternal::QueueCapacity(capacity)),
+			buffer(),
+			head(0),
+			known_tail(0),
+			tail(0),
+			known_head(0)
+		{
+			Assert(capacity > 0);
+
+			try
+			{
+				buffer.Resize(this->capacity);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Producer only, false when full
+		bool Enqueue(const TYPE& value) throw()
+		{
+			register sint64 position = tail;
+			if (position - known_head == capacity)
+			{
+				known_head = AtomicLoad(&head);
+				if (position - known_head == capacity)
+				{
+					return false;
+				}
+			}
+			buffer.entry[position & (capacity - 1)] = value;
+			AtomicStore(&tail, position + 1);
+			return true;
+		}
+
+
+		// Consumer only, false when empty
+		bool Dequeue(TYPE& value) throw()
+		{
+			register sint64 position = head;
+			if (position == known_tail)
+			{
+				known_tail = AtomicLoad(&tail);
+				if (position == known_tail)
+				{
+					return false;
+				}
+			}
+			value = buffer.entry[position & (capacity - 1)];
+			AtomicStore(&head, position + 1);
+			return true;
+		}
+
+
+		// Producer only, enqueues up to count values, as many as there is room for, returns how many
+		int Enqueue(const TYPE* values, int count) throw()
+		{
+			Assert(count >= 0);
+
+			register sint64 position = tail;
+			if (capacity - (position - known_head) < count)
+			{
+				known_head = AtomicLoad(&head);
+			}
+			register sint64 room = capacity - (position - known_head);
+			register int n = (room < count) ? static_cast<int>(room) : count;
+			for (register int i = 0; i < n; ++i)
+			{
+				buffer.entry[(position + i) & (capacity - 1)] = values[i];
+			}
+			AtomicStore(&tail, position + n);
+			return n;
+		}
+
+
+		// Consumer only, dequeues up to count values, as many as there are, returns how many
+		int Dequeue(TYPE* values, int count) throw()
+		{
+			Assert(count >= 0);
+
+			register sint64 position = head;
+			if (known_tail - position < count)
+			{
+				known_tail = AtomicLoad(&tail);
+			}
+			register sint64 available = known_tail - position;
+			register int n = (available < count) ? static_cast<int>(available) : count;
+			for (register int i = 0; i < n; ++i)
+			{
+				values[i] = buffer.entry[(position + i) & (capacity - 1)];
+			}
+			AtomicStore(&head, position + n);
+			return n;
+		}
+
+
+		// Approximate while the other thread is working on the queue
+		int Size() const throw()
+		{
+			return static_cast<int>(AtomicLoad(&tail) - AtomicLoad(&head));
+		}
+
+
+		private:
+
+			Vector<TYPE> buffer;
+
+			char padding_0[CACHE_LINE_SIZE];
+
+			// Consumer side
+			volatile sint64 head;
+
+			sint64 known_tail;
+
+			char padding_1[CACHE_LINE_SIZE];
+
+			// Producer side
+			volatile sint64 tail;
+
+			sint64 known_head;
+
+			char padding_2[CACHE_LINE_SIZE];
+
+
+			SPSCQueue(const SPSCQueue&);
+
+
+			SPSCQueue& operator = (const SPSCQueue&);
+	};
+}
@@ -0,0 +1,286 @@
+// ConcurrentStack.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Atomic.h>
+#include <Basic/Integer.h>
+#include <Basic/Memory.h>
+#include <Basic/System.h>
+#include <Container/Vector.h>
+
+
+// Slots where a push and a pop that collide on the top of the stack can meet
+#if !defined(CONCURRENT_STACK_ELIMINATION_SLOTS)
+	#define CONCURRENT_STACK_ELIMINATION_SLOTS 8
+#endif
+
+// Rounds a push waits in an elimination slot for a pop
+#if !defined(CONCURRENT_STACK_ELIMINATION_SPIN)
+	#define CONCURRENT_STACK_ELIMINATION_SPIN 128
+#endif
+
+
+namespace GrokInternal
+{
+	template <typename TYPE>
+	struct ConcurrentStackNode
+	{
+		// Index of the node below plus 1, 0 at the bottom
+		volatile Grok::sint32 next;
+
+		TYPE value;
+	};
+
+
+	// A tagged word holds a node index plus 1 in its low 32 bits (0 for none) and a tag in its high 32
+	// bits that every change increments, so a compare-exchange fails if the word changed and came back
+	inline int TaggedIndex(Grok::sint64 word) throw()
+	{
+		return static_cast<int>(static_cast<Grok::uint32>(static_cast<Grok::uint64>(word) & 0xFFFFFFFFU)) - 1;
+	}
+
+
+	inline Grok::sint64 TaggedWord(Grok::sint64 previous, int index) throw()
+	{
+		return static_cast<Grok::sint64>((((static_cast<Grok::uint64>(previous) >> 32) + 1) << 32) | static_cast<Grok::uint32>(index + 1));
+	}
+}
+
+
+namespace Grok
+{
+	// Lock-free stack for any number of threads (R. K. Treiber, Systems Programming: Coping with
+	// Parallelism. IBM Research Report RJ 5118. 1986). The nodes are preallocated and recycled through a
+	// free list, itself a Treiber stack, so there is no allocation after construction and Push fails
+	// when all capacity nodes hold values. Both tops are tagged words, which protects them from ABA.
+	//
+	// In elimination mode (D. Hendler, N. Shavit, L. Yerushalmi, A Scalable Lock-free Stack Algorithm.
+	// SPAA 2004) a push whose compare-exchange on the top fails offers its node in a slot of a small array,
+	// and a pop whose compare-exchange fails takes an offered node, so bursts of pushes and pops cancel
+	// out without touching the top.
+	template <typename TYPE>
+	struct ConcurrentStack
+	{
+		const int capacity;
+
+		const bool elimination;
+
+
+		ConcurrentStack(int capacity, bool elimination = false) throw(MemoryException)
+		:	capacity(capacity),
+			elimination(elimination),
+			node(),
+			head(0),
+			free_head(0)
+		{
+			Assert(capacity > 0);
+
+			try
+			{
+				node.Resize(capacity);
+				for (register int i = 0; i < capacity; ++i)
+				{
+					node.entry[i].next = (i + 1 < capacity) ? i + 2 : 0;
+				}
+				free_head = GrokInternal::TaggedWord(0, 0);
+				for (register int s = 0; s < CONCURRENT_STACK_ELIMINATION_SLOTS; ++s)
+				{
+					slot[s] = 0;
+				}
+				AtomicFence();
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// False when the capacity is exhausted
+		bool Push(const TYPE& value) throw()
+		{
+			register int i = Unlink(&free_head);
+			if (i < 0)
+			{
+				return false;
+			}
+			node.entry[i].value = value;
+			if (!elimination)
+			{
+				Link(&head, i);
+				return true;
+			}
+			while (!TryLink(&head, i) && !Offer(i))
+			{
+			}
+			return true;
+		}
+
+
+		// False when empty
+		bool Pop(TYPE& value) throw()
+		{
+			register int i;
+			if (!elimination)
+			{
+				i = Unlink(&head);
+				if (i < 0)
+				{
+					return false;
+				}
+			}
+			else
+			{
+				for (;;)
+				{
+					register sint64 word = AtomicLoad(&head);
+					i = GrokInternal::TaggedIndex(word);
+					if (i < 0)
+					{
+						return false;
+					}
+					if (AtomicCompareExchange(&head, word, GrokInternal::TaggedWord(word, AtomicLoad(&node.entry[i].next) - 1)))
+					{
+						break;
+					}
+					i = Take();
+					if (i >= 0)
+					{
+						break;
+					}
+				}
+			}
+			value = node.entry[i].value;
+			Link(&free_head, i);
+			return true;
+		}
+
+
+		// Only a hint while other threads are working on the stack
+		bool Empty() const throw()
+		{
+			return GrokInternal::TaggedIndex(AtomicLoad(&head)) < 0;
+		}
+
+
+		private:
+
+			Vector<GrokInternal::ConcurrentStackNode<TYPE> > node;
+
+			char padding_0[CACHE_LINE_SIZE];
+
+			volatile sint64 head;
+
+			char padding_1[CACHE_LINE_SIZE];
+
+			volatile sint64 free_head;
+
+			char padding_2[CACHE_LINE_SIZE];
+
+			// Tagged words, with the index of an offered node or none
+			volatile sint64 slot[CONCURRENT_STACK_ELIMINATION_SLOTS];
+
+			char padding_3[CACHE_LINE_SIZE];
+
+
+			inline bool TryLink(volatile sint64* top, int i) throw()
+			{
+				register sint64 word = AtomicLoad(top);
+				AtomicStore(&node.entry[i].next, static_cast<sint32>(GrokInternal::TaggedIndex(word) + 1));
+				return AtomicCompareExchange(top, word, GrokInternal::TaggedWord(word, i));
+			}
+
+
+			inline void Link(volatile sint64* top, int i) throw()
+			{
+				while (!TryLink(top, i))
+				{
+				}
+			}
+
+
+			// Index of the node taken from the top, -1 when empty. Reading next from a node that another
+			// thread took meanwhile is harmless: the nodes are never freed and the tag makes the
+			// compare-exchange fail.
+			inline int Unlink(volatile sint64* top) throw()
+			{
+				for (;;)
+				{
+					register sint64 word = AtomicLoad(top);
+					register int i = GrokInternal::TaggedIndex(word);
+					if (i < 0)
+					{
+						return -1;
+					}
+					if (AtomicCompareExchange(top, word, GrokInternal::TaggedWord(word, AtomicLoad(&node.entry[i].next) - 1)))
+					{
+						return i;
+					}
+				}
+			}
+
+
+			// Waits in a slot for a pop to take node i, false if none came (the node is still ours)
+			bool Offer(int i) throw()
+			{
+				register volatile sint64* s = slot + i % CONCURRENT_STACK_ELIMINATION_SLOTS;
+				register sint64 word = AtomicLoad(s);
+				if (GrokInternal::TaggedIndex(word) >= 0)
+				{
+					return false;
+				}
+				register sint64 offer = GrokInternal::TaggedWord(word, i);
+				if (!AtomicCompareExchange(s, word, offer))
+				{
+					return false;
+				}
+				for (register int r = 0; r < CONCURRENT_STACK_ELIMINATION_SPIN; ++r)
+				{
+					if (AtomicLoad(s) != offer)
+					{
+						return true;
+					}
+					CpuRelax();
+				}
+				return !AtomicCompareExchange(s, offer, GrokInternal::TaggedWord(offer, -1));
+			}
+
+
+			// Index of a node taken from a slot, -1 when none is offered
+			int Take() throw()
+			{
+				for (register int k = 0; k < CONCURRENT_STACK_ELIMINATION_SLOTS; ++k)
+				{
+					register sint64 word = AtomicLoad(slot + k);
+					register int i = GrokInternal::TaggedIndex(word);
+					if ((i >= 0) && AtomicCompareExchange(slot + k, word, GrokInternal::TaggedWord(word, -1)))
+					{
+						return i;
+					}
+				}
+				return -1;
+			}
+
+
+			ConcurrentStack(const ConcurrentStack&);
+
+
+			ConcurrentStack& operator = (const ConcurrentStack&);
+	};
+}
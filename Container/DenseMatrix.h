@@ -0,0 +1,278 @@
+// DenseMatrix.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Memory.h>
+#include <Container/MatrixView.h>
+
+
+namespace Grok
+{
+	// Matrix in one allocation, without row pointers. Rows (row major) or columns (column major) are
+	// padded to the alignment, so they start aligned at multiples of the leading dimension.
+	template <typename TYPE>
+	struct DenseMatrix
+	{
+		TYPE* __restrict entry;
+
+		int rows;
+
+		int columns;
+
+		int leading;
+
+		MatrixLayout::ID layout;
+
+
+		inline DenseMatrix() throw()
+		:	entry(static_cast<TYPE*>(0)),
+			rows(0),
+			columns(0),
+			leading(0),
+			layout(MatrixLayout::row_major)
+		{
+		}
+
+
+		DenseMatrix(int rows, int columns, MatrixLayout::ID layout = MatrixLayout::row_major, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
+		{
+			try
+			{
+				entry = static_cast<TYPE*>(0);
+				Resize(rows, columns, layout, alignment);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		DenseMatrix(int rows, int columns, MatrixLayout::ID layout, const MemoryPolicy& policy) throw(MemoryException)
+		{
+			try
+			{
+				entry = static_cast<TYPE*>(0);
+				Resize(rows, columns, layout, policy);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		DenseMatrix(const DenseMatrix<TYPE>& matrix, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
+		{
+			try
+			{
+				entry = static_cast<TYPE*>(0);
+				Resize(matrix.rows, matrix.columns, matrix.layout, alignment);
+				View().Copy(matrix.View());
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		#if defined(RVALUE_REFERENCES)
+
+			inline DenseMatrix(DenseMatrix<TYPE>&& matrix) throw()
+			:	entry(matrix.entry),
+				rows(matrix.rows),
+				columns(matrix.columns),
+				leading(matrix.leading),
+				layout(matrix.layout)
+			{
+				matrix.entry = static_cast<TYPE*>(0);
+				matrix.rows = 0;
+				matrix.columns = 0;
+				matrix.leading = 0;
+			}
+
+		#endif
+
+
+		~DenseMatrix() throw()
+		{
+			delete [] entry;
+		}
+
+
+		DenseMatrix& operator = (const DenseMatrix& matrix) throw()
+		{
+			Assert(rows == matrix.rows);
+			Assert(columns == matrix.columns);
+
+			if (this != &matrix)
+			{
+				View().Copy(matrix.View());
+			}
+			return *this;
+		}
+
+
+		#if defined(RVALUE_REFERENCES)
+
+			// Unlike the copy, a move may change the dimensions and the layout
+			inline DenseMatrix& operator = (DenseMatrix&& matrix) throw()
+			{
+				Swap(matrix);
+				return *this;
+			}
+
+		#endif
+
+
+		inline TYPE& operator () (int i, int j) const throw()
+		{
+			Assert((i >= 0) && (i < rows));
+			Assert((j >= 0) && (j < columns));
+
+			return (layout == MatrixLayout::row_major) ? entry[static_cast<size_t>(i)*static_cast<size_t>(leading) + j] : entry[i + static_cast<size_t>(j)*static_cast<size_t>(leading)];
+		}
+
+
+		inline MatrixView<TYPE> View() const throw()
+		{
+			return MatrixView<TYPE>(entry, rows, columns, leading, layout);
+		}
+
+
+		inline MatrixView<TYPE> View(int row, int column, int rows, int columns) const throw()
+		{
+			return View().View(row, column, rows, columns);
+		}
+
+
+		inline VectorView<TYPE> Row(int i) const throw()
+		{
+			return View().Row(i);
+		}
+
+
+		inline VectorView<TYPE> Column(int j) const throw()
+		{
+			return View().Column(j);
+		}
+
+
+		// Rows or columns are filled in parallel with a static schedule to place each page by first touch
+		void Fill(const TYPE& value) throw()
+		{
+			const int major = (layout == MatrixLayout::row_major) ? rows : columns;
+			const int minor = (layout == MatrixLayout::row_major) ? columns : rows;
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (static_cast<size_t>(major)*static_cast<size_t>(leading) >= PARALLEL_FILL_LIMIT)
+			#endif
+			for (int k = 0; k < major; ++k)
+			{
+				register TYPE* __restrict entry_k = entry + static_cast<size_t>(k)*static_cast<size_t>(leading);
+				for (register int l = 0; l < minor; ++l)
+				{
+					entry_k[l] = value;
+				}
+			}
+		}
+
+
+		// Exchanges the buffers, nothing is allocated nor copied
+		inline void Swap(DenseMatrix<TYPE>& matrix) throw()
+		{
+			register TYPE* swap_entry = entry;
+			entry = matrix.entry;
+			matrix.entry = swap_entry;
+			register int swap_rows = rows;
+			rows = matrix.rows;
+			matrix.rows = swap_rows;
+			register int swap_columns = columns;
+			columns = matrix.columns;
+			matrix.columns = swap_columns;
+			register int swap_leading = leading;
+			leading = matrix.leading;
+			matrix.leading = swap_leading;
+			register MatrixLayout::ID swap_layout = layout;
+			layout = matrix.layout;
+			matrix.layout = swap_layout;
+		}
+
+
+		inline void Resize(int rows, int columns, MatrixLayout::ID layout = MatrixLayout::row_major, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
+		{
+			Reallocate(rows, columns, layout, alignment);
+		}
+
+
+		inline void Resize(int rows, int columns, MatrixLayout::ID layout, const MemoryPolicy& policy) throw(MemoryException)
+		{
+			Reallocate(rows, columns, layout, policy);
+		}
+
+
+		template <typename ALLOCATION>
+		void Reallocate(int rows, int columns, MatrixLayout::ID layout, const ALLOCATION& allocation) throw(MemoryException)
+		{
+			#if defined(CC_Intel)
+				#pragma warning(push)
+				#pragma warning(disable: 873) // entity-kind "entity" has no corresponding operator deletexxxx (to be called if an exception is thrown during initialization of an allocated object)
+			#endif
+
+			const unsigned short alignment = GrokInternal::AllocationAlignment(allocation);
+
+			Assert(rows >= 0);
+			Assert(columns >= 0);
+
+			delete [] entry;
+			this->layout = layout;
+			if ((rows > 0) && (columns > 0))
+			{
+				register int major = (layout == MatrixLayout::row_major) ? rows : columns;
+				register int minor = (layout == MatrixLayout::row_major) ? columns : rows;
+
+				// Padding only when a whole number of entries fills it, as for the usual arithmetic types
+				register unsigned int padded_size = SIZE_WITH_PAD(TYPE, minor, alignment);
+				register int leading = (padded_size % sizeof(TYPE)) ? minor : static_cast<int>(padded_size/sizeof(TYPE));
+				entry = new(allocation) TYPE[static_cast<size_t>(major)*static_cast<size_t>(leading)];
+				if (!entry)
+				{
+					this->rows = 0;
+					this->columns = 0;
+					this->leading = 0;
+					Throw(MemoryException());
+				}
+				this->rows = rows;
+				this->columns = columns;
+				this->leading = leading;
+			}
+			else
+			{
+				entry = static_cast<TYPE*>(0);
+				this->rows = 0;
+				this->columns = 0;
+				this->leading = 0;
+			}
+
+			#if defined(CC_Intel)
+				#pragma warning(pop)
+			#endif
+		}
+	};
+}
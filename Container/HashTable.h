@@ -0,0 +1,825 @@
+// HashTable.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Integer.h>
+#include <Basic/Memory.h>
+#include <Basic/Sort.h>
+#include <Container/Vector.h>
+
+
+// Smallest number of slots allocated by a hash table
+#if !defined(HASH_TABLE_MINIMUM_CAPACITY)
+	#define HASH_TABLE_MINIMUM_CAPACITY 16
+#endif
+
+
+namespace Grok
+{
+	// Hash functors return 64 bits, tables scramble them with a multiplication so they need not be
+	// uniform. The generic one hashes the bytes of the key (FNV-1a), which only suits keys without padding.
+	template <typename KEY>
+	struct Hash
+	{
+		inline uint64 operator () (const KEY& key) const throw()
+		{
+			register const uint8* __restrict byte = reinterpret_cast<const uint8*>(&key);
+			register uint64 hash = static_cast<uint64>(0xCBF29CE484222325ULL);
+			for (register size_t i = 0; i < sizeof(KEY); ++i)
+			{
+				hash = (hash ^ byte[i])*static_cast<uint64>(0x100000001B3ULL);
+			}
+			return hash;
+		}
+	};
+
+
+	template <typename KEY>
+	struct Hash<KEY*>
+	{
+		inline uint64 operator () (KEY* key) const throw()
+		{
+			return static_cast<uint64>(reinterpret_cast<size_t>(key));
+		}
+	};
+
+
+	#define GROK_INTEGER_HASH(TYPE) \
+		template <> \
+		struct Hash<TYPE> \
+		{ \
+			inline uint64 operator () (TYPE key) const throw() \
+			{ \
+				return static_cast<uint64>(key); \
+			} \
+		};
+
+	GROK_INTEGER_HASH(char)
+	GROK_INTEGER_HASH(signed char)
+	GROK_INTEGER_HASH(unsigned char)
+	GROK_INTEGER_HASH(signed short)
+	GROK_INTEGER_HASH(unsigned short)
+	GROK_INTEGER_HASH(signed int)
+	GROK_INTEGER_HASH(unsigned int)
+	GROK_INTEGER_HASH(signed long)
+	GROK_INTEGER_HASH(unsigned long)
+	GROK_INTEGER_HASH(signed long long)
+	GROK_INTEGER_HASH(unsigned long long)
+
+	#undef GROK_INTEGER_HASH
+
+
+	// -0.0 and 0.0 compare equal, so both hash as 0.0
+	template <>
+	struct Hash<float>
+	{
+		inline uint64 operator () (float key) const throw()
+		{
+			union
+			{
+				float value;
+				uint32 bits;
+			} data;
+			data.value = (key == 0.0f) ? 0.0f : key;
+			return static_cast<uint64>(data.bits);
+		}
+	};
+
+
+	template <>
+	struct Hash<double>
+	{
+		inline uint64 operator () (double key) const throw()
+		{
+			union
+			{
+				double value;
+				uint64 bits;
+			} data;
+			data.value = (key == 0.0) ? 0.0 : key;
+			return data.bits;
+		}
+	};
+}
+
+
+namespace GrokInternal
+{
+	// Slot of a hash, from its top bits after a Fibonacci multiplication
+	inline int HashSlot(Grok::uint64 hash, int shift) throw()
+	{
+		return static_cast<int>((hash*static_cast<Grok::uint64>(0x9E3779B97F4A7C15ULL)) >> shift);
+	}
+
+
+	// Number of slots for count keys at the maximum load of 7/8, a power of 2
+	inline int HashCapacity(int count) throw()
+	{
+		register int capacity = HASH_TABLE_MINIMUM_CAPACITY;
+		while (capacity - capacity/8 < count)
+		{
+			capacity *= 2;
+		}
+		return capacity;
+	}
+
+
+	inline int HashShift(int capacity) throw()
+	{
+		register int shift = 64;
+		for (register int c = capacity; c > 1; c /= 2)
+		{
+			--shift;
+		}
+		return shift;
+	}
+}
+
+
+namespace Grok
+{
+	// Open-addressing hash set with Robin Hood linear probing (P. Celis, Robin Hood Hashing. PhD thesis,
+	// University of Waterloo. 1986). The keys live in one array; probe[slot] is 0 for an empty slot, else
+	// one more than the distance of its key to its home slot. An insertion takes the slot of any key that
+	// is closer to home than the key being placed, which keeps probe sequences short and lets lookups stop
+	// at the first key closer to home than the one searched. Deletion shifts the following keys back, so
+	// there are no tombstones. Tables grow by doubling at a load of 7/8.
+	//
+	// To visit the keys, scan the slots with a non-zero probe, or use Ordered to get them sorted.
+	template <typename KEY, typename HASH = Hash<KEY> >
+	struct HashSet
+	{
+		int size;
+
+		int capacity;
+
+		Vector<KEY> key;
+
+		Vector<int> probe;
+
+		HASH hash;
+
+
+		HashSet(int count = 0, const HASH& hash = HASH()) throw(MemoryException)
+		:	size(0),
+			capacity(0),
+			key(),
+			probe(),
+			hash(hash),
+			shift(64)
+		{
+			try
+			{
+				if (count > 0)
+				{
+					Reserve(count);
+				}
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		HashSet(const HashSet<KEY, HASH>& set) throw(MemoryException)
+		:	size(set.size),
+			capacity(set.capacity),
+			key(set.key),
+			probe(set.probe),
+			hash(set.hash),
+			shift(set.shift)
+		{
+		}
+
+
+		HashSet<KEY, HASH>& operator = (const HashSet<KEY, HASH>& set) throw(MemoryException)
+		{
+			if (this != &set)
+			{
+				HashSet<KEY, HASH> copy(set);
+				Swap(copy);
+			}
+			return *this;
+		}
+
+
+		void Swap(HashSet<KEY, HASH>& set) throw()
+		{
+			register int swap_size = size;
+			size = set.size;
+			set.size = swap_size;
+			register int swap_capacity = capacity;
+			capacity = set.capacity;
+			set.capacity = swap_capacity;
+			key.Swap(set.key);
+			probe.Swap(set.probe);
+			HASH swap_hash = hash;
+			hash = set.hash;
+			set.hash = swap_hash;
+			register int swap_shift = shift;
+			shift = set.shift;
+			set.shift = swap_shift;
+		}
+
+
+		// Grows the table so it holds count keys without rehashing
+		void Reserve(int count) throw(MemoryException)
+		{
+			Assert(count >= 0);
+
+			try
+			{
+				register int new_capacity = GrokInternal::HashCapacity(count);
+				if (new_capacity > capacity)
+				{
+					Rehash(new_capacity);
+				}
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Returns false when the key was already in the set
+		bool Append(const KEY& value) throw(MemoryException)
+		{
+			try
+			{
+				if (Search(value))
+				{
+					return false;
+				}
+				if (capacity - capacity/8 <= size)
+				{
+					Rehash(GrokInternal::HashCapacity(size + 1));
+				}
+				Place(value);
+				++size;
+				return true;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return false;
+		}
+
+
+		// Appends count keys after reserving room for all of them, returns how many were new
+		int Append(const KEY* values, int count) throw(MemoryException)
+		{
+			Assert(count >= 0);
+
+			try
+			{
+				Reserve(size + count);
+				register int appended = 0;
+				for (register int i = 0; i < count; ++i)
+				{
+					if (!Search(values[i]))
+					{
+						Place(values[i]);
+						++size;
+						++appended;
+					}
+				}
+				return appended;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return 0;
+		}
+
+
+		inline int Append(const Vector<KEY>& values) throw(MemoryException)
+		{
+			return Append(values.entry, values.size);
+		}
+
+
+		// Keeps the allocated slots
+		void Clear() throw()
+		{
+			for (register int s = 0; s < capacity; ++s)
+			{
+				probe.entry[s] = 0;
+			}
+			size = 0;
+		}
+
+
+		bool Delete(const KEY& value) throw()
+		{
+			register int slot = Find(value);
+			if (slot < 0)
+			{
+				return false;
+			}
+			register int next = (slot + 1) & (capacity - 1);
+			while (probe.entry[next] > 1)
+			{
+				key.entry[slot] = key.entry[next];
+				probe.entry[slot] = probe.entry[next] - 1;
+				slot = next;
+				next = (next + 1) & (capacity - 1);
+			}
+			probe.entry[slot] = 0;
+			--size;
+			return true;
+		}
+
+
+		// The stored key, null when absent
+		const KEY* Search(const KEY& value) const throw()
+		{
+			register int slot = Find(value);
+			return (slot < 0) ? static_cast<const KEY*>(0) : key.entry + slot;
+		}
+
+
+		// The keys in increasing order
+		void Ordered(Vector<KEY>& ordered) const throw(MemoryException)
+		{
+			try
+			{
+				ordered.Resize(size);
+				if (size == 0)
+				{
+					return;
+				}
+				register int k = 0;
+				for (register int s = 0; s < capacity; ++s)
+				{
+					if (probe.entry[s])
+					{
+						ordered.entry[k++] = key.entry[s];
+					}
+				}
+				Sort(ordered);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		private:
+
+			int shift;
+
+
+			int Find(const KEY& value) const throw()
+			{
+				if (capacity == 0)
+				{
+					return -1;
+				}
+				register int slot = GrokInternal::HashSlot(hash(value), shift);
+				for (register int distance = 1; probe.entry[slot] >= distance; ++distance)
+				{
+					if ((probe.entry[slot] == distance) && (key.entry[slot] == value))
+					{
+						return slot;
+					}
+					slot = (slot + 1) & (capacity - 1);
+				}
+				return -1;
+			}
+
+
+			// Places a key known to be absent, there must be a free slot
+			void Place(const KEY& value) throw()
+			{
+				KEY carried = value;
+				register int slot = GrokInternal::HashSlot(hash(carried), shift);
+				register int distance = 1;
+				for (;;)
+				{
+					if (probe.entry[slot] == 0)
+					{
+						key.entry[slot] = carried;
+						probe.entry[slot] = distance;
+						return;
+					}
+					if (probe.entry[slot] < distance)
+					{
+						KEY swap_key = key.entry[slot];
+						key.entry[slot] = carried;
+						carried = swap_key;
+						register int swap_distance = probe.entry[slot];
+						probe.entry[slot] = distance;
+						distance = swap_distance;
+					}
+					slot = (slot + 1) & (capacity - 1);
+					++distance;
+				}
+			}
+
+
+			void Rehash(int new_capacity) throw(MemoryException)
+			{
+				try
+				{
+					Vector<KEY> new_key(new_capacity);
+					Vector<int> new_probe(new_capacity);
+					new_probe.Fill(0);
+					key.Swap(new_key);
+					probe.Swap(new_probe);
+					register int old_capacity = capacity;
+					capacity = new_capacity;
+					shift = GrokInternal::HashShift(new_capacity);
+					for (register int s = 0; s < old_capacity; ++s)
+					{
+						if (new_probe.entry[s])
+						{
+							Place(new_key.entry[s]);
+						}
+					}
+				}
+				catch (MemoryException&)
+				{
+					ReThrow();
+				}
+			}
+	};
+
+
+	// Open-addressing hash map, laid out as HashSet with the values in an array parallel to the keys
+	template <typename KEY, typename VALUE, typename HASH = Hash<KEY> >
+	struct HashMap
+	{
+		int size;
+
+		int capacity;
+
+		Vector<KEY> key;
+
+		Vector<VALUE> value;
+
+		Vector<int> probe;
+
+		HASH hash;
+
+
+		HashMap(int count = 0, const HASH& hash = HASH()) throw(MemoryException)
+		:	size(0),
+			capacity(0),
+			key(),
+			value(),
+			probe(),
+			hash(hash),
+			shift(64)
+		{
+			try
+			{
+				if (count > 0)
+				{
+					Reserve(count);
+				}
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		HashMap(const HashMap<KEY, VALUE, HASH>& map) throw(MemoryException)
+		:	size(map.size),
+			capacity(map.capacity),
+			key(map.key),
+			value(map.value),
+			probe(map.probe),
+			hash(map.hash),
+			shift(map.shift)
+		{
+		}
+
+
+		HashMap<KEY, VALUE, HASH>& operator = (const HashMap<KEY, VALUE, HASH>& map) throw(MemoryException)
+		{
+			if (this != &map)
+			{
+				HashMap<KEY, VALUE, HASH> copy(map);
+				Swap(copy);
+			}
+			return *this;
+		}
+
+
+		void Swap(HashMap<KEY, VALUE, HASH>& map) throw()
+		{
+			register int swap_size = size;
+			size = map.size;
+			map.size = swap_size;
+			register int swap_capacity = capacity;
+			capacity = map.capacity;
+			map.capacity = swap_capacity;
+			key.Swap(map.key);
+			value.Swap(map.value);
+			probe.Swap(map.probe);
+			HASH swap_hash = hash;
+			hash = map.hash;
+			map.hash = swap_hash;
+			register int swap_shift = shift;
+			shift = map.shift;
+			map.shift = swap_shift;
+		}
+
+
+		// Grows the table so it holds count keys without rehashing
+		void Reserve(int count) throw(MemoryException)
+		{
+			Assert(count >= 0);
+
+			try
+			{
+				register int new_capacity = GrokInternal::HashCapacity(count);
+				if (new_capacity > capacity)
+				{
+					Rehash(new_capacity);
+				}
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Replaces the value when the key is already in the map, then returns false
+		bool Append(const KEY& k, const VALUE& v) throw(MemoryException)
+		{
+			try
+			{
+				register VALUE* __restrict stored = Search(k);
+				if (stored)
+				{
+					*stored = v;
+					return false;
+				}
+				if (capacity - capacity/8 <= size)
+				{
+					Rehash(GrokInternal::HashCapacity(size + 1));
+				}
+				Place(k, v);
+				++size;
+				return true;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return false;
+		}
+
+
+		// Appends count pairs after reserving room for all of them, returns how many keys were new
+		int Append(const KEY* keys, const VALUE* values, int count) throw(MemoryException)
+		{
+			Assert(count >= 0);
+
+			try
+			{
+				Reserve(size + count);
+				register int appended = 0;
+				for (register int i = 0; i < count; ++i)
+				{
+					register VALUE* __restrict stored = Search(keys[i]);
+					if (stored)
+					{
+						*stored = values[i];
+					}
+					else
+					{
+						Place(keys[i], values[i]);
+						++size;
+						++appended;
+					}
+				}
+				return appended;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return 0;
+		}
+
+
+		inline int Append(const Vector<KEY>& keys, const Vector<VALUE>& values) throw(MemoryException)
+		{
+			Assert(keys.size == values.size);
+
+			return Append(keys.entry, values.entry, keys.size);
+		}
+
+
+		// The value of a key, appended with VALUE() when absent
+		VALUE& operator [] (const KEY& k) throw(MemoryException)
+		{
+			try
+			{
+				register VALUE* __restrict stored = Search(k);
+				if (!stored)
+				{
+					Append(k, VALUE());
+					stored = Search(k);
+				}
+				return *stored;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return value.entry[0];
+		}
+
+
+		// Keeps the allocated slots
+		void Clear() throw()
+		{
+			for (register int s = 0; s < capacity; ++s)
+			{
+				probe.entry[s] = 0;
+			}
+			size = 0;
+		}
+
+
+		bool Delete(const KEY& k) throw()
+		{
+			register int slot = Find(k);
+			if (slot < 0)
+			{
+				return false;
+			}
+			register int next = (slot + 1) & (capacity - 1);
+			while (probe.entry[next] > 1)
+			{
+				key.entry[slot] = key.entry[next];
+				value.entry[slot] = value.entry[next];
+				probe.entry[slot] = probe.entry[next] - 1;
+				slot = next;
+				next = (next + 1) & (capacity - 1);
+			}
+			probe.entry[slot] = 0;
+			--size;
+			return true;
+		}
+
+
+		// The value of a key, null when absent
+		VALUE* Search(const KEY& k) throw()
+		{
+			register int slot = Find(k);
+			return (slot < 0) ? static_cast<VALUE*>(0) : value.entry + slot;
+		}
+
+
+		const VALUE* Search(const KEY& k) const throw()
+		{
+			register int slot = Find(k);
+			return (slot < 0) ? static_cast<const VALUE*>(0) : value.entry + slot;
+		}
+
+
+		// The keys in increasing order, with their values
+		void Ordered(Vector<KEY>& ordered_key, Vector<VALUE>& ordered_value) const throw(MemoryException)
+		{
+			try
+			{
+				ordered_key.Resize(size);
+				ordered_value.Resize(size);
+				if (size == 0)
+				{
+					return;
+				}
+				register int k = 0;
+				for (register int s = 0; s < capacity; ++s)
+				{
+					if (probe.entry[s])
+					{
+						ordered_key.entry[k] = key.entry[s];
+						ordered_value.entry[k] = value.entry[s];
+						++k;
+					}
+				}
+				SortByKey(ordered_key, ordered_value);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		private:
+
+			int shift;
+
+
+			int Find(const KEY& k) const throw()
+			{
+				if (capacity == 0)
+				{
+					return -1;
+				}
+				register int slot = GrokInternal::HashSlot(hash(k), shift);
+				for (register int distance = 1; probe.entry[slot] >= distance; ++distance)
+				{
+					if ((probe.entry[slot] == distance) && (key.entry[slot] == k))
+					{
+						return slot;
+					}
+					slot = (slot + 1) & (capacity - 1);
+				}
+				return -1;
+			}
+
+
+			// Places a key known to be absent, there must be a free slot
+			void Place(const KEY& k, const VALUE& v) throw()
+			{
+				KEY carried_key = k;
+				VALUE carried_value = v;
+				register int slot = GrokInternal::HashSlot(hash(carried_key), shift);
+				register int distance = 1;
+				for (;;)
+				{
+					if (probe.entry[slot] == 0)
+					{
+						key.entry[slot] = carried_key;
+						value.entry[slot] = carried_value;
+						probe.entry[slot] = distance;
+						return;
+					}
+					if (probe.entry[slot] < distance)
+					{
+						KEY swap_key = key.entry[slot];
+						key.entry[slot] = carried_key;
+						carried_key = swap_key;
+						VALUE swap_value = value.entry[slot];
+						value.entry[slot] = carried_value;
+						carried_value = swap_value;
+						register int swap_distance = probe.entry[slot];
+						probe.entry[slot] = distance;
+						distance = swap_distance;
+					}
+					slot = (slot + 1) & (capacity - 1);
+					++distance;
+				}
+			}
+
+
+			void Rehash(int new_capacity) throw(MemoryException)
+			{
+				try
+				{
+					Vector<KEY> new_key(new_capacity);
+					Vector<VALUE> new_value(new_capacity);
+					Vector<int> new_probe(new_capacity);
+					new_probe.Fill(0);
+					key.Swap(new_key);
+					value.Swap(new_value);
+					probe.Swap(new_probe);
+					register int old_capacity = capacity;
+					capacity = new_capacity;
+					shift = GrokInternal::HashShift(new_capacity);
+					for (register int s = 0; s < old_capacity; ++s)
+					{
+						if (new_probe.entry[s])
+						{
+							Place(new_key.entry[s], new_value.entry[s]);
+						}
+					}
+				}
+				catch (MemoryException&)
+				{
+					ReThrow();
+				}
+			}
+	};
+}
@@ -0,0 +1,609 @@
+// KDTree.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Memory.h>
+#include <Basic/Sort.h>
+#include <Container/Vector.h>
+#include <Math/Quadrature.h>
+
+#include <math.h>
+
+
+// Ranges with at most this many points are leaves, scanned linearly
+#if !defined(KDTREE_BUCKET_SIZE)
+	#define KDTREE_BUCKET_SIZE 8
+#endif
+
+// Trees with fewer points are built by one thread
+#if !defined(KDTREE_PARALLEL_BUILD_LIMIT)
+	#define KDTREE_PARALLEL_BUILD_LIMIT 65536
+#endif
+
+// Batches with fewer queries are answered by one thread
+#if !defined(KDTREE_PARALLEL_QUERY_LIMIT)
+	#define KDTREE_PARALLEL_QUERY_LIMIT 1024
+#endif
+
+
+namespace GrokInternal
+{
+	// Radix key of a point index by one of its coordinates
+	template <typename TYPE>
+	struct KDTreeCoordinate
+	{
+		typedef typename RadixKey<TYPE>::Bits Bits;
+
+		const TYPE* coordinate;
+
+		int stride;
+
+		int axis;
+
+
+		inline KDTreeCoordinate(const TYPE* coordinate, int stride, int axis) throw()
+		:	coordinate(coordinate),
+			stride(stride),
+			axis(axis)
+		{
+		}
+
+
+		inline Bits operator () (int i) const throw()
+		{
+			return RadixEncode(coordinate[static_cast<size_t>(i)*static_cast<size_t>(stride) + axis]);
+		}
+	};
+
+
+	// Keeps the k closest points sorted by distance
+	template <typename TYPE>
+	struct KDTreeNearest
+	{
+		int* __restrict position;
+
+		TYPE* __restrict distance2;
+
+		int k;
+
+		int count;
+
+
+		inline KDTreeNearest(int* position, TYPE* distance2, int k) throw()
+		:	position(position),
+			distance2(distance2),
+			k(k),
+			count(0)
+		{
+		}
+
+
+		inline TYPE Bound() const throw()
+		{
+			return (count < k) ? static_cast<TYPE>(HUGE_VAL) : distance2[k - 1];
+		}
+
+
+		inline void operator () (int p, TYPE d2) throw()
+		{
+			if ((count < k) || (d2 < distance2[k - 1]))
+			{
+				register int i = (count < k) ? count++ : k - 1;
+				while ((i > 0) && (distance2[i - 1] > d2))
+				{
+					position[i] = position[i - 1];
+					distance2[i] = distance2[i - 1];
+					--i;
+				}
+				position[i] = p;
+				distance2[i] = d2;
+			}
+		}
+	};
+
+
+	// Collects (or only counts, when result is null) the points within a radius
+	template <typename TYPE>
+	struct KDTreeWithin
+	{
+		Grok::Vector<int>* result;
+
+		TYPE radius2;
+
+		int count;
+
+
+		inline KDTreeWithin(Grok::Vector<int>* result, TYPE radius2) throw()
+		:	result(result),
+			radius2(radius2),
+			count(0)
+		{
+		}
+
+
+		inline TYPE Bound() const throw()
+		{
+			return radius2;
+		}
+
+
+		inline void operator () (int p, TYPE d2) throw(Grok::MemoryException)
+		{
+			if (d2 <= radius2)
+			{
+				if (result)
+				{
+					if (count == result->size)
+					{
+						Grok::Vector<int> grown((count < 8) ? 16 : 2*count);
+						for (register int i = 0; i < count; ++i)
+						{
+							grown.entry[i] = result->entry[i];
+						}
+						result->Swap(grown);
+					}
+					result->entry[count] = p;
+				}
+				++count;
+			}
+		}
+	};
+
+
+	// Writes the points within a radius to an array already sized for them
+	template <typename TYPE>
+	struct KDTreeWithinFill
+	{
+		int* __restrict output;
+
+		TYPE radius2;
+
+		int count;
+
+
+		inline KDTreeWithinFill(int* output, TYPE radius2) throw()
+		:	output(output),
+			radius2(radius2),
+			count(0)
+		{
+		}
+
+
+		inline TYPE Bound() const throw()
+		{
+			return radius2;
+		}
+
+
+		inline void operator () (int p, TYPE d2) throw()
+		{
+			if (d2 <= radius2)
+			{
+				output[count++] = p;
+			}
+		}
+	};
+}
+
+
+namespace Grok
+{
+	// Balanced kd-tree without pointers. The points are stored in tree order: the range [begin, end) of
+	// a node has its splitting point at middle = begin + (end - begin)/2, the left subtree in
+	// [begin, middle) and the right one in [middle + 1, end). Ranges of KDTREE_BUCKET_SIZE points or
+	// less are leaves. Each node splits along the axis where its points spread the most, the split
+	// axis is kept in axis[middle].
+	//
+	// The tree keeps a copy of the coordinates, queries return indices into the array given to Build.
+	// TYPE has to be float or double.
+	template <typename TYPE, int DIMENSION>
+	struct KDTree
+	{
+		int size;
+
+		// Coordinates in tree order, DIMENSION per point
+		Vector<TYPE> point;
+
+		// Index given to Build of each point
+		Vector<int> index;
+
+		Vector<unsigned char> axis;
+
+
+		inline KDTree() throw()
+		:	size(0),
+			point(),
+			index(),
+			axis()
+		{
+		}
+
+
+		KDTree(const TYPE* coordinate, int size, int stride = DIMENSION) throw(MemoryException)
+		:	size(0),
+			point(),
+			index(),
+			axis()
+		{
+			try
+			{
+				Build(coordinate, size, stride);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		KDTree(const Vector<QuadratureNode<TYPE, DIMENSION> >& node) throw(MemoryException)
+		:	size(0),
+			point(),
+			index(),
+			axis()
+		{
+			try
+			{
+				Build(node);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Point i has its coordinates at coordinate[i*stride], ..., coordinate[i*stride + DIMENSION - 1].
+		// Level by level, the nodes of a level are split in parallel, each by radix selection of its
+		// median along its widest axis.
+		void Build(const TYPE* coordinate, int size, int stride = DIMENSION) throw(MemoryException)
+		{
+			Assert(size >= 0);
+			Assert(stride >= DIMENSION);
+
+			try
+			{
+				this->size = 0;
+				Vector<int> order(size);
+				for (register int i = 0; i < size; ++i)
+				{
+					order.entry[i] = i;
+				}
+				axis.Resize(size);
+
+				// Inner ranges of the current and the next level, as begin, end pairs
+				const int capacity = 2*(size/(KDTREE_BUCKET_SIZE + 1) + 1);
+				Vector<int> level(capacity);
+				Vector<int> next_level(capacity);
+				register int ranges = 0;
+				if (size > KDTREE_BUCKET_SIZE)
+				{
+					level.entry[0] = 0;
+					level.entry[1] = size;
+					ranges = 1;
+				}
+				const int shift = 8*static_cast<int>(sizeof(typename GrokInternal::RadixKey<TYPE>::Bits)) - 8;
+				while (ranges > 0)
+				{
+					#if defined(_OPENMP)
+						#pragma omp parallel for schedule(dynamic) if ((size >= KDTREE_PARALLEL_BUILD_LIMIT) && (ranges > 1))
+					#endif
+					for (int r = 0; r < ranges; ++r)
+					{
+						const int begin = level.entry[2*r];
+						const int end = level.entry[2*r + 1];
+
+						TYPE minimum[DIMENSION];
+						TYPE maximum[DIMENSION];
+						for (register int d = 0; d < DIMENSION; ++d)
+						{
+							minimum[d] = maximum[d] = coordinate[static_cast<size_t>(order.entry[begin])*static_cast<size_t>(stride) + d];
+						}
+						for (register int i = begin + 1; i < end; ++i)
+						{
+							const TYPE* __restrict p = coordinate + static_cast<size_t>(order.entry[i])*static_cast<size_t>(stride);
+							for (register int d = 0; d < DIMENSION; ++d)
+							{
+								minimum[d] = (p[d] < minimum[d]) ? p[d] : minimum[d];
+								maximum[d] = (p[d] > maximum[d]) ? p[d] : maximum[d];
+							}
+						}
+						register int widest = 0;
+						for (register int d = 1; d < DIMENSION; ++d)
+						{
+							if (maximum[d] - minimum[d] > maximum[widest] - minimum[widest])
+							{
+								widest = d;
+							}
+						}
+
+						const int middle = begin + (end - begin)/2;
+						GrokInternal::RadixSelect(order.entry + begin, end - begin, middle - begin, shift, GrokInternal::KDTreeCoordinate<TYPE>(coordinate, stride, widest));
+						axis.entry[middle] = static_cast<unsigned char>(widest);
+					}
+
+					register int next_ranges = 0;
+					for (register int r = 0; r < ranges; ++r)
+					{
+						const int begin = level.entry[2*r];
+						const int end = level.entry[2*r + 1];
+						const int middle = begin + (end - begin)/2;
+						if (middle - begin > KDTREE_BUCKET_SIZE)
+						{
+							next_level.entry[2*next_ranges] = begin;
+							next_level.entry[2*next_ranges + 1] = middle;
+							++next_ranges;
+						}
+						if (end - middle - 1 > KDTREE_BUCKET_SIZE)
+						{
+							next_level.entry[2*next_ranges] = middle + 1;
+							next_level.entry[2*next_ranges + 1] = end;
+							++next_ranges;
+						}
+					}
+					level.Swap(next_level);
+					ranges = next_ranges;
+				}
+
+				point.Resize(size*DIMENSION);
+				index.Swap(order);
+				#if defined(_OPENMP)
+					#pragma omp parallel for schedule(static) if (size >= KDTREE_PARALLEL_BUILD_LIMIT)
+				#endif
+				for (int i = 0; i < size; ++i)
+				{
+					const TYPE* __restrict p = coordinate + static_cast<size_t>(index.entry[i])*static_cast<size_t>(stride);
+					for (register int d = 0; d < DIMENSION; ++d)
+					{
+						point.entry[i*DIMENSION + d] = p[d];
+					}
+				}
+				this->size = size;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// The weights of the nodes are ignored
+		void Build(const Vector<QuadratureNode<TYPE, DIMENSION> >& node) throw(MemoryException)
+		{
+			try
+			{
+				Build(node.entry ? node.entry[0].abscissa : static_cast<const TYPE*>(0), node.size, static_cast<int>(sizeof(QuadratureNode<TYPE, DIMENSION>)/sizeof(TYPE)));
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Index of the closest point, -1 for an empty tree
+		int Nearest(const TYPE* query, TYPE* distance2 = static_cast<TYPE*>(0)) const throw()
+		{
+			int nearest;
+			TYPE nearest_distance2;
+			if (Nearest(query, 1, &nearest, &nearest_distance2) == 0)
+			{
+				return -1;
+			}
+			if (distance2)
+			{
+				*distance2 = nearest_distance2;
+			}
+			return nearest;
+		}
+
+
+		// The k closest points by increasing distance, returns how many were found (fewer than k only
+		// when the tree has fewer points)
+		int Nearest(const TYPE* query, int k, int* index, TYPE* distance2) const throw()
+		{
+			Assert(k > 0);
+
+			GrokInternal::KDTreeNearest<TYPE> nearest(index, distance2, k);
+			Search(query, nearest);
+			for (register int i = 0; i < nearest.count; ++i)
+			{
+				index[i] = this->index.entry[index[i]];
+			}
+			return nearest.count;
+		}
+
+
+		// k nearest points of count queries at query[q*stride], answered by several threads. Query q
+		// writes index[q*k], ..., index[q*k + k - 1] and the same entries of distance2, with -1 indices
+		// past the points found.
+		void Nearest(const TYPE* query, int count, int k, int* index, TYPE* distance2, int stride = DIMENSION) const throw()
+		{
+			Assert(count >= 0);
+			Assert(stride >= DIMENSION);
+
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(dynamic, 64) if (count >= KDTREE_PARALLEL_QUERY_LIMIT)
+			#endif
+			for (int q = 0; q < count; ++q)
+			{
+				int* __restrict index_q = index + static_cast<size_t>(q)*static_cast<size_t>(k);
+				TYPE* __restrict distance2_q = distance2 + static_cast<size_t>(q)*static_cast<size_t>(k);
+				for (register int i = Nearest(query + static_cast<size_t>(q)*static_cast<size_t>(stride), k, index_q, distance2_q); i < k; ++i)
+				{
+					index_q[i] = -1;
+					distance2_q[i] = static_cast<TYPE>(HUGE_VAL);
+				}
+			}
+		}
+
+
+		// Points at distance radius or less, in no particular order. Their indices are the first entries
+		// of result, which is only grown (its capacity is kept between calls). Returns their number.
+		int Within(const TYPE* query, TYPE radius, Vector<int>& result) const throw(MemoryException)
+		{
+			try
+			{
+				GrokInternal::KDTreeWithin<TYPE> within(&result, radius*radius);
+				Search(query, within);
+				for (register int i = 0; i < within.count; ++i)
+				{
+					result.entry[i] = index.entry[result.entry[i]];
+				}
+				return within.count;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+			return 0;
+		}
+
+
+		// Points within radius of count queries at query[q*stride], answered by several threads in two
+		// passes (count, then fill). The indices for query q are result[begin[q]], ...,
+		// result[begin[q + 1] - 1].
+		void Within(const TYPE* query, int count, TYPE radius, Vector<int>& begin, Vector<int>& result, int stride = DIMENSION) const throw(MemoryException)
+		{
+			Assert(count >= 0);
+			Assert(stride >= DIMENSION);
+
+			try
+			{
+				begin.Resize(count + 1);
+				#if defined(_OPENMP)
+					#pragma omp parallel for schedule(dynamic, 64) if (count >= KDTREE_PARALLEL_QUERY_LIMIT)
+				#endif
+				for (int q = 0; q < count; ++q)
+				{
+					GrokInternal::KDTreeWithin<TYPE> within(static_cast<Vector<int>*>(0), radius*radius);
+					Search(query + static_cast<size_t>(q)*static_cast<size_t>(stride), within);
+					begin.entry[q + 1] = within.count;
+				}
+				begin.entry[0] = 0;
+				for (register int q = 0; q < count; ++q)
+				{
+					begin.entry[q + 1] += begin.entry[q];
+				}
+				result.Resize(begin.entry[count]);
+
+				#if defined(_OPENMP)
+					#pragma omp parallel for schedule(dynamic, 64) if (count >= KDTREE_PARALLEL_QUERY_LIMIT)
+				#endif
+				for (int q = 0; q < count; ++q)
+				{
+					GrokInternal::KDTreeWithinFill<TYPE> within(result.entry + begin.entry[q], radius*radius);
+					Search(query + static_cast<size_t>(q)*static_cast<size_t>(stride), within);
+					for (register int i = 0; i < within.count; ++i)
+					{
+						within.output[i] = index.entry[within.output[i]];
+					}
+				}
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		private:
+
+			static inline TYPE Distance2(const TYPE* __restrict a, const TYPE* __restrict b) throw()
+			{
+				register TYPE sum = 0;
+				for (register int d = 0; d < DIMENSION; ++d)
+				{
+					register TYPE difference = a[d] - b[d];
+					sum += difference*difference;
+				}
+				return sum;
+			}
+
+
+			// Visits every point that can be closer than visit.Bound(), the farther child of each node
+			// waits in a stack with the distance to its splitting plane, nearer children first
+			template <typename VISIT>
+			void Search(const TYPE* query, VISIT& visit) const
+			{
+				struct Range
+				{
+					int begin;
+
+					int end;
+
+					TYPE bound;
+				};
+
+				// Stacked ranges are at increasing depths, so the depth of the tree bounds the stack
+				Range stack[64];
+				register int top = 0;
+				if (size > 0)
+				{
+					stack[0].begin = 0;
+					stack[0].end = size;
+					stack[0].bound = 0;
+					top = 1;
+				}
+				while (top > 0)
+				{
+					--top;
+					if (stack[top].bound > visit.Bound())
+					{
+						continue;
+					}
+					register int begin = stack[top].begin;
+					register int end = stack[top].end;
+					while (end - begin > KDTREE_BUCKET_SIZE)
+					{
+						const int middle = begin + (end - begin)/2;
+						const TYPE* __restrict p = point.entry + middle*DIMENSION;
+						visit(middle, Distance2(query, p));
+
+						register TYPE difference = query[axis.entry[middle]] - p[axis.entry[middle]];
+						register int far_begin;
+						register int far_end;
+						if (difference < 0)
+						{
+							far_begin = middle + 1;
+							far_end = end;
+							end = middle;
+						}
+						else
+						{
+							far_begin = begin;
+							far_end = middle;
+							begin = middle + 1;
+						}
+						if ((far_end > far_begin) && (difference*difference <= visit.Bound()))
+						{
+							stack[top].begin = far_begin;
+							stack[top].end = far_end;
+							stack[top].bound = difference*difference;
+							++top;
+						}
+					}
+					for (register int i = begin; i < end; ++i)
+					{
+						visit(i, Distance2(query, point.entry + i*DIMENSION));
+					}
+				}
+			}
+	};
+}
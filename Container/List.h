@@ -47,7 +47,7 @@ namespace Grok
 
 		private:
 
-			struct ListBlock
+			struct ListBlock : public PoolObject
 			{
 				ListItem<TYPE> data[BLOCK_SIZE];
 
@@ -88,7 +88,7 @@ namespace Grok
 			{
 				for (register ListItem<TYPE>* __restrict item = list.first; item; item = item->next)
 				{
-					AppendLast(item->value);
+					AppendLast() = item->value;
 				}
 			}
 
@@ -104,7 +104,7 @@ namespace Grok
 			{
 				for (register ListItem<TYPE>* __restrict item = list.first; item; item = item->next)
 				{
-					AppendLast(item->value);
+					AppendLast() = item->value;
 				}
 			}
 
@@ -127,7 +127,7 @@ namespace Grok
 					Clear();
 					for (register ListItem<TYPE>* __restrict item = list.first; item; item = item->next)
 					{
-						AppendLast(item->value);
+						AppendLast() = item->value;
 					}
 				}
 				return *this;
@@ -142,7 +142,7 @@ namespace Grok
 					Clear();
 					for (register ListItem<TYPE>* __restrict item = list.first; item; item = item->next)
 					{
-						AppendLast(item->value);
+						AppendLast() = item->value;
 					}
 				}
 				return *this;
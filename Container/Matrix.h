@@ -19,6 +19,7 @@
 
 #include <Basic/Assert.h>
 #include <Basic/Memory.h>
+#include <Container/MatrixView.h>
 
 
 namespace Grok
@@ -55,12 +56,26 @@ namespace Grok
 		}
 
 
+		Matrix(int rows, int columns, const MemoryPolicy& policy) throw(MemoryException)
+		{
+			try
+			{
+				entry = static_cast<TYPE**>(0);
+				Resize(rows, columns, policy);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
 		Matrix(const Matrix<TYPE>& matrix, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
 		{
 			try
 			{
 				entry = static_cast<TYPE**>(0);
-				Resize(rows, columns, alignment);
+				Resize(matrix.rows, matrix.columns, alignment);
 				for (int i = 0; i < rows; ++i)
 				{
 					TYPE* __restrict entry_i = entry[i];
@@ -78,6 +93,21 @@ namespace Grok
 		}
 
 
+		#if defined(RVALUE_REFERENCES)
+
+			inline Matrix(Matrix<TYPE>&& matrix) throw()
+			:	entry(matrix.entry),
+				rows(matrix.rows),
+				columns(matrix.columns)
+			{
+				matrix.entry = static_cast<TYPE**>(0);
+				matrix.rows = 0;
+				matrix.columns = 0;
+			}
+
+		#endif
+
+
 		~Matrix() throw()
 		{
 			if (entry)
@@ -106,8 +136,94 @@ namespace Grok
 		}
 
 
+		#if defined(RVALUE_REFERENCES)
+
+			// Unlike the copy, a move may change the dimensions
+			inline Matrix& operator = (Matrix&& matrix) throw()
+			{
+				Swap(matrix);
+				return *this;
+			}
+
+		#endif
+
+
+		// Exchanges the buffers, nothing is allocated nor copied
+		inline void Swap(Matrix<TYPE>& matrix) throw()
+		{
+			register TYPE** swap_entry = entry;
+			entry = matrix.entry;
+			matrix.entry = swap_entry;
+			register int swap_rows = rows;
+			rows = matrix.rows;
+			matrix.rows = swap_rows;
+			register int swap_columns = columns;
+			columns = matrix.columns;
+			matrix.columns = swap_columns;
+		}
+
+
+		// Takes ownership of a row pointer array whose first row starts the data block, both allocated with
+		// new (as Release returns them), the current buffers are released
+		inline void Adopt(TYPE** entry, int rows, int columns) throw()
+		{
+			Assert(entry || (rows == 0));
+
+			if (this->entry)
+			{
+				delete [] this->entry[0];
+				delete [] this->entry;
+			}
+			this->entry = entry;
+			this->rows = rows;
+			this->columns = columns;
+		}
+
+
+		// Gives up the buffers, the caller has to delete [] entry[0] and entry, and leaves the matrix empty
+		inline TYPE** Release() throw()
+		{
+			register TYPE** buffer = entry;
+			entry = static_cast<TYPE**>(0);
+			rows = 0;
+			columns = 0;
+			return buffer;
+		}
+
+
+		// Row-major view of all the entries. Reallocate places the rows in one block with a constant stride,
+		// which becomes the leading dimension (adopted buffers have to keep that layout)
+		MatrixView<TYPE> View() const throw()
+		{
+			if (!entry)
+			{
+				return MatrixView<TYPE>();
+			}
+			register int leading = columns;
+			if (rows > 1)
+			{
+				register size_t row_size = static_cast<size_t>(reinterpret_cast<const char*>(entry[1]) - reinterpret_cast<const char*>(entry[0]));
+
+				Assert(row_size % sizeof(TYPE) == 0);
+
+				leading = static_cast<int>(row_size/sizeof(TYPE));
+			}
+			return MatrixView<TYPE>(entry[0], rows, columns, leading, MatrixLayout::row_major);
+		}
+
+
+		inline MatrixView<TYPE> View(int row, int column, int rows, int columns) const throw()
+		{
+			return View().View(row, column, rows, columns);
+		}
+
+
+		// Rows are filled in parallel with a static schedule to place each page by first touch
 		void Fill(const TYPE& value) throw()
 		{
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (static_cast<size_t>(rows)*static_cast<size_t>(columns) >= PARALLEL_FILL_LIMIT)
+			#endif
 			for (int i = 0; i < rows; ++i)
 			{
 				TYPE* __restrict entry_i = entry[i];
@@ -119,8 +235,23 @@ namespace Grok
 		}
 
 
-		void Resize(int rows, int columns, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
+		inline void Resize(int rows, int columns, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
 		{
+			Reallocate(rows, columns, alignment);
+		}
+
+
+		inline void Resize(int rows, int columns, const MemoryPolicy& policy) throw(MemoryException)
+		{
+			Reallocate(rows, columns, policy);
+		}
+
+
+		template <typename ALLOCATION>
+		void Reallocate(int rows, int columns, const ALLOCATION& allocation) throw(MemoryException)
+		{
+			const unsigned short alignment = GrokInternal::AllocationAlignment(allocation);
+
 			Assert(rows >= 0);
 			Assert(columns >= 0);
 
@@ -135,7 +266,7 @@ namespace Grok
 				if (entry)
 				{
 					unsigned int row_size = SIZE_WITH_PAD(TYPE, columns, alignment);
-					char* __restrict entry_i = new(alignment) char[static_cast<size_t>(rows)*row_size];
+					char* __restrict entry_i = new(allocation) char[static_cast<size_t>(rows)*row_size];
 					if (entry_i)
 					{
 						for (register int i = 0; i < rows; ++i)
@@ -0,0 +1,228 @@
+// MatrixView.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/System.h>
+
+
+namespace Grok
+{
+	namespace MatrixLayout
+	{
+		enum ID
+		{
+			row_major,   // Entry (i, j) at entry[i*leading + j]
+			column_major // Entry (i, j) at entry[i + j*leading]
+		};
+	}
+
+
+	// Strided window over memory owned by someone else, copying it copies no entries
+	template <typename TYPE>
+	struct VectorView
+	{
+		TYPE* entry;
+
+		int size;
+
+		int stride;
+
+
+		inline VectorView() throw()
+		:	entry(static_cast<TYPE*>(0)),
+			size(0),
+			stride(1)
+		{
+		}
+
+
+		inline VectorView(TYPE* entry, int size, int stride = 1) throw()
+		:	entry(entry),
+			size(size),
+			stride(stride)
+		{
+		}
+
+
+		inline TYPE& operator [] (int i) const throw()
+		{
+			Assert((i >= 0) && (i < size));
+
+			return entry[static_cast<size_t>(i)*static_cast<size_t>(stride)];
+		}
+	};
+
+
+	// Window of a row- or column-major matrix with leading dimension, the (pointer, leading dimension)
+	// pair BLAS-style kernels take. Views never own their entries, so they must not outlive the owner.
+	template <typename TYPE>
+	struct MatrixView
+	{
+		TYPE* entry;
+
+		int rows;
+
+		int columns;
+
+		int leading;
+
+		MatrixLayout::ID layout;
+
+
+		inline MatrixView() throw()
+		:	entry(static_cast<TYPE*>(0)),
+			rows(0),
+			columns(0),
+			leading(0),
+			layout(MatrixLayout::row_major)
+		{
+		}
+
+
+		inline MatrixView(TYPE* entry, int rows, int columns, int leading, MatrixLayout::ID layout = MatrixLayout::row_major) throw()
+		:	entry(entry),
+			rows(rows),
+			columns(columns),
+			leading(leading),
+			layout(layout)
+		{
+			Assert(leading >= ((layout == MatrixLayout::row_major) ? columns : rows));
+		}
+
+
+		// From a view of TYPE to one of const TYPE
+		template <typename OTHER_TYPE>
+		inline MatrixView(const MatrixView<OTHER_TYPE>& view) throw()
+		:	entry(view.entry),
+			rows(view.rows),
+			columns(view.columns),
+			leading(view.leading),
+			layout(view.layout)
+		{
+		}
+
+
+		inline TYPE& operator () (int i, int j) const throw()
+		{
+			Assert((i >= 0) && (i < rows));
+			Assert((j >= 0) && (j < columns));
+
+			return Entry(i, j);
+		}
+
+
+		// Sub-matrix of rows [row, row + rows) and columns [column, column + columns), with the same leading dimension
+		inline MatrixView View(int row, int column, int rows, int columns) const throw()
+		{
+			Assert((row >= 0) && (rows >= 0) && (row + rows <= this->rows));
+			Assert((column >= 0) && (columns >= 0) && (column + columns <= this->columns));
+
+			return MatrixView(&Entry(row, column), rows, columns, leading, layout);
+		}
+
+
+		inline VectorView<TYPE> Row(int i) const throw()
+		{
+			Assert((i >= 0) && (i < rows));
+
+			return (layout == MatrixLayout::row_major) ? VectorView<TYPE>(&Entry(i, 0), columns, 1) : VectorView<TYPE>(&Entry(i, 0), columns, leading);
+		}
+
+
+		inline VectorView<TYPE> Column(int j) const throw()
+		{
+			Assert((j >= 0) && (j < columns));
+
+			return (layout == MatrixLayout::row_major) ? VectorView<TYPE>(&Entry(0, j), rows, leading) : VectorView<TYPE>(&Entry(0, j), rows, 1);
+		}
+
+
+		// The same entries read as the transposed matrix, only the layout flips
+		inline MatrixView Transpose() const throw()
+		{
+			return MatrixView(entry, columns, rows, leading, (layout == MatrixLayout::row_major) ? MatrixLayout::column_major : MatrixLayout::row_major);
+		}
+
+
+		// Copies the entries of a view with the same dimensions, layouts may differ
+		void Copy(const MatrixView<const TYPE>& source) const throw()
+		{
+			Assert(rows == source.rows);
+			Assert(columns == source.columns);
+
+			if ((layout == MatrixLayout::row_major) && (source.layout == MatrixLayout::row_major))
+			{
+				for (int i = 0; i < rows; ++i)
+				{
+					register TYPE* __restrict entry_i = entry + static_cast<size_t>(i)*static_cast<size_t>(leading);
+					register const TYPE* __restrict source_i = source.entry + static_cast<size_t>(i)*static_cast<size_t>(source.leading);
+					for (register int j = 0; j < columns; ++j)
+					{
+						entry_i[j] = source_i[j];
+					}
+				}
+			}
+			else if ((layout == MatrixLayout::column_major) && (source.layout == MatrixLayout::column_major))
+			{
+				for (int j = 0; j < columns; ++j)
+				{
+					register TYPE* __restrict entry_j = entry + static_cast<size_t>(j)*static_cast<size_t>(leading);
+					register const TYPE* __restrict source_j = source.entry + static_cast<size_t>(j)*static_cast<size_t>(source.leading);
+					for (register int i = 0; i < rows; ++i)
+					{
+						entry_j[i] = source_j[i];
+					}
+				}
+			}
+			else
+			{
+				for (int i = 0; i < rows; ++i)
+				{
+					for (register int j = 0; j < columns; ++j)
+					{
+						Entry(i, j) = source(i, j);
+					}
+				}
+			}
+		}
+
+
+		void Fill(const TYPE& value) const throw()
+		{
+			register int major = (layout == MatrixLayout::row_major) ? rows : columns;
+			register int minor = (layout == MatrixLayout::row_major) ? columns : rows;
+			for (int k = 0; k < major; ++k)
+			{
+				register TYPE* __restrict entry_k = entry + static_cast<size_t>(k)*static_cast<size_t>(leading);
+				for (register int l = 0; l < minor; ++l)
+				{
+					entry_k[l] = value;
+				}
+			}
+		}
+
+
+		private:
+
+			inline TYPE& Entry(int i, int j) const throw()
+			{
+				return (layout == MatrixLayout::row_major) ? entry[static_cast<size_t>(i)*static_cast<size_t>(leading) + j] : entry[i + static_cast<size_t>(j)*static_cast<size_t>(leading)];
+			}
+	};
+}
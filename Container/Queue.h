@@ -29,11 +29,11 @@ namespace Grok
 	{
 		private:
 
-			struct QueueBlock
+			struct QueueBlock : public PoolObject
 			{
 				QueueBlock* next;
 
-				ALIGNED TYPE data[BLOCK_SIZE];
+				TYPE data[BLOCK_SIZE];
 			};
 
 			QueueBlock* first_block;
@@ -73,7 +73,7 @@ namespace Grok
 					QueueBlock* __restrict new_block = new QueueBlock;
 					if (!new_block)
 					{
-						Throw(Memory::exception);
+						Throw(MemoryException());
 					}
 					int block_size;
 					if (other_block->next)
@@ -134,7 +134,7 @@ namespace Grok
 						QueueBlock* __restrict new_block = new QueueBlock;
 						if (!new_block)
 						{
-							Throw(Memory::exception);
+							Throw(MemoryException());
 						}
 						int block_size;
 						if (other_block->next)
@@ -200,7 +200,7 @@ namespace Grok
 					register QueueBlock* __restrict new_block = new QueueBlock;
 					if (!new_block)
 					{
-						Throw(Memory::exception);
+						Throw(MemoryException());
 					}
 					new_block->next = (QueueBlock*)0;
 					if (!first_block)
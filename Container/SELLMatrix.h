@@ -0,0 +1,192 @@
+// SELLMatrix.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Memory.h>
+#include <Basic/Sort.h>
+#include <Container/CSRMatrix.h>
+#include <Container/Vector.h>
+
+
+namespace Grok
+{
+	// Sliced ELLPACK (SELL-C-sigma) matrix. M. Kreutzer, G. Hager, G. Wellein, H. Fehske, A. R. Bishop,
+	// A Unified Sparse Matrix Data Format for Efficient General Sparse Matrix-Vector Multiplication on
+	// Modern Processors with Wide SIMD Units. SIAM Journal on Scientific Computing, Vol. 36, No. 5. 2014.
+	//
+	// Rows are sorted by decreasing length inside windows of sigma rows, then cut in slices of
+	// chunk_size rows. Each slice is stored column by column, padded to its longest row with zeros, so
+	// entry k of the r-th row of slice s is at slice_begin[s] + k*chunk_size + r. Row p of the slices is
+	// row permutation[p] of the matrix. Suits matrices whose rows have similar lengths, where the
+	// padding is small and SpMV runs chunk_size rows at once in SIMD lanes.
+	template <typename TYPE>
+	struct SparseMatrixSELL
+	{
+		int rows;
+
+		int columns;
+
+		int chunk_size;
+
+		int slices;
+
+		Vector<int> slice_begin;
+
+		Vector<int> column;
+
+		Vector<TYPE> value;
+
+		Vector<int> permutation;
+
+
+		inline SparseMatrixSELL() throw()
+		:	rows(0),
+			columns(0),
+			chunk_size(8),
+			slices(0),
+			slice_begin(),
+			column(),
+			value(),
+			permutation()
+		{
+		}
+
+
+		SparseMatrixSELL(const SparseMatrixCSR<TYPE>& matrix, int chunk_size = 8, int sigma = 256) throw(MemoryException)
+		:	rows(0),
+			columns(0),
+			chunk_size(8),
+			slices(0),
+			slice_begin(),
+			column(),
+			value(),
+			permutation()
+		{
+			try
+			{
+				Convert(matrix, chunk_size, sigma);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
+		// Stored entries, padding included
+		inline int Size() const throw()
+		{
+			return value.size;
+		}
+
+
+		void Convert(const SparseMatrixCSR<TYPE>& matrix, int chunk_size = 8, int sigma = 256) throw(MemoryException)
+		{
+			Assert(chunk_size > 0);
+			Assert(sigma > 0);
+
+			try
+			{
+				const int rows = matrix.rows;
+				const int* __restrict row_begin = matrix.row_begin.entry;
+
+				// Longest rows first inside each window, the sort is stable so equal rows keep their order
+				permutation.Resize(rows);
+				Vector<int> length(rows);
+				for (register int i = 0; i < rows; ++i)
+				{
+					length.entry[i] = row_begin[i] - row_begin[i + 1];
+				}
+				for (register int window = 0; window < rows; window += sigma)
+				{
+					register int size = (rows - window < sigma) ? rows - window : sigma;
+					RadixSortPermutation(length.entry + window, size, permutation.entry + window);
+					for (register int p = window; p < window + size; ++p)
+					{
+						permutation.entry[p] += window;
+					}
+				}
+
+				// After the sort length holds minus the row lengths
+				const int slices = (rows + chunk_size - 1)/chunk_size;
+				slice_begin.Resize(slices + 1);
+				register int size = 0;
+				for (register int s = 0; s < slices; ++s)
+				{
+					register int width = 0;
+					for (register int p = s*chunk_size; (p < rows) && (p < (s + 1)*chunk_size); ++p)
+					{
+						if (-length.entry[p] > width)
+						{
+							width = -length.entry[p];
+						}
+					}
+					slice_begin.entry[s] = size;
+					size += width*chunk_size;
+				}
+				slice_begin.entry[slices] = size;
+				column.Resize(size);
+				value.Resize(size);
+
+				const int* __restrict matrix_column = matrix.column.entry;
+				const TYPE* __restrict matrix_value = matrix.value.entry;
+				#if defined(_OPENMP)
+					#pragma omp parallel for schedule(static) if (size >= PARALLEL_FILL_LIMIT)
+				#endif
+				for (int s = 0; s < slices; ++s)
+				{
+					register int width = (slice_begin.entry[s + 1] - slice_begin.entry[s])/chunk_size;
+					for (register int r = 0; r < chunk_size; ++r)
+					{
+						register int p = s*chunk_size + r;
+						register int* __restrict column_r = column.entry + slice_begin.entry[s] + r;
+						register TYPE* __restrict value_r = value.entry + slice_begin.entry[s] + r;
+						register int k = 0;
+						if (p < rows)
+						{
+							register int i = permutation.entry[p];
+							for (register int l = row_begin[i]; l < row_begin[i + 1]; ++l, ++k)
+							{
+								column_r[k*chunk_size] = matrix_column[l];
+								value_r[k*chunk_size] = matrix_value[l];
+							}
+						}
+
+						// Padding reads a valid x entry and adds zero
+						register int padding_column = (k > 0) ? column_r[(k - 1)*chunk_size] : 0;
+						for (; k < width; ++k)
+						{
+							column_r[k*chunk_size] = padding_column;
+							value_r[k*chunk_size] = 0;
+						}
+					}
+				}
+
+				this->rows = rows;
+				this->columns = matrix.columns;
+				this->chunk_size = chunk_size;
+				this->slices = slices;
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+	};
+}
@@ -45,7 +45,7 @@ namespace Grok
 
 		private:
 
-			struct SequenceBlock
+			struct SequenceBlock : public PoolObject
 			{
 				SequenceItem<TYPE> data[BLOCK_SIZE];
 				SequenceBlock* previous;
@@ -155,7 +155,7 @@ namespace Grok
 				}
 				else
 				{
-					register SequenceBlock* __restrict new_block = new(DEFAULT_ALIGNMENT) SequenceBlock;
+					register SequenceBlock* __restrict new_block = new SequenceBlock;
 					if (!new_block)
 					{
 						Throw(MemoryException());
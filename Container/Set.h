@@ -43,7 +43,7 @@ namespace Grok
 
 		private:
 
-			struct SetBlock
+			struct SetBlock : public PoolObject
 			{
 				SetBlock* previous;
 
@@ -29,7 +29,7 @@ namespace Grok
 	{
 		private:
 
-			struct StackBlock
+			struct StackBlock : public PoolObject
 			{
 				StackBlock* previous;
 
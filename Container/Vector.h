@@ -52,12 +52,26 @@ namespace Grok
 		}
 
 
+		Vector(int size, const MemoryPolicy& policy) throw(MemoryException)
+		{
+			try
+			{
+				entry = static_cast<TYPE*>(0);
+				Resize(size, policy);
+			}
+			catch (MemoryException&)
+			{
+				ReThrow();
+			}
+		}
+
+
 		Vector(const Vector<TYPE>& vector) throw(MemoryException)
 		{
 			try
 			{
 				entry = static_cast<TYPE*>(0);
-				Resize(size);
+				Resize(vector.size);
 				for (register int i = 0; i < size; ++i)
 				{
 					entry[i] = vector.entry[i];
@@ -70,6 +84,19 @@ namespace Grok
 		}
 
 
+		#if defined(RVALUE_REFERENCES)
+
+			inline Vector(Vector<TYPE>&& vector) throw()
+			:	entry(vector.entry),
+				size(vector.size)
+			{
+				vector.entry = static_cast<TYPE*>(0);
+				vector.size = 0;
+			}
+
+		#endif
+
+
 		~Vector() throw()
 		{
 			delete [] entry;
@@ -88,9 +115,59 @@ namespace Grok
 		}
 
 
+		#if defined(RVALUE_REFERENCES)
+
+			// Unlike the copy, a move may change the size
+			inline Vector& operator = (Vector&& vector) throw()
+			{
+				Swap(vector);
+				return *this;
+			}
+
+		#endif
+
+
+		// Exchanges the buffers, nothing is allocated nor copied
+		inline void Swap(Vector<TYPE>& vector) throw()
+		{
+			register TYPE* swap_entry = entry;
+			entry = vector.entry;
+			vector.entry = swap_entry;
+			register int swap_size = size;
+			size = vector.size;
+			vector.size = swap_size;
+		}
+
+
+		// Takes ownership of a buffer allocated with new(alignment) or new(policy), the current one is released
+		inline void Adopt(TYPE* entry, int size) throw()
+		{
+			Assert(entry || (size == 0));
+
+			delete [] this->entry;
+			this->entry = entry;
+			this->size = size;
+		}
+
+
+		// Gives up the buffer, which the caller has to delete [], and leaves the vector empty
+		inline TYPE* Release() throw()
+		{
+			register TYPE* buffer = entry;
+			entry = static_cast<TYPE*>(0);
+			size = 0;
+			return buffer;
+		}
+
+
+		// Large vectors are filled in parallel with a static schedule, so each page is first touched by the
+		// thread that will work on it in later static loops
 		void Fill(const TYPE& value) throw()
 		{
-			for (register int i = 0; i < size; ++i)
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (size >= PARALLEL_FILL_LIMIT)
+			#endif
+			for (int i = 0; i < size; ++i)
 			{
 				entry[i] = value;
 			}
@@ -101,14 +178,30 @@ namespace Grok
 		{
 			Assert(data);
 
-			for (register int i = 0; i < size; ++i)
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (size >= PARALLEL_FILL_LIMIT)
+			#endif
+			for (int i = 0; i < size; ++i)
 			{
 				entry[i] = data[i];
 			}
 		}
 
 
-		void Resize(int size, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
+		inline void Resize(int size, unsigned short alignment = (DEFAULT_ALIGNMENT)) throw(MemoryException)
+		{
+			Reallocate(size, alignment);
+		}
+
+
+		inline void Resize(int size, const MemoryPolicy& policy) throw(MemoryException)
+		{
+			Reallocate(size, policy);
+		}
+
+
+		template <typename ALLOCATION>
+		void Reallocate(int size, const ALLOCATION& allocation) throw(MemoryException)
 		{
 			#if defined(CC_Intel)
 				#pragma warning(push)
@@ -123,7 +216,7 @@ namespace Grok
 			}
 			if (size > 0)
 			{
-				entry = new(alignment) TYPE[static_cast<size_t>(size)];
+				entry = new(allocation) TYPE[static_cast<size_t>(size)];
 				if (!entry)
 				{
 					this->size = 0;
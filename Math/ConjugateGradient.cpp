@@ -0,0 +1,455 @@
+// ConjugateGradient.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include <Math/ConjugateGradient.h>
+
+#include <math.h>
+
+#if defined(_OPENMP)
+	#include <omp.h>
+#endif
+
+
+namespace GrokInternal
+{
+	// q = A*p, returns p·q
+	double ProductDot(const Grok::SparseMatrixCSR<double>& a, const double* __restrict p, double* __restrict q) throw()
+	{
+		const int* __restrict row_begin = a.row_begin.entry;
+		const int* __restrict column = a.column.entry;
+		const double* __restrict value = a.value.entry;
+		double pq = 0;
+		#if defined(_OPENMP)
+			#pragma omp parallel reduction(+: pq) if (a.NonZeros() >= PARALLEL_PRODUCT_LIMIT)
+		#endif
+		{
+			int begin = 0;
+			int end = a.rows;
+			#if defined(_OPENMP)
+				a.Partition(omp_get_num_threads(), omp_get_thread_num(), begin, end);
+			#endif
+			for (register int i = begin; i < end; ++i)
+			{
+				register double sum = 0;
+				for (register int k = row_begin[i]; k < row_begin[i + 1]; ++k)
+				{
+					sum += value[k]*p[column[k]];
+				}
+				q[i] = sum;
+				pq += p[i]*sum;
+			}
+		}
+		return pq;
+	}
+
+
+	// Row i of the strict lower triangle of L is [row_begin[i], row_begin[i + 1] - 1), returns the sum of
+	// L(i, m)*L(j, m) for m < j over the entries of row i before k
+	inline double SparseRowsDot(const int* __restrict row_begin, const int* __restrict column, const double* __restrict value, int i, int k, int j) throw()
+	{
+		register double sum = 0;
+		register int m_i = row_begin[i];
+		register int m_j = row_begin[j];
+		const int end_j = row_begin[j + 1] - 1;
+		while ((m_i < k) && (m_j < end_j))
+		{
+			if (column[m_i] < column[m_j])
+			{
+				++m_i;
+			}
+			else if (column[m_i] > column[m_j])
+			{
+				++m_j;
+			}
+			else
+			{
+				sum += value[m_i]*value[m_j];
+				++m_i;
+				++m_j;
+			}
+		}
+		return sum;
+	}
+
+
+	// Row-wise IC(0) of the lower triangle stored in factor, original holds its entries. Returns the row
+	// of the first pivot that is not positive, -1 when there is none.
+	int IncompleteCholesky(Grok::SparseMatrixCSR<double>& factor, const double* __restrict original, double shift) throw()
+	{
+		const int* __restrict row_begin = factor.row_begin.entry;
+		const int* __restrict column = factor.column.entry;
+		double* __restrict value = factor.value.entry;
+		for (register int i = 0; i < factor.rows; ++i)
+		{
+			const int d = row_begin[i + 1] - 1;
+			for (register int k = row_begin[i]; k < d; ++k)
+			{
+				register int j = column[k];
+				value[k] = (original[k] - SparseRowsDot(row_begin, column, value, i, k, j))/value[row_begin[j + 1] - 1];
+			}
+			register double pivot = original[d]*(1 + shift);
+			for (register int k = row_begin[i]; k < d; ++k)
+			{
+				pivot -= value[k]*value[k];
+			}
+			if (!(pivot > 0))
+			{
+				return i;
+			}
+			value[d] = sqrt(pivot);
+		}
+		return -1;
+	}
+}
+
+
+namespace Grok
+{
+	JacobiPreconditioner::JacobiPreconditioner(const SparseMatrixCSR<double>& a) throw(MemoryException)
+	:	Preconditioner(),
+		inverse_diagonal()
+	{
+		Assert(a.rows == a.columns);
+
+		try
+		{
+			inverse_diagonal.Resize(a.rows);
+			for (register int i = 0; i < a.rows; ++i)
+			{
+				const double* a_ii = a.Find(i, i);
+
+				Assert(a_ii && (*a_ii > 0));
+
+				inverse_diagonal.entry[i] = 1.0/(*a_ii);
+			}
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	double JacobiPreconditioner::Apply(const double* r, double* z) const throw()
+	{
+		const int size = inverse_diagonal.size;
+		const double* __restrict d = inverse_diagonal.entry;
+		double rz = 0;
+		#if defined(_OPENMP)
+			#pragma omp parallel for schedule(static) reduction(+: rz) if (size >= PARALLEL_VECTOR_LIMIT)
+		#endif
+		for (int i = 0; i < size; ++i)
+		{
+			register double z_i = d[i]*r[i];
+			z[i] = z_i;
+			rz += r[i]*z_i;
+		}
+		return rz;
+	}
+
+
+	IncompleteCholeskyPreconditioner::IncompleteCholeskyPreconditioner(const SparseMatrixCSR<double>& a) throw(MemoryException, FactorizationException)
+	:	Preconditioner(),
+		factor(),
+		shift(0)
+	{
+		Assert(a.rows == a.columns);
+
+		try
+		{
+			const int rows = a.rows;
+			const int* __restrict row_begin = a.row_begin.entry;
+			const int* __restrict column = a.column.entry;
+			register int nonzeros = 0;
+			for (register int i = 0; i < rows; ++i)
+			{
+				for (register int k = row_begin[i]; (k < row_begin[i + 1]) && (column[k] <= i); ++k)
+				{
+					++nonzeros;
+				}
+			}
+			factor.Resize(rows, rows, nonzeros);
+			register int n = 0;
+			for (register int i = 0; i < rows; ++i)
+			{
+				factor.row_begin.entry[i] = n;
+				for (register int k = row_begin[i]; (k < row_begin[i + 1]) && (column[k] <= i); ++k, ++n)
+				{
+					factor.column.entry[n] = column[k];
+					factor.value.entry[n] = a.value.entry[k];
+				}
+
+				Assert((n > factor.row_begin.entry[i]) && (factor.column.entry[n - 1] == i) && (factor.value.entry[n - 1] > 0));
+			}
+			factor.row_begin.entry[rows] = n;
+
+			Vector<double> original(factor.value);
+			register int failed = GrokInternal::IncompleteCholesky(factor, original.entry, shift);
+			for (register int attempt = 1; (failed >= 0) && (attempt < INCOMPLETE_CHOLESKY_SHIFTS); ++attempt)
+			{
+				shift = (shift == 0) ? 1e-3 : 2*shift;
+				failed = GrokInternal::IncompleteCholesky(factor, original.entry, shift);
+			}
+			if (failed >= 0)
+			{
+				Throw(FactorizationException(failed));
+			}
+		}
+		catch (Exception&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	double IncompleteCholeskyPreconditioner::Apply(const double* r, double* z) const throw()
+	{
+		const int rows = factor.rows;
+		const int* __restrict row_begin = factor.row_begin.entry;
+		const int* __restrict column = factor.column.entry;
+		const double* __restrict value = factor.value.entry;
+
+		// L*y = r by rows
+		for (register int i = 0; i < rows; ++i)
+		{
+			const int d = row_begin[i + 1] - 1;
+			register double sum = r[i];
+			for (register int k = row_begin[i]; k < d; ++k)
+			{
+				sum -= value[k]*z[column[k]];
+			}
+			z[i] = sum/value[d];
+		}
+
+		// L'*z = y by columns of L', z_i is final when its column is reached
+		register double rz = 0;
+		for (register int i = rows - 1; i >= 0; --i)
+		{
+			const int d = row_begin[i + 1] - 1;
+			register double z_i = z[i]/value[d];
+			z[i] = z_i;
+			rz += r[i]*z_i;
+			for (register int k = row_begin[i]; k < d; ++k)
+			{
+				z[column[k]] -= value[k]*z_i;
+			}
+		}
+		return rz;
+	}
+
+
+	SSORPreconditioner::SSORPreconditioner(const SparseMatrixCSR<double>& a, double omega) throw(MemoryException)
+	:	Preconditioner(),
+		matrix(&a),
+		omega(omega),
+		diagonal(),
+		scale()
+	{
+		Assert(a.rows == a.columns);
+		Assert((omega > 0) && (omega < 2));
+
+		try
+		{
+			diagonal.Resize(a.rows);
+			scale.Resize(a.rows);
+			for (register int i = 0; i < a.rows; ++i)
+			{
+				const double* a_ii = a.Find(i, i);
+
+				Assert(a_ii && (*a_ii > 0));
+
+				diagonal.entry[i] = static_cast<int>(a_ii - a.value.entry);
+				scale.entry[i] = omega/(*a_ii);
+			}
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	double SSORPreconditioner::Apply(const double* r, double* z) const throw()
+	{
+		const int rows = matrix->rows;
+		const int* __restrict row_begin = matrix->row_begin.entry;
+		const int* __restrict column = matrix->column.entry;
+		const double* __restrict value = matrix->value.entry;
+		const int* __restrict d = diagonal.entry;
+		const double* __restrict s = scale.entry;
+
+		// (D/w + L)*y = r
+		for (register int i = 0; i < rows; ++i)
+		{
+			register double sum = r[i];
+			for (register int k = row_begin[i]; k < d[i]; ++k)
+			{
+				sum -= value[k]*z[column[k]];
+			}
+			z[i] = s[i]*sum;
+		}
+
+		// (D/w + L')*z = (D/w)*y, in place since z_i = y_i - (w/a_ii)*sum of a_ij*z_j for j > i
+		register double rz = 0;
+		for (register int i = rows - 1; i >= 0; --i)
+		{
+			register double sum = 0;
+			for (register int k = d[i] + 1; k < row_begin[i + 1]; ++k)
+			{
+				sum += value[k]*z[column[k]];
+			}
+			register double z_i = z[i] - s[i]*sum;
+			z[i] = z_i;
+			rz += r[i]*z_i;
+		}
+		return rz;
+	}
+
+
+	ConjugateGradientResult ConjugateGradient(const SparseMatrixCSR<double>& a, const Vector<double>& b, Vector<double>& x, const Preconditioner& preconditioner, double tolerance, int max_iterations, Log& log, LogLevel::ID level) throw(MemoryException, LogException)
+	{
+		Assert(a.rows == a.columns);
+		Assert(a.rows == b.size);
+		Assert(a.rows == x.size);
+		Assert(tolerance >= 0);
+
+		ConjugateGradientResult result;
+		result.iterations = 0;
+		result.residual = 0;
+		result.converged = false;
+		try
+		{
+			const int size = a.rows;
+			Vector<double> r(size);
+			Vector<double> z(size);
+			Vector<double> p(size);
+			Vector<double> q(size);
+			double* __restrict x_entry = x.entry;
+			double* __restrict r_entry = r.entry;
+			double* __restrict z_entry = z.entry;
+			double* __restrict p_entry = p.entry;
+			double* __restrict q_entry = q.entry;
+			const double* __restrict b_entry = b.entry;
+			const double* __restrict inverse_diagonal = preconditioner.InverseDiagonal();
+
+			// r = b - A*x
+			Spmv(-1.0, a, x_entry, 0.0, r_entry);
+			double bb = 0;
+			double rr = 0;
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) reduction(+: bb, rr) if (size >= PARALLEL_VECTOR_LIMIT)
+			#endif
+			for (int i = 0; i < size; ++i)
+			{
+				register double r_i = r_entry[i] + b_entry[i];
+				r_entry[i] = r_i;
+				bb += b_entry[i]*b_entry[i];
+				rr += r_i*r_i;
+			}
+			const double norm_b = (bb > 0) ? sqrt(bb) : 1.0;
+			result.residual = sqrt(rr)/norm_b;
+			log.Post(level, "CG iteration 0: residual %g", result.residual);
+
+			double rz = preconditioner.Apply(r_entry, z_entry);
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (size >= PARALLEL_VECTOR_LIMIT)
+			#endif
+			for (int i = 0; i < size; ++i)
+			{
+				p_entry[i] = z_entry[i];
+			}
+
+			while ((result.residual > tolerance) && (result.iterations < max_iterations))
+			{
+				const double pq = GrokInternal::ProductDot(a, p_entry, q_entry);
+				if (!(pq > 0))
+				{
+					log.Post(LogLevel::warning, "CG breakdown at iteration %i: p'*A*p = %g, the matrix is not positive definite", result.iterations, pq);
+					break;
+				}
+				const double alpha = rz/pq;
+
+				rr = 0;
+				double rz_new = 0;
+				if (inverse_diagonal)
+				{
+					#if defined(_OPENMP)
+						#pragma omp parallel for schedule(static) reduction(+: rr, rz_new) if (size >= PARALLEL_VECTOR_LIMIT)
+					#endif
+					for (int i = 0; i < size; ++i)
+					{
+						x_entry[i] += alpha*p_entry[i];
+						register double r_i = r_entry[i] - alpha*q_entry[i];
+						register double z_i = inverse_diagonal[i]*r_i;
+						r_entry[i] = r_i;
+						z_entry[i] = z_i;
+						rr += r_i*r_i;
+						rz_new += r_i*z_i;
+					}
+				}
+				else
+				{
+					#if defined(_OPENMP)
+						#pragma omp parallel for schedule(static) reduction(+: rr) if (size >= PARALLEL_VECTOR_LIMIT)
+					#endif
+					for (int i = 0; i < size; ++i)
+					{
+						x_entry[i] += alpha*p_entry[i];
+						register double r_i = r_entry[i] - alpha*q_entry[i];
+						r_entry[i] = r_i;
+						rr += r_i*r_i;
+					}
+				}
+				++result.iterations;
+				result.residual = sqrt(rr)/norm_b;
+				log.Post(level, "CG iteration %i: residual %g", result.iterations, result.residual);
+				if (result.residual <= tolerance)
+				{
+					break;
+				}
+				if (!inverse_diagonal)
+				{
+					rz_new = preconditioner.Apply(r_entry, z_entry);
+				}
+
+				const double beta = rz_new/rz;
+				rz = rz_new;
+				#if defined(_OPENMP)
+					#pragma omp parallel for schedule(static) if (size >= PARALLEL_VECTOR_LIMIT)
+				#endif
+				for (int i = 0; i < size; ++i)
+				{
+					p_entry[i] = z_entry[i] + beta*p_entry[i];
+				}
+			}
+			result.converged = (result.residual <= tolerance);
+			if (result.converged)
+			{
+				log.Post(LogLevel::success, "CG converged in %i iterations, residual %g", result.iterations, result.residual);
+			}
+			else
+			{
+				log.Post(LogLevel::warning, "CG stopped after %i iterations, residual %g", result.iterations, result.residual);
+			}
+		}
+		catch (Exception&)
+		{
+			ReThrow();
+		}
+		return result;
+	}
+}
@@ -0,0 +1,140 @@
+// ConjugateGradient.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Log.h>
+#include <Basic/Memory.h>
+#include <Container/CSRMatrix.h>
+#include <Container/Vector.h>
+#include <Math/LinearAlgebra.h>
+#include <Math/SparseCholesky.h>
+
+
+// Incomplete Cholesky retries with a larger diagonal shift at most this many times before throwing
+#if !defined(INCOMPLETE_CHOLESKY_SHIFTS)
+	#define INCOMPLETE_CHOLESKY_SHIFTS 32
+#endif
+
+
+namespace Grok
+{
+	// Preconditioner M of a symmetric positive-definite matrix for ConjugateGradient
+	struct Preconditioner
+	{
+		virtual ~Preconditioner() throw()
+		{
+		}
+
+
+		// z = M^-1*r, returns r·z computed in the same pass
+		virtual double Apply(const double* r, double* z) const throw() = 0;
+
+
+		// Diagonal preconditioners return M^-1 here, so the solver applies it inside its update pass
+		virtual const double* InverseDiagonal() const throw()
+		{
+			return static_cast<const double*>(0);
+		}
+	};
+
+
+	// M = diag(A)
+	struct JacobiPreconditioner : Preconditioner
+	{
+		Vector<double> inverse_diagonal;
+
+
+		JacobiPreconditioner(const SparseMatrixCSR<double>& a) throw(MemoryException);
+
+
+		virtual double Apply(const double* r, double* z) const throw();
+
+
+		virtual const double* InverseDiagonal() const throw()
+		{
+			return inverse_diagonal.entry;
+		}
+	};
+
+
+	// M = L*L' with L restricted to the pattern of the lower triangle of A, IC(0). When a pivot is not
+	// positive the factorization is restarted on A + shift*diag(A), doubling the shift each time
+	// (T. A. Manteuffel, An Incomplete Factorization Technique for Positive Definite Linear Systems.
+	// Mathematics of Computation, Vol. 34, No. 150. 1980). Only the lower triangle of A is read. Throws
+	// FactorizationException with the failing row when INCOMPLETE_CHOLESKY_SHIFTS attempts all fail.
+	struct IncompleteCholeskyPreconditioner : Preconditioner
+	{
+		// L by rows, the diagonal is the last entry of each row
+		SparseMatrixCSR<double> factor;
+
+		// Shift that made the factorization succeed, 0 when none was needed
+		double shift;
+
+
+		IncompleteCholeskyPreconditioner(const SparseMatrixCSR<double>& a) throw(MemoryException, FactorizationException);
+
+
+		// Triangular solves are sequential
+		virtual double Apply(const double* r, double* z) const throw();
+	};
+
+
+	// M = w/(2 - w)*(D/w + L)*(D/w)^-1*(D/w + L'), with D the diagonal and L the strict lower triangle
+	// of A, which must store both triangles. The constant w/(2 - w) is left out, CG iterates do not
+	// depend on the scale of M. The matrix is referenced, not copied.
+	struct SSORPreconditioner : Preconditioner
+	{
+		const SparseMatrixCSR<double>* matrix;
+
+		double omega;
+
+		// Position of a_ii in the entries of row i
+		Vector<int> diagonal;
+
+		// w/a_ii
+		Vector<double> scale;
+
+
+		SSORPreconditioner(const SparseMatrixCSR<double>& a, double omega = 1.0) throw(MemoryException);
+
+
+		// Triangular solves are sequential
+		virtual double Apply(const double* r, double* z) const throw();
+	};
+
+
+	struct ConjugateGradientResult
+	{
+		int iterations;
+
+		// |b - A*x|/|b|
+		double residual;
+
+		bool converged;
+	};
+
+
+	// Preconditioned conjugate gradient for a symmetric positive-definite A storing both triangles, x
+	// holds the initial guess and returns the solution. Stops when |b - A*x| <= tolerance*|b|. Every
+	// iteration makes three passes over memory: A*p fused with p·A*p, the x and r updates fused with r·r
+	// and r·z (and with z = M^-1*r for diagonal preconditioners), and the p update. Passes use OpenMP
+	// threads above PARALLEL_VECTOR_LIMIT entries (PARALLEL_PRODUCT_LIMIT for A*p). The residual of each
+	// iteration is posted to log with the given level, the final count with success or warning.
+	ConjugateGradientResult ConjugateGradient(const SparseMatrixCSR<double>& a, const Vector<double>& b, Vector<double>& x, const Preconditioner& preconditioner, double tolerance = 1e-8, int max_iterations = 10000, Log& log = message_log, LogLevel::ID level = LogLevel::debug) throw(MemoryException, LogException);
+}
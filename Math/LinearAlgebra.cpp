@@ -0,0 +1,971 @@
+// LinearAlgebra.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include <Math/LinearAlgebra.h>
+
+#if defined(_OPENMP)
+	#include <omp.h>
+#endif
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+
+namespace GrokInternal
+{
+	// Register traits for the kernels. The Gemm micro-kernel keeps a (rows) x (registers*lanes) tile of C
+	// in registers: 12 accumulators plus the loaded row of B and the broadcast entry of A fit the 16
+	// registers of x86-64.
+
+	#if defined(__AVX__)
+
+		struct KernelFloat
+		{
+			typedef float Scalar;
+			typedef __m256 Register;
+			enum {lanes = 8, rows = 6, registers = 2};
+
+			static inline Register Zero() throw()
+			{
+				return _mm256_setzero_ps();
+			}
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm256_loadu_ps(p);
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm256_storeu_ps(p, a);
+			}
+
+			static inline Register Broadcast(Scalar a) throw()
+			{
+				return _mm256_set1_ps(a);
+			}
+
+			static inline Register Add(Register a, Register b) throw()
+			{
+				return _mm256_add_ps(a, b);
+			}
+
+			// a*b + c
+			static inline Register MultiplyAdd(Register a, Register b, Register c) throw()
+			{
+				#if defined(__FMA__)
+					return _mm256_fmadd_ps(a, b, c);
+				#else
+					return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+				#endif
+			}
+
+			static inline Scalar Sum(Register a) throw()
+			{
+				register __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+				s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+				s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+				return _mm_cvtss_f32(s);
+			}
+
+			// Register with base[index[0]], ..., base[index[lanes - 1]]
+			static inline Register Gather(const Scalar* base, const int* index) throw()
+			{
+				#if defined(__AVX2__)
+					return _mm256_i32gather_ps(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index)), 4);
+				#else
+					return _mm256_set_ps(base[index[7]], base[index[6]], base[index[5]], base[index[4]], base[index[3]], base[index[2]], base[index[1]], base[index[0]]);
+				#endif
+			}
+		};
+
+
+		struct KernelDouble
+		{
+			typedef double Scalar;
+			typedef __m256d Register;
+			enum {lanes = 4, rows = 6, registers = 2};
+
+			static inline Register Zero() throw()
+			{
+				return _mm256_setzero_pd();
+			}
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm256_loadu_pd(p);
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm256_storeu_pd(p, a);
+			}
+
+			static inline Register Broadcast(Scalar a) throw()
+			{
+				return _mm256_set1_pd(a);
+			}
+
+			static inline Register Add(Register a, Register b) throw()
+			{
+				return _mm256_add_pd(a, b);
+			}
+
+			static inline Register MultiplyAdd(Register a, Register b, Register c) throw()
+			{
+				#if defined(__FMA__)
+					return _mm256_fmadd_pd(a, b, c);
+				#else
+					return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+				#endif
+			}
+
+			static inline Scalar Sum(Register a) throw()
+			{
+				register __m128d s = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+				s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+				return _mm_cvtsd_f64(s);
+			}
+
+			static inline Register Gather(const Scalar* base, const int* index) throw()
+			{
+				#if defined(__AVX2__)
+					return _mm256_i32gather_pd(base, _mm_loadu_si128(reinterpret_cast<const __m128i*>(index)), 8);
+				#else
+					return _mm256_set_pd(base[index[3]], base[index[2]], base[index[1]], base[index[0]]);
+				#endif
+			}
+		};
+
+	#elif defined(__SSE2__)
+
+		struct KernelFloat
+		{
+			typedef float Scalar;
+			typedef __m128 Register;
+			enum {lanes = 4, rows = 4, registers = 2};
+
+			static inline Register Zero() throw()
+			{
+				return _mm_setzero_ps();
+			}
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm_loadu_ps(p);
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm_storeu_ps(p, a);
+			}
+
+			static inline Register Broadcast(Scalar a) throw()
+			{
+				return _mm_set1_ps(a);
+			}
+
+			static inline Register Add(Register a, Register b) throw()
+			{
+				return _mm_add_ps(a, b);
+			}
+
+			static inline Register MultiplyAdd(Register a, Register b, Register c) throw()
+			{
+				return _mm_add_ps(_mm_mul_ps(a, b), c);
+			}
+
+			static inline Scalar Sum(Register a) throw()
+			{
+				register __m128 s = _mm_add_ps(a, _mm_movehl_ps(a, a));
+				s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+				return _mm_cvtss_f32(s);
+			}
+
+			static inline Register Gather(const Scalar* base, const int* index) throw()
+			{
+				return _mm_set_ps(base[index[3]], base[index[2]], base[index[1]], base[index[0]]);
+			}
+		};
+
+
+		struct KernelDouble
+		{
+			typedef double Scalar;
+			typedef __m128d Register;
+			enum {lanes = 2, rows = 4, registers = 2};
+
+			static inline Register Zero() throw()
+			{
+				return _mm_setzero_pd();
+			}
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return _mm_loadu_pd(p);
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				_mm_storeu_pd(p, a);
+			}
+
+			static inline Register Broadcast(Scalar a) throw()
+			{
+				return _mm_set1_pd(a);
+			}
+
+			static inline Register Add(Register a, Register b) throw()
+			{
+				return _mm_add_pd(a, b);
+			}
+
+			static inline Register MultiplyAdd(Register a, Register b, Register c) throw()
+			{
+				return _mm_add_pd(_mm_mul_pd(a, b), c);
+			}
+
+			static inline Scalar Sum(Register a) throw()
+			{
+				return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a)));
+			}
+
+			static inline Register Gather(const Scalar* base, const int* index) throw()
+			{
+				return _mm_set_pd(base[index[1]], base[index[0]]);
+			}
+		};
+
+	#else
+
+		template <typename TYPE>
+		struct KernelScalar
+		{
+			typedef TYPE Scalar;
+			typedef TYPE Register;
+			enum {lanes = 1, rows = 4, registers = 4};
+
+			static inline Register Zero() throw()
+			{
+				return 0;
+			}
+
+			static inline Register Load(const Scalar* p) throw()
+			{
+				return *p;
+			}
+
+			static inline void Store(Scalar* p, Register a) throw()
+			{
+				*p = a;
+			}
+
+			static inline Register Broadcast(Scalar a) throw()
+			{
+				return a;
+			}
+
+			static inline Register Add(Register a, Register b) throw()
+			{
+				return a + b;
+			}
+
+			static inline Register MultiplyAdd(Register a, Register b, Register c) throw()
+			{
+				return a*b + c;
+			}
+
+			static inline Scalar Sum(Register a) throw()
+			{
+				return a;
+			}
+
+			static inline Register Gather(const Scalar* base, const int* index) throw()
+			{
+				return base[*index];
+			}
+		};
+
+
+		typedef KernelScalar<float> KernelFloat;
+
+		typedef KernelScalar<double> KernelDouble;
+
+	#endif
+
+
+	const unsigned short packed_alignment = 64;
+
+
+	template <typename KERNEL>
+	typename KERNEL::Scalar DotKernel(int size, const typename KERNEL::Scalar* __restrict x, const typename KERNEL::Scalar* __restrict y) throw()
+	{
+		typedef typename KERNEL::Scalar Scalar;
+		typedef typename KERNEL::Register Register;
+		const int lanes = KERNEL::lanes;
+
+		// Four independent sums hide the latency of the additions
+		register Register sum_0 = KERNEL::Zero();
+		register Register sum_1 = KERNEL::Zero();
+		register Register sum_2 = KERNEL::Zero();
+		register Register sum_3 = KERNEL::Zero();
+		register int i = 0;
+		for (; i + 4*lanes <= size; i += 4*lanes)
+		{
+			sum_0 = KERNEL::MultiplyAdd(KERNEL::Load(x + i), KERNEL::Load(y + i), sum_0);
+			sum_1 = KERNEL::MultiplyAdd(KERNEL::Load(x + i + lanes), KERNEL::Load(y + i + lanes), sum_1);
+			sum_2 = KERNEL::MultiplyAdd(KERNEL::Load(x + i + 2*lanes), KERNEL::Load(y + i + 2*lanes), sum_2);
+			sum_3 = KERNEL::MultiplyAdd(KERNEL::Load(x + i + 3*lanes), KERNEL::Load(y + i + 3*lanes), sum_3);
+		}
+		for (; i + lanes <= size; i += lanes)
+		{
+			sum_0 = KERNEL::MultiplyAdd(KERNEL::Load(x + i), KERNEL::Load(y + i), sum_0);
+		}
+		register Scalar sum = KERNEL::Sum(KERNEL::Add(KERNEL::Add(sum_0, sum_1), KERNEL::Add(sum_2, sum_3)));
+		for (; i < size; ++i)
+		{
+			sum += x[i]*y[i];
+		}
+		return sum;
+	}
+
+
+	template <typename KERNEL>
+	void AxpyKernel(int size, typename KERNEL::Scalar alpha, const typename KERNEL::Scalar* __restrict x, typename KERNEL::Scalar* __restrict y) throw()
+	{
+		typedef typename KERNEL::Register Register;
+		const int lanes = KERNEL::lanes;
+
+		register Register alpha_r = KERNEL::Broadcast(alpha);
+		register int i = 0;
+		for (; i + 2*lanes <= size; i += 2*lanes)
+		{
+			KERNEL::Store(y + i, KERNEL::MultiplyAdd(alpha_r, KERNEL::Load(x + i), KERNEL::Load(y + i)));
+			KERNEL::Store(y + i + lanes, KERNEL::MultiplyAdd(alpha_r, KERNEL::Load(x + i + lanes), KERNEL::Load(y + i + lanes)));
+		}
+		for (; i < size; ++i)
+		{
+			y[i] += alpha*x[i];
+		}
+	}
+
+
+	template <typename KERNEL>
+	typename KERNEL::Scalar Dot(int size, const typename KERNEL::Scalar* x, const typename KERNEL::Scalar* y) throw()
+	{
+		typedef typename KERNEL::Scalar Scalar;
+
+		Assert(size >= 0);
+
+		#if defined(_OPENMP)
+			if (size >= PARALLEL_VECTOR_LIMIT)
+			{
+				const int chunks = omp_get_max_threads();
+				Scalar sum = 0;
+				#pragma omp parallel for schedule(static) reduction(+: sum)
+				for (int c = 0; c < chunks; ++c)
+				{
+					const int begin = static_cast<int>(static_cast<Grok::sint64>(size)*c/chunks);
+					const int end = static_cast<int>(static_cast<Grok::sint64>(size)*(c + 1)/chunks);
+					sum += DotKernel<KERNEL>(end - begin, x + begin, y + begin);
+				}
+				return sum;
+			}
+		#endif
+		return DotKernel<KERNEL>(size, x, y);
+	}
+
+
+	template <typename KERNEL>
+	void Axpy(int size, typename KERNEL::Scalar alpha, const typename KERNEL::Scalar* x, typename KERNEL::Scalar* y) throw()
+	{
+		Assert(size >= 0);
+
+		#if defined(_OPENMP)
+			if (size >= PARALLEL_VECTOR_LIMIT)
+			{
+				const int chunks = omp_get_max_threads();
+				#pragma omp parallel for schedule(static)
+				for (int c = 0; c < chunks; ++c)
+				{
+					const int begin = static_cast<int>(static_cast<Grok::sint64>(size)*c/chunks);
+					const int end = static_cast<int>(static_cast<Grok::sint64>(size)*(c + 1)/chunks);
+					AxpyKernel<KERNEL>(end - begin, alpha, x + begin, y + begin);
+				}
+				return;
+			}
+		#endif
+		AxpyKernel<KERNEL>(size, alpha, x, y);
+	}
+
+
+	template <typename KERNEL>
+	void Gemv(typename KERNEL::Scalar alpha, const Grok::MatrixView<const typename KERNEL::Scalar>& a, const typename KERNEL::Scalar* x, typename KERNEL::Scalar beta, typename KERNEL::Scalar* y) throw()
+	{
+		typedef typename KERNEL::Scalar Scalar;
+
+		Assert((a.rows >= 0) && (a.columns >= 0));
+		Assert((a.rows == 0) || (a.columns == 0) || a.entry);
+		Assert((a.columns == 0) || x);
+		Assert((a.rows == 0) || y);
+
+		const int rows = a.rows;
+		const int columns = a.columns;
+		const size_t leading = static_cast<size_t>(a.leading);
+		const bool parallel = static_cast<double>(rows)*static_cast<double>(columns) >= PARALLEL_PRODUCT_LIMIT;
+
+		if (a.layout == Grok::MatrixLayout::row_major)
+		{
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (parallel)
+			#endif
+			for (int i = 0; i < rows; ++i)
+			{
+				register Scalar product = alpha*DotKernel<KERNEL>(columns, a.entry + static_cast<size_t>(i)*leading, x);
+				y[i] = (beta == 0) ? product : product + beta*y[i];
+			}
+		}
+		else
+		{
+			// Each thread sweeps all the columns over its own block of y, which stays in cache
+			const int block_size = 1024;
+			const int blocks = (rows + block_size - 1)/block_size;
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (parallel)
+			#endif
+			for (int block = 0; block < blocks; ++block)
+			{
+				const int begin = block*block_size;
+				const int size = (rows - begin < block_size) ? rows - begin : block_size;
+				register Scalar* __restrict y_block = y + begin;
+				for (register int i = 0; i < size; ++i)
+				{
+					y_block[i] = (beta == 0) ? 0 : beta*y_block[i];
+				}
+				for (int j = 0; j < columns; ++j)
+				{
+					AxpyKernel<KERNEL>(size, alpha*x[j], a.entry + static_cast<size_t>(j)*leading + begin, y_block);
+				}
+			}
+		}
+	}
+
+
+	// Copies rows x depth of A into panels of KERNEL::rows rows, each stored column by column, padding
+	// the last panel with zeros
+	template <typename KERNEL>
+	void PackA(const typename KERNEL::Scalar* a, size_t row_stride, size_t column_stride, int rows, int depth, typename KERNEL::Scalar* __restrict packed) throw()
+	{
+		const int panel_rows = KERNEL::rows;
+
+		for (int i = 0; i < rows; i += panel_rows)
+		{
+			const int panel = (rows - i < panel_rows) ? rows - i : panel_rows;
+			const typename KERNEL::Scalar* a_i = a + static_cast<size_t>(i)*row_stride;
+			for (int p = 0; p < depth; ++p)
+			{
+				register const typename KERNEL::Scalar* a_ip = a_i + static_cast<size_t>(p)*column_stride;
+				register int r = 0;
+				for (; r < panel; ++r)
+				{
+					packed[r] = a_ip[static_cast<size_t>(r)*row_stride];
+				}
+				for (; r < panel_rows; ++r)
+				{
+					packed[r] = 0;
+				}
+				packed += panel_rows;
+			}
+		}
+	}
+
+
+	// Copies depth x columns of B (at most one panel of KERNEL::registers*KERNEL::lanes columns) row by
+	// row, padding with zeros
+	template <typename KERNEL>
+	void PackB(const typename KERNEL::Scalar* b, size_t row_stride, size_t column_stride, int depth, int columns, typename KERNEL::Scalar* __restrict packed) throw()
+	{
+		const int panel_columns = KERNEL::registers*KERNEL::lanes;
+
+		for (int p = 0; p < depth; ++p)
+		{
+			register const typename KERNEL::Scalar* b_p = b + static_cast<size_t>(p)*row_stride;
+			register int j = 0;
+			for (; j < columns; ++j)
+			{
+				packed[j] = b_p[static_cast<size_t>(j)*column_stride];
+			}
+			for (; j < panel_columns; ++j)
+			{
+				packed[j] = 0;
+			}
+			packed += panel_columns;
+		}
+	}
+
+
+	// C += alpha*A*B for one register tile, A and B packed. Partial tiles at the borders go through a
+	// buffer so the loop over depth is always the full one.
+	template <typename KERNEL>
+	inline void MicroKernel(int depth, const typename KERNEL::Scalar* __restrict a, const typename KERNEL::Scalar* __restrict b, typename KERNEL::Scalar alpha, typename KERNEL::Scalar* __restrict c, size_t leading, int rows, int columns) throw()
+	{
+		typedef typename KERNEL::Scalar Scalar;
+		typedef typename KERNEL::Register Register;
+		enum {lanes = KERNEL::lanes, tile_rows = KERNEL::rows, registers = KERNEL::registers, tile_columns = KERNEL::registers*KERNEL::lanes};
+
+		Register sum[tile_rows][registers];
+		for (register int r = 0; r < tile_rows; ++r)
+		{
+			for (register int v = 0; v < registers; ++v)
+			{
+				sum[r][v] = KERNEL::Zero();
+			}
+		}
+		for (register int p = 0; p < depth; ++p)
+		{
+			Register b_p[registers];
+			for (register int v = 0; v < registers; ++v)
+			{
+				b_p[v] = KERNEL::Load(b + v*lanes);
+			}
+			for (register int r = 0; r < tile_rows; ++r)
+			{
+				register Register a_r = KERNEL::Broadcast(a[r]);
+				for (register int v = 0; v < registers; ++v)
+				{
+					sum[r][v] = KERNEL::MultiplyAdd(a_r, b_p[v], sum[r][v]);
+				}
+			}
+			a += tile_rows;
+			b += tile_columns;
+		}
+
+		register Register alpha_r = KERNEL::Broadcast(alpha);
+		if ((rows == tile_rows) && (columns == tile_columns))
+		{
+			for (register int r = 0; r < tile_rows; ++r)
+			{
+				register Scalar* c_r = c + static_cast<size_t>(r)*leading;
+				for (register int v = 0; v < registers; ++v)
+				{
+					KERNEL::Store(c_r + v*lanes, KERNEL::MultiplyAdd(alpha_r, sum[r][v], KERNEL::Load(c_r + v*lanes)));
+				}
+			}
+		}
+		else
+		{
+			Scalar tile[tile_rows*tile_columns];
+			for (register int r = 0; r < tile_rows; ++r)
+			{
+				for (register int v = 0; v < registers; ++v)
+				{
+					KERNEL::Store(tile + r*tile_columns + v*lanes, sum[r][v]);
+				}
+			}
+			for (register int r = 0; r < rows; ++r)
+			{
+				register Scalar* c_r = c + static_cast<size_t>(r)*leading;
+				for (register int j = 0; j < columns; ++j)
+				{
+					c_r[j] += alpha*tile[r*tile_columns + j];
+				}
+			}
+		}
+	}
+
+
+	// Blocked product in the layout of K. Goto and R. van de Geijn, Anatomy of High-Performance Matrix
+	// Multiplication. ACM Transactions on Mathematical Software, Vol. 34, No. 3. 2008.
+	// For each GEMM_BLOCK_DEPTH slice, a panel of B is packed once and shared, then the threads take
+	// blocks of rows of A, pack them, and sweep the micro-kernel over the tiles of C.
+	template <typename KERNEL>
+	void Gemm(typename KERNEL::Scalar alpha, const Grok::MatrixView<const typename KERNEL::Scalar>& a, const Grok::MatrixView<const typename KERNEL::Scalar>& b, typename KERNEL::Scalar beta, const Grok::MatrixView<typename KERNEL::Scalar>& c) throw(Grok::MemoryException)
+	{
+		typedef typename KERNEL::Scalar Scalar;
+		const int tile_rows = KERNEL::rows;
+		const int tile_columns = KERNEL::registers*KERNEL::lanes;
+
+		Assert(a.rows == c.rows);
+		Assert(a.columns == b.rows);
+		Assert(b.columns == c.columns);
+
+		// A column-major C is the row-major C' = B'*A'
+		if (c.layout == Grok::MatrixLayout::column_major)
+		{
+			Gemm<KERNEL>(alpha, b.Transpose(), a.Transpose(), beta, c.Transpose());
+			return;
+		}
+
+		const int rows = c.rows;
+		const int columns = c.columns;
+		const int depth = a.columns;
+		const size_t leading = static_cast<size_t>(c.leading);
+		const bool parallel = static_cast<double>(rows)*static_cast<double>(columns)*static_cast<double>(depth) >= PARALLEL_PRODUCT_LIMIT;
+
+		if (beta != 1)
+		{
+			#if defined(_OPENMP)
+				#pragma omp parallel for schedule(static) if (parallel)
+			#endif
+			for (int i = 0; i < rows; ++i)
+			{
+				register Scalar* __restrict c_i = c.entry + static_cast<size_t>(i)*leading;
+				for (register int j = 0; j < columns; ++j)
+				{
+					c_i[j] = (beta == 0) ? 0 : beta*c_i[j];
+				}
+			}
+		}
+		if ((rows == 0) || (columns == 0) || (depth == 0) || (alpha == 0))
+		{
+			return;
+		}
+
+		const size_t a_row_stride = (a.layout == Grok::MatrixLayout::row_major) ? static_cast<size_t>(a.leading) : 1;
+		const size_t a_column_stride = (a.layout == Grok::MatrixLayout::row_major) ? 1 : static_cast<size_t>(a.leading);
+		const size_t b_row_stride = (b.layout == Grok::MatrixLayout::row_major) ? static_cast<size_t>(b.leading) : 1;
+		const size_t b_column_stride = (b.layout == Grok::MatrixLayout::row_major) ? 1 : static_cast<size_t>(b.leading);
+
+		int threads = 1;
+		#if defined(_OPENMP)
+			if (parallel)
+			{
+				threads = omp_get_max_threads();
+			}
+		#endif
+
+		// Smaller row blocks when there are not enough of them for all the threads
+		int block_rows = (GEMM_BLOCK_ROWS < tile_rows) ? tile_rows : GEMM_BLOCK_ROWS/tile_rows*tile_rows;
+		if (threads > 1)
+		{
+			register int thread_rows = ((rows + threads - 1)/threads + tile_rows - 1)/tile_rows*tile_rows;
+			if (thread_rows < block_rows)
+			{
+				block_rows = thread_rows;
+			}
+		}
+		const int block_depth = (depth < GEMM_BLOCK_DEPTH) ? depth : GEMM_BLOCK_DEPTH;
+		const int block_columns = (columns < GEMM_BLOCK_COLUMNS) ? columns : GEMM_BLOCK_COLUMNS;
+
+		Scalar* __restrict packed_a = new(packed_alignment) Scalar[static_cast<size_t>(threads)*static_cast<size_t>(block_rows)*static_cast<size_t>(block_depth)];
+		Scalar* __restrict packed_b = new(packed_alignment) Scalar[static_cast<size_t>((block_columns + tile_columns - 1)/tile_columns*tile_columns)*static_cast<size_t>(block_depth)];
+		if ((!packed_a) || (!packed_b))
+		{
+			delete [] packed_b;
+			delete [] packed_a;
+			Throw(Grok::MemoryException());
+		}
+
+		for (int jc = 0; jc < columns; jc += block_columns)
+		{
+			const int nc = (columns - jc < block_columns) ? columns - jc : block_columns;
+			const int column_panels = (nc + tile_columns - 1)/tile_columns;
+			for (int pc = 0; pc < depth; pc += block_depth)
+			{
+				const int kc = (depth - pc < block_depth) ? depth - pc : block_depth;
+				const int row_blocks = (rows + block_rows - 1)/block_rows;
+
+				#if defined(_OPENMP)
+					#pragma omp parallel num_threads(threads) if (threads > 1)
+				#endif
+				{
+					#if defined(_OPENMP)
+						#pragma omp for schedule(static)
+					#endif
+					for (int panel = 0; panel < column_panels; ++panel)
+					{
+						const int jr = panel*tile_columns;
+						PackB<KERNEL>(b.entry + static_cast<size_t>(pc)*b_row_stride + static_cast<size_t>(jc + jr)*b_column_stride, b_row_stride, b_column_stride, kc, (nc - jr < tile_columns) ? nc - jr : tile_columns, packed_b + static_cast<size_t>(jr)*static_cast<size_t>(kc));
+					}
+
+					#if defined(_OPENMP)
+						#pragma omp for schedule(static)
+					#endif
+					for (int block = 0; block < row_blocks; ++block)
+					{
+						#if defined(_OPENMP)
+							const int thread = omp_get_thread_num();
+						#else
+							const int thread = 0;
+						#endif
+
+						const int ic = block*block_rows;
+						const int mc = (rows - ic < block_rows) ? rows - ic : block_rows;
+						Scalar* __restrict packed_a_thread = packed_a + static_cast<size_t>(thread)*static_cast<size_t>(block_rows)*static_cast<size_t>(block_depth);
+						PackA<KERNEL>(a.entry + static_cast<size_t>(ic)*a_row_stride + static_cast<size_t>(pc)*a_column_stride, a_row_stride, a_column_stride, mc, kc, packed_a_thread);
+						for (int jr = 0; jr < nc; jr += tile_columns)
+						{
+							for (int ir = 0; ir < mc; ir += tile_rows)
+							{
+								MicroKernel<KERNEL>(kc, packed_a_thread + static_cast<size_t>(ir)*static_cast<size_t>(kc), packed_b + static_cast<size_t>(jr)*static_cast<size_t>(kc), alpha, c.entry + static_cast<size_t>(ic + ir)*leading + jc + jr, leading, (mc - ir < tile_rows) ? mc - ir : tile_rows, (nc - jr < tile_columns) ? nc - jr : tile_columns);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		delete [] packed_b;
+		delete [] packed_a;
+	}
+
+
+	// First part whose offset reaches target, offset holds parts + 1 nondecreasing entries
+	inline int LowerBound(const int* offset, int parts, int target) throw()
+	{
+		register int begin = 0;
+		register int end = parts;
+		while (begin < end)
+		{
+			register int middle = begin + (end - begin)/2;
+			if (offset[middle] < target)
+			{
+				begin = middle + 1;
+			}
+			else
+			{
+				end = middle;
+			}
+		}
+		return begin;
+	}
+
+
+	template <typename KERNEL>
+	void SpmvRows(typename KERNEL::Scalar alpha, const Grok::SparseMatrixCSR<typename KERNEL::Scalar>& a, const typename KERNEL::Scalar* __restrict x, typename KERNEL::Scalar beta, typename KERNEL::Scalar* __restrict y, int begin, int end) throw()
+	{
+		typedef typename KERNEL::Scalar Scalar;
+
+		const int* __restrict row_begin = a.row_begin.entry;
+		const int* __restrict column = a.column.entry;
+		const Scalar* __restrict value = a.value.entry;
+		for (int i = begin; i < end; ++i)
+		{
+			register int k = row_begin[i];
+			const int row_end = row_begin[i + 1];
+			register Scalar sum = 0;
+
+			// Hardware gathers pay off on long rows only, emulated ones never do
+			#if defined(__AVX2__)
+				typedef typename KERNEL::Register Register;
+				const int lanes = KERNEL::lanes;
+
+				if ((row_end - k >= SPMV_GATHER_LIMIT) && (row_end - k >= 2*lanes))
+				{
+					register Register sum_0 = KERNEL::Zero();
+					register Register sum_1 = KERNEL::Zero();
+					for (; k + 2*lanes <= row_end; k += 2*lanes)
+					{
+						sum_0 = KERNEL::MultiplyAdd(KERNEL::Load(value + k), KERNEL::Gather(x, column + k), sum_0);
+						sum_1 = KERNEL::MultiplyAdd(KERNEL::Load(value + k + lanes), KERNEL::Gather(x, column + k + lanes), sum_1);
+					}
+					sum = KERNEL::Sum(KERNEL::Add(sum_0, sum_1));
+				}
+			#endif
+
+			for (; k < row_end; ++k)
+			{
+				sum += value[k]*x[column[k]];
+			}
+			y[i] = (beta == 0) ? alpha*sum : alpha*sum + beta*y[i];
+		}
+	}
+
+
+	template <typename KERNEL>
+	void SpmvSlices(typename KERNEL::Scalar alpha, const Grok::SparseMatrixSELL<typename KERNEL::Scalar>& a, const typename KERNEL::Scalar* __restrict x, typename KERNEL::Scalar beta, typename KERNEL::Scalar* __restrict y, int begin, int end) throw()
+	{
+		typedef typename KERNEL::Scalar Scalar;
+		typedef typename KERNEL::Register Register;
+		const int lanes = KERNEL::lanes;
+
+		const int rows = a.rows;
+		const int chunk_size = a.chunk_size;
+		const int* __restrict slice_begin = a.slice_begin.entry;
+		const int* __restrict permutation = a.permutation.entry;
+		for (int s = begin; s < end; ++s)
+		{
+			const int width = (slice_begin[s + 1] - slice_begin[s])/chunk_size;
+			const int first = s*chunk_size;
+			const int slice_rows = (rows - first < chunk_size) ? rows - first : chunk_size;
+			const int* __restrict column_s = a.column.entry + slice_begin[s];
+			const Scalar* __restrict value_s = a.value.entry + slice_begin[s];
+			if (chunk_size % lanes == 0)
+			{
+				for (register int r = 0; r < slice_rows; r += lanes)
+				{
+					register Register sum = KERNEL::Zero();
+					for (register int k = 0; k < width; ++k)
+					{
+						sum = KERNEL::MultiplyAdd(KERNEL::Load(value_s + k*chunk_size + r), KERNEL::Gather(x, column_s + k*chunk_size + r), sum);
+					}
+					Scalar lane[lanes];
+					KERNEL::Store(lane, sum);
+					for (register int l = 0; (l < lanes) && (r + l < slice_rows); ++l)
+					{
+						register int i = permutation[first + r + l];
+						y[i] = (beta == 0) ? alpha*lane[l] : alpha*lane[l] + beta*y[i];
+					}
+				}
+			}
+			else
+			{
+				for (register int r = 0; r < slice_rows; ++r)
+				{
+					register Scalar sum = 0;
+					for (register int k = 0; k < width; ++k)
+					{
+						sum += value_s[k*chunk_size + r]*x[column_s[k*chunk_size + r]];
+					}
+					register int i = permutation[first + r];
+					y[i] = (beta == 0) ? alpha*sum : alpha*sum + beta*y[i];
+				}
+			}
+		}
+	}
+
+
+	template <typename KERNEL>
+	void Spmv(typename KERNEL::Scalar alpha, const Grok::SparseMatrixCSR<typename KERNEL::Scalar>& a, const typename KERNEL::Scalar* x, typename KERNEL::Scalar beta, typename KERNEL::Scalar* y) throw()
+	{
+		#if defined(_OPENMP)
+			const int nonzeros = a.NonZeros();
+			#pragma omp parallel if (nonzeros >= PARALLEL_PRODUCT_LIMIT)
+			{
+				const int threads = omp_get_num_threads();
+				const int thread = omp_get_thread_num();
+				int begin;
+				int end;
+				a.Partition(threads, thread, begin, end);
+				SpmvRows<KERNEL>(alpha, a, x, beta, y, begin, end);
+			}
+		#else
+			SpmvRows<KERNEL>(alpha, a, x, beta, y, 0, a.rows);
+		#endif
+	}
+
+
+	template <typename KERNEL>
+	void Spmv(typename KERNEL::Scalar alpha, const Grok::SparseMatrixSELL<typename KERNEL::Scalar>& a, const typename KERNEL::Scalar* x, typename KERNEL::Scalar beta, typename KERNEL::Scalar* y) throw()
+	{
+		#if defined(_OPENMP)
+			const int size = a.Size();
+			#pragma omp parallel if (size >= PARALLEL_PRODUCT_LIMIT)
+			{
+				const int threads = omp_get_num_threads();
+				const int thread = omp_get_thread_num();
+				const int begin = LowerBound(a.slice_begin.entry, a.slices, static_cast<int>(static_cast<Grok::sint64>(size)*thread/threads));
+				const int end = (thread == threads - 1) ? a.slices : LowerBound(a.slice_begin.entry, a.slices, static_cast<int>(static_cast<Grok::sint64>(size)*(thread + 1)/threads));
+				SpmvSlices<KERNEL>(alpha, a, x, beta, y, begin, end);
+			}
+		#else
+			SpmvSlices<KERNEL>(alpha, a, x, beta, y, 0, a.slices);
+		#endif
+	}
+}
+
+
+namespace Grok
+{
+	float Dot(int size, const float* x, const float* y) throw()
+	{
+		return GrokInternal::Dot<GrokInternal::KernelFloat>(size, x, y);
+	}
+
+
+	double Dot(int size, const double* x, const double* y) throw()
+	{
+		return GrokInternal::Dot<GrokInternal::KernelDouble>(size, x, y);
+	}
+
+
+	void Axpy(int size, float alpha, const float* x, float* y) throw()
+	{
+		GrokInternal::Axpy<GrokInternal::KernelFloat>(size, alpha, x, y);
+	}
+
+
+	void Axpy(int size, double alpha, const double* x, double* y) throw()
+	{
+		GrokInternal::Axpy<GrokInternal::KernelDouble>(size, alpha, x, y);
+	}
+
+
+	void Gemv(float alpha, const MatrixView<const float>& a, const float* x, float beta, float* y) throw()
+	{
+		GrokInternal::Gemv<GrokInternal::KernelFloat>(alpha, a, x, beta, y);
+	}
+
+
+	void Gemv(double alpha, const MatrixView<const double>& a, const double* x, double beta, double* y) throw()
+	{
+		GrokInternal::Gemv<GrokInternal::KernelDouble>(alpha, a, x, beta, y);
+	}
+
+
+	void Gemm(float alpha, const MatrixView<const float>& a, const MatrixView<const float>& b, float beta, const MatrixView<float>& c) throw(MemoryException)
+	{
+		try
+		{
+			GrokInternal::Gemm<GrokInternal::KernelFloat>(alpha, a, b, beta, c);
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	void Gemm(double alpha, const MatrixView<const double>& a, const MatrixView<const double>& b, double beta, const MatrixView<double>& c) throw(MemoryException)
+	{
+		try
+		{
+			GrokInternal::Gemm<GrokInternal::KernelDouble>(alpha, a, b, beta, c);
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	void Spmv(float alpha, const SparseMatrixCSR<float>& a, const float* x, float beta, float* y) throw()
+	{
+		GrokInternal::Spmv<GrokInternal::KernelFloat>(alpha, a, x, beta, y);
+	}
+
+
+	void Spmv(double alpha, const SparseMatrixCSR<double>& a, const double* x, double beta, double* y) throw()
+	{
+		GrokInternal::Spmv<GrokInternal::KernelDouble>(alpha, a, x, beta, y);
+	}
+
+
+	void Spmv(float alpha, const SparseMatrixSELL<float>& a, const float* x, float beta, float* y) throw()
+	{
+		GrokInternal::Spmv<GrokInternal::KernelFloat>(alpha, a, x, beta, y);
+	}
+
+
+	void Spmv(double alpha, const SparseMatrixSELL<double>& a, const double* x, double beta, double* y) throw()
+	{
+		GrokInternal::Spmv<GrokInternal::KernelDouble>(alpha, a, x, beta, y);
+	}
+}
@@ -0,0 +1,235 @@
+// LinearAlgebra.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Memory.h>
+#include <Container/CSRMatrix.h>
+#include <Container/DenseMatrix.h>
+#include <Container/Matrix.h>
+#include <Container/MatrixView.h>
+#include <Container/SELLMatrix.h>
+#include <Container/Vector.h>
+
+
+// Vectors shorter than this are processed by one thread
+#if !defined(PARALLEL_VECTOR_LIMIT)
+	#define PARALLEL_VECTOR_LIMIT 65536
+#endif
+
+// Products with fewer multiply-adds than this (stored entries for sparse matrices) are computed by one thread
+#if !defined(PARALLEL_PRODUCT_LIMIT)
+	#define PARALLEL_PRODUCT_LIMIT 262144
+#endif
+
+// Gemm cache blocking: a GEMM_BLOCK_ROWS x GEMM_BLOCK_DEPTH panel of A is sized for L2, a
+// GEMM_BLOCK_DEPTH x GEMM_BLOCK_COLUMNS panel of B for L3, see Benchmark/GemmBenchmark.cpp
+#if !defined(GEMM_BLOCK_ROWS)
+	#define GEMM_BLOCK_ROWS 96
+#endif
+
+#if !defined(GEMM_BLOCK_DEPTH)
+	#define GEMM_BLOCK_DEPTH 256
+#endif
+
+#if !defined(GEMM_BLOCK_COLUMNS)
+	#define GEMM_BLOCK_COLUMNS 2048
+#endif
+
+// Shortest CSR row that Spmv multiplies with AVX2 gathers, rows also need two registers of entries (8
+// double, 16 float), see Benchmark/SpmvBenchmark.cpp
+#if !defined(SPMV_GATHER_LIMIT)
+	#define SPMV_GATHER_LIMIT 8
+#endif
+
+
+// Dense kernels for float and double. They use AVX (with FMA when available) or SSE2 registers as the
+// build flags allow, and OpenMP threads above the PARALLEL_*_LIMIT sizes.
+namespace Grok
+{
+	// x·y
+	float Dot(int size, const float* x, const float* y) throw();
+
+
+	double Dot(int size, const double* x, const double* y) throw();
+
+
+	inline float Dot(const Vector<float>& x, const Vector<float>& y) throw()
+	{
+		Assert(x.size == y.size);
+
+		return Dot(x.size, x.entry, y.entry);
+	}
+
+
+	inline double Dot(const Vector<double>& x, const Vector<double>& y) throw()
+	{
+		Assert(x.size == y.size);
+
+		return Dot(x.size, x.entry, y.entry);
+	}
+
+
+	// y = alpha*x + y
+	void Axpy(int size, float alpha, const float* x, float* y) throw();
+
+
+	void Axpy(int size, double alpha, const double* x, double* y) throw();
+
+
+	inline void Axpy(float alpha, const Vector<float>& x, Vector<float>& y) throw()
+	{
+		Assert(x.size == y.size);
+
+		Axpy(x.size, alpha, x.entry, y.entry);
+	}
+
+
+	inline void Axpy(double alpha, const Vector<double>& x, Vector<double>& y) throw()
+	{
+		Assert(x.size == y.size);
+
+		Axpy(x.size, alpha, x.entry, y.entry);
+	}
+
+
+	// y = alpha*A*x + beta*y, with beta = 0 the previous y is ignored (even if it holds NaN). x holds
+	// a.columns entries and y a.rows.
+	void Gemv(float alpha, const MatrixView<const float>& a, const float* x, float beta, float* y) throw();
+
+
+	void Gemv(double alpha, const MatrixView<const double>& a, const double* x, double beta, double* y) throw();
+
+
+	inline void Gemv(float alpha, const Matrix<float>& a, const Vector<float>& x, float beta, Vector<float>& y) throw()
+	{
+		Assert(a.columns == x.size);
+		Assert(a.rows == y.size);
+
+		Gemv(alpha, a.View(), x.entry, beta, y.entry);
+	}
+
+
+	inline void Gemv(double alpha, const Matrix<double>& a, const Vector<double>& x, double beta, Vector<double>& y) throw()
+	{
+		Assert(a.columns == x.size);
+		Assert(a.rows == y.size);
+
+		Gemv(alpha, a.View(), x.entry, beta, y.entry);
+	}
+
+
+	inline void Gemv(float alpha, const DenseMatrix<float>& a, const Vector<float>& x, float beta, Vector<float>& y) throw()
+	{
+		Assert(a.columns == x.size);
+		Assert(a.rows == y.size);
+
+		Gemv(alpha, a.View(), x.entry, beta, y.entry);
+	}
+
+
+	inline void Gemv(double alpha, const DenseMatrix<double>& a, const Vector<double>& x, double beta, Vector<double>& y) throw()
+	{
+		Assert(a.columns == x.size);
+		Assert(a.rows == y.size);
+
+		Gemv(alpha, a.View(), x.entry, beta, y.entry);
+	}
+
+
+	// C = alpha*A*B + beta*C, any layout for each operand (transposed operands are passed as
+	// view.Transpose()). With beta = 0 the previous C is ignored. C must not overlap A or B.
+	void Gemm(float alpha, const MatrixView<const float>& a, const MatrixView<const float>& b, float beta, const MatrixView<float>& c) throw(MemoryException);
+
+
+	void Gemm(double alpha, const MatrixView<const double>& a, const MatrixView<const double>& b, double beta, const MatrixView<double>& c) throw(MemoryException);
+
+
+	inline void Gemm(float alpha, const Matrix<float>& a, const Matrix<float>& b, float beta, Matrix<float>& c) throw(MemoryException)
+	{
+		Gemm(alpha, a.View(), b.View(), beta, c.View());
+	}
+
+
+	inline void Gemm(double alpha, const Matrix<double>& a, const Matrix<double>& b, double beta, Matrix<double>& c) throw(MemoryException)
+	{
+		Gemm(alpha, a.View(), b.View(), beta, c.View());
+	}
+
+
+	inline void Gemm(float alpha, const DenseMatrix<float>& a, const DenseMatrix<float>& b, float beta, DenseMatrix<float>& c) throw(MemoryException)
+	{
+		Gemm(alpha, a.View(), b.View(), beta, c.View());
+	}
+
+
+	inline void Gemm(double alpha, const DenseMatrix<double>& a, const DenseMatrix<double>& b, double beta, DenseMatrix<double>& c) throw(MemoryException)
+	{
+		Gemm(alpha, a.View(), b.View(), beta, c.View());
+	}
+
+
+	// y = alpha*A*x + beta*y for sparse A, with beta = 0 the previous y is ignored. Threads take ranges of
+	// rows (slices for SELL) holding equal numbers of stored entries, not equal numbers of rows.
+	void Spmv(float alpha, const SparseMatrixCSR<float>& a, const float* x, float beta, float* y) throw();
+
+
+	void Spmv(double alpha, const SparseMatrixCSR<double>& a, const double* x, double beta, double* y) throw();
+
+
+	void Spmv(float alpha, const SparseMatrixSELL<float>& a, const float* x, float beta, float* y) throw();
+
+
+	void Spmv(double alpha, const SparseMatrixSELL<double>& a, const double* x, double beta, double* y) throw();
+
+
+	inline void Spmv(float alpha, const SparseMatrixCSR<float>& a, const Vector<float>& x, float beta, Vector<float>& y) throw()
+	{
+		Assert(a.columns == x.size);
+		Assert(a.rows == y.size);
+
+		Spmv(alpha, a, x.entry, beta, y.entry);
+	}
+
+
+	inline void Spmv(double alpha, const SparseMatrixCSR<double>& a, const Vector<double>& x, double beta, Vector<double>& y) throw()
+	{
+		Assert(a.columns == x.size);
+		Assert(a.rows == y.size);
+
+		Spmv(alpha, a, x.entry, beta, y.entry);
+	}
+
+
+	inline void Spmv(float alpha, const SparseMatrixSELL<float>& a, const Vector<float>& x, float beta, Vector<float>& y) throw()
+	{
+		Assert(a.columns == x.size);
+		Assert(a.rows == y.size);
+
+		Spmv(alpha, a, x.entry, beta, y.entry);
+	}
+
+
+	inline void Spmv(double alpha, const SparseMatrixSELL<double>& a, const Vector<double>& x, double beta, Vector<double>& y) throw()
+	{
+		Assert(a.columns == x.size);
+		Assert(a.rows == y.size);
+
+		Spmv(alpha, a, x.entry, beta, y.entry);
+	}
+}
@@ -0,0 +1,1052 @@
+// SparseCholesky.cpp
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#include <Math/SparseCholesky.h>
+#include <Math/LinearAlgebra.h>
+
+#include <math.h>
+
+
+namespace GrokInternal
+{
+	namespace MinimumDegreeStatus
+	{
+		enum ID
+		{
+			variable = 0,
+			element  = 1,
+			absorbed = 2,
+			dense    = 3
+		};
+	}
+
+
+	// Doubly linked lists of variables by degree
+	struct DegreeLists
+	{
+		Grok::Vector<int> head;
+
+		Grok::Vector<int> next;
+
+		Grok::Vector<int> previous;
+
+
+		DegreeLists(int size) throw(Grok::MemoryException)
+		:	head(size),
+			next(size),
+			previous(size)
+		{
+			head.Fill(-1);
+		}
+
+
+		inline void Insert(int i, int degree) throw()
+		{
+			register int first = head.entry[degree];
+			next.entry[i] = first;
+			previous.entry[i] = -1;
+			if (first != -1)
+			{
+				previous.entry[first] = i;
+			}
+			head.entry[degree] = i;
+		}
+
+
+		inline void Remove(int i, int degree) throw()
+		{
+			if (previous.entry[i] != -1)
+			{
+				next.entry[previous.entry[i]] = next.entry[i];
+			}
+			else
+			{
+				head.entry[degree] = next.entry[i];
+			}
+			if (next.entry[i] != -1)
+			{
+				previous.entry[next.entry[i]] = previous.entry[i];
+			}
+		}
+	};
+
+
+	// Strict lower triangle of P*A*P' by rows (in any column order), from the lower triangle of A
+	void PermutedLowerRows(const Grok::SparseMatrixCSR<double>& a, const int* __restrict inverse_permutation, Grok::Vector<int>& row_begin, Grok::Vector<int>& column) throw(Grok::MemoryException)
+	{
+		try
+		{
+			const int rows = a.rows;
+			row_begin.Resize(rows + 1);
+			row_begin.Fill(0);
+			for (register int i = 0; i < rows; ++i)
+			{
+				for (register int k = a.row_begin.entry[i]; (k < a.row_begin.entry[i + 1]) && (a.column.entry[k] < i); ++k)
+				{
+					register int x = inverse_permutation[i];
+					register int y = inverse_permutation[a.column.entry[k]];
+					++row_begin.entry[((x > y) ? x : y) + 1];
+				}
+			}
+			for (register int i = 0; i < rows; ++i)
+			{
+				row_begin.entry[i + 1] += row_begin.entry[i];
+			}
+			column.Resize(row_begin.entry[rows]);
+			Grok::Vector<int> next(rows);
+			for (register int i = 0; i < rows; ++i)
+			{
+				next.entry[i] = row_begin.entry[i];
+			}
+			for (register int i = 0; i < rows; ++i)
+			{
+				for (register int k = a.row_begin.entry[i]; (k < a.row_begin.entry[i + 1]) && (a.column.entry[k] < i); ++k)
+				{
+					register int x = inverse_permutation[i];
+					register int y = inverse_permutation[a.column.entry[k]];
+					if (x > y)
+					{
+						column.entry[next.entry[x]++] = y;
+					}
+					else
+					{
+						column.entry[next.entry[y]++] = x;
+					}
+				}
+			}
+		}
+		catch (Grok::MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	// J. W. H. Liu, A Compact Row Storage Scheme for Cholesky Factors Using Elimination Trees. ACM
+	// Transactions on Mathematical Software, Vol. 12, No. 2. 1986. Ancestors are path compressed.
+	void EliminationTree(int rows, const int* __restrict row_begin, const int* __restrict column, int* __restrict parent) throw(Grok::MemoryException)
+	{
+		try
+		{
+			Grok::Vector<int> ancestor(rows);
+			for (register int i = 0; i < rows; ++i)
+			{
+				parent[i] = -1;
+				ancestor.entry[i] = -1;
+				for (register int k = row_begin[i]; k < row_begin[i + 1]; ++k)
+				{
+					register int r = column[k];
+					while ((ancestor.entry[r] != -1) && (ancestor.entry[r] != i))
+					{
+						register int t = ancestor.entry[r];
+						ancestor.entry[r] = i;
+						r = t;
+					}
+					if (ancestor.entry[r] == -1)
+					{
+						ancestor.entry[r] = i;
+						parent[r] = i;
+					}
+				}
+			}
+		}
+		catch (Grok::MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	// Depth first postorder of the forest, children in increasing order
+	void Postorder(int rows, const int* __restrict parent, int* __restrict post) throw(Grok::MemoryException)
+	{
+		try
+		{
+			Grok::Vector<int> child(rows);
+			Grok::Vector<int> sibling(rows);
+			Grok::Vector<int> stack(rows);
+			child.Fill(-1);
+			for (register int j = rows - 1; j >= 0; --j)
+			{
+				if (parent[j] != -1)
+				{
+					sibling.entry[j] = child.entry[parent[j]];
+					child.entry[parent[j]] = j;
+				}
+			}
+			register int k = 0;
+			for (register int j = 0; j < rows; ++j)
+			{
+				if (parent[j] != -1)
+				{
+					continue;
+				}
+				register int top = 0;
+				stack.entry[0] = j;
+				while (top >= 0)
+				{
+					register int p = stack.entry[top];
+					register int c = child.entry[p];
+					if (c == -1)
+					{
+						--top;
+						post[k++] = p;
+					}
+					else
+					{
+						child.entry[p] = sibling.entry[c];
+						stack.entry[++top] = c;
+					}
+				}
+			}
+		}
+		catch (Grok::MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	// Entries (i, j) with i >= j of C = alpha*A*W' + beta*C, by blocks of CHOLESKY_BLOCK_COLUMNS columns
+	// so only the blocks crossing the diagonal compute entries above it
+	void LowerProduct(double alpha, const Grok::MatrixView<const double>& a, const Grok::MatrixView<const double>& w, double beta, const Grok::MatrixView<double>& c) throw(Grok::MemoryException)
+	{
+		Assert(c.rows >= c.columns);
+
+		try
+		{
+			for (register int j = 0; j < c.columns; j += CHOLESKY_BLOCK_COLUMNS)
+			{
+				register int columns = (c.columns - j < CHOLESKY_BLOCK_COLUMNS) ? c.columns - j : CHOLESKY_BLOCK_COLUMNS;
+				Grok::Gemm(alpha, a.View(j, 0, a.rows - j, a.columns), w.View(j, 0, columns, w.columns).Transpose(), beta, c.View(j, j, c.rows - j, columns));
+			}
+		}
+		catch (Grok::MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	inline void Append(Grok::Vector<int>& list, int& size, int value) throw(Grok::MemoryException)
+	{
+		if (size == list.size)
+		{
+			Grok::Vector<int> grown((size < 2) ? 4 : 2*size);
+			for (register int k = 0; k < size; ++k)
+			{
+				grown.entry[k] = list.entry[k];
+			}
+			list.Swap(grown);
+		}
+		list.entry[size++] = value;
+	}
+}
+
+
+namespace Grok
+{
+	void ApproximateMinimumDegree(const SparseMatrixCSR<double>& a, Vector<int>& permutation) throw(MemoryException)
+	{
+		using namespace GrokInternal::MinimumDegreeStatus;
+
+		Assert(a.rows == a.columns);
+
+		try
+		{
+			const int n = a.rows;
+			permutation.Resize(n);
+			if (n == 0)
+			{
+				return;
+			}
+
+			// Symmetric graph without the diagonal, variable i is adjacent to the variables in
+			// adjacency[adjacency_begin[i]..+adjacency_size[i]) (pruned as elements cover them)
+			Vector<int> adjacency_begin(n + 1);
+			Vector<int> adjacency_size(n);
+			adjacency_size.Fill(0);
+			for (register int i = 0; i < n; ++i)
+			{
+				for (register int k = a.row_begin.entry[i]; (k < a.row_begin.entry[i + 1]) && (a.column.entry[k] < i); ++k)
+				{
+					++adjacency_size.entry[i];
+					++adjacency_size.entry[a.column.entry[k]];
+				}
+			}
+			adjacency_begin.entry[0] = 0;
+			for (register int i = 0; i < n; ++i)
+			{
+				adjacency_begin.entry[i + 1] = adjacency_begin.entry[i] + adjacency_size.entry[i];
+				adjacency_size.entry[i] = 0;
+			}
+			Vector<int> adjacency(adjacency_begin.entry[n]);
+			for (register int i = 0; i < n; ++i)
+			{
+				for (register int k = a.row_begin.entry[i]; (k < a.row_begin.entry[i + 1]) && (a.column.entry[k] < i); ++k)
+				{
+					register int j = a.column.entry[k];
+					adjacency.entry[adjacency_begin.entry[i] + adjacency_size.entry[i]++] = j;
+					adjacency.entry[adjacency_begin.entry[j] + adjacency_size.entry[j]++] = i;
+				}
+			}
+
+			Vector<int> status(n);
+			const int dense_limit = (10.0*sqrt(static_cast<double>(n)) > 16.0) ? static_cast<int>(10.0*sqrt(static_cast<double>(n))) : 16;
+			register int variables = 0;
+			for (register int i = 0; i < n; ++i)
+			{
+				if (adjacency_size.entry[i] > dense_limit)
+				{
+					status.entry[i] = dense;
+				}
+				else
+				{
+					status.entry[i] = variable;
+					++variables;
+				}
+			}
+			Vector<int> degree(n);
+			GrokInternal::DegreeLists lists(n);
+			for (register int i = 0; i < n; ++i)
+			{
+				if (status.entry[i] == variable)
+				{
+					register int d = 0;
+					for (register int t = adjacency_begin.entry[i]; t < adjacency_begin.entry[i] + adjacency_size.entry[i]; ++t)
+					{
+						d += (status.entry[adjacency.entry[t]] == variable);
+					}
+					degree.entry[i] = d;
+					lists.Insert(i, d);
+				}
+			}
+
+			// Elements adjacent to each variable, and variables of each element
+			Vector<Vector<int> > adjacent_element(n);
+			Vector<int> adjacent_element_size(n);
+			adjacent_element_size.Fill(0);
+			Vector<Vector<int> > member(n);
+			Vector<int> member_size(n);
+			member_size.Fill(0);
+
+			Vector<int> mark(n);
+			mark.Fill(-1);
+			Vector<int> weight(n);
+			Vector<int> weight_mark(n);
+			weight_mark.Fill(-1);
+
+			register int minimum = 0;
+			for (register int k = 0; k < variables; ++k)
+			{
+				while (lists.head.entry[minimum] == -1)
+				{
+					++minimum;
+				}
+				const int p = lists.head.entry[minimum];
+				lists.Remove(p, minimum);
+				permutation.entry[k] = p;
+				status.entry[p] = element;
+
+				// Lp, the variables adjacent to p or to its elements, which p absorbs
+				register int bound = adjacency_size.entry[p];
+				for (register int t = 0; t < adjacent_element_size.entry[p]; ++t)
+				{
+					bound += member_size.entry[adjacent_element.entry[p].entry[t]];
+				}
+				Vector<int>& lp = member.entry[p];
+				lp.Resize(bound);
+				register int lp_size = 0;
+				mark.entry[p] = k;
+				for (register int t = adjacency_begin.entry[p]; t < adjacency_begin.entry[p] + adjacency_size.entry[p]; ++t)
+				{
+					register int v = adjacency.entry[t];
+					if ((status.entry[v] == variable) && (mark.entry[v] != k))
+					{
+						mark.entry[v] = k;
+						lp.entry[lp_size++] = v;
+					}
+				}
+				for (register int t = 0; t < adjacent_element_size.entry[p]; ++t)
+				{
+					register int e = adjacent_element.entry[p].entry[t];
+					if (status.entry[e] != element)
+					{
+						continue;
+					}
+					for (register int u = 0; u < member_size.entry[e]; ++u)
+					{
+						register int v = member.entry[e].entry[u];
+						if (mark.entry[v] != k)
+						{
+							mark.entry[v] = k;
+							lp.entry[lp_size++] = v;
+						}
+					}
+					status.entry[e] = absorbed;
+					member.entry[e].Resize(0);
+					member_size.entry[e] = 0;
+				}
+				member_size.entry[p] = lp_size;
+				adjacency_size.entry[p] = 0;
+				adjacent_element.entry[p].Resize(0);
+				adjacent_element_size.entry[p] = 0;
+
+				// Variables of Lp drop the neighbours now covered by p and the elements absorbed by p
+				for (register int t = 0; t < lp_size; ++t)
+				{
+					register int i = lp.entry[t];
+					lists.Remove(i, degree.entry[i]);
+					register int size = 0;
+					for (register int u = adjacency_begin.entry[i]; u < adjacency_begin.entry[i] + adjacency_size.entry[i]; ++u)
+					{
+						register int v = adjacency.entry[u];
+						if ((status.entry[v] == variable) && (mark.entry[v] != k))
+						{
+							adjacency.entry[adjacency_begin.entry[i] + size++] = v;
+						}
+					}
+					adjacency_size.entry[i] = size;
+					size = 0;
+					int* __restrict element_i = adjacent_element.entry[i].entry;
+					for (register int u = 0; u < adjacent_element_size.entry[i]; ++u)
+					{
+						if (status.entry[element_i[u]] == element)
+						{
+							element_i[size++] = element_i[u];
+						}
+					}
+					adjacent_element_size.entry[i] = size;
+				}
+
+				// weight[e] = |Le \ Lp| for the other elements of the variables of Lp
+				for (register int t = 0; t < lp_size; ++t)
+				{
+					register int i = lp.entry[t];
+					for (register int u = 0; u < adjacent_element_size.entry[i]; ++u)
+					{
+						register int e = adjacent_element.entry[i].entry[u];
+						if (weight_mark.entry[e] != k)
+						{
+							weight_mark.entry[e] = k;
+							weight.entry[e] = member_size.entry[e];
+						}
+						--weight.entry[e];
+					}
+				}
+
+				// Approximate external degrees, elements inside Lp are absorbed by p
+				const int remaining = variables - k - 1;
+				for (register int t = 0; t < lp_size; ++t)
+				{
+					register int i = lp.entry[t];
+					register int d = adjacency_size.entry[i] + lp_size - 1;
+					register int size = 0;
+					int* __restrict element_i = adjacent_element.entry[i].entry;
+					for (register int u = 0; u < adjacent_element_size.entry[i]; ++u)
+					{
+						register int e = element_i[u];
+						if (status.entry[e] != element)
+						{
+							continue;
+						}
+						if (weight.entry[e] == 0)
+						{
+							status.entry[e] = absorbed;
+							member.entry[e].Resize(0);
+							member_size.entry[e] = 0;
+							continue;
+						}
+						d += weight.entry[e];
+						element_i[size++] = e;
+					}
+					adjacent_element_size.entry[i] = size;
+					GrokInternal::Append(adjacent_element.entry[i], adjacent_element_size.entry[i], p);
+
+					if (d > degree.entry[i] + lp_size - 1)
+					{
+						d = degree.entry[i] + lp_size - 1;
+					}
+					if (d > remaining - 1)
+					{
+						d = remaining - 1;
+					}
+					if (d < 0)
+					{
+						d = 0;
+					}
+					degree.entry[i] = d;
+					lists.Insert(i, d);
+					if (d < minimum)
+					{
+						minimum = d;
+					}
+				}
+			}
+
+			register int k = variables;
+			for (register int i = 0; i < n; ++i)
+			{
+				if (status.entry[i] == dense)
+				{
+					permutation.entry[k++] = i;
+				}
+			}
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	SparseCholesky::SparseCholesky(const SparseMatrixCSR<double>& a) throw(MemoryException)
+	:	rows(0),
+		supernodes(0),
+		permutation(),
+		inverse_permutation(),
+		parent(),
+		supernode_of(),
+		supernode_begin(),
+		structure_begin(),
+		structure(),
+		block(),
+		diagonal(),
+		pivot_tolerance(CHOLESKY_PIVOT_TOLERANCE),
+		assembly(),
+		position(),
+		link_head(),
+		link_next(),
+		next_row(),
+		scaled(),
+		update()
+	{
+		try
+		{
+			Analyze(a);
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	void SparseCholesky::Analyze(const SparseMatrixCSR<double>& a) throw(MemoryException)
+	{
+		try
+		{
+			Vector<int> ordering;
+			ApproximateMinimumDegree(a, ordering);
+			Analyze(a, ordering);
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	void SparseCholesky::Analyze(const SparseMatrixCSR<double>& a, const Vector<int>& ordering) throw(MemoryException)
+	{
+		Assert(a.rows == a.columns);
+		Assert(ordering.size == a.rows);
+
+		try
+		{
+			const int n = a.rows;
+			rows = 0;
+			supernodes = 0;
+
+			// The elimination tree is postordered, so every subtree and every supernode gets consecutive
+			// columns, then the tree of the final ordering is built again
+			inverse_permutation.Resize(n);
+			for (register int k = 0; k < n; ++k)
+			{
+				inverse_permutation.entry[ordering.entry[k]] = k;
+			}
+			Vector<int> lower_begin;
+			Vector<int> lower_column;
+			GrokInternal::PermutedLowerRows(a, inverse_permutation.entry, lower_begin, lower_column);
+			parent.Resize(n);
+			GrokInternal::EliminationTree(n, lower_begin.entry, lower_column.entry, parent.entry);
+			Vector<int> post(n);
+			GrokInternal::Postorder(n, parent.entry, post.entry);
+			permutation.Resize(n);
+			for (register int k = 0; k < n; ++k)
+			{
+				permutation.entry[k] = ordering.entry[post.entry[k]];
+			}
+			for (register int k = 0; k < n; ++k)
+			{
+				inverse_permutation.entry[permutation.entry[k]] = k;
+			}
+			GrokInternal::PermutedLowerRows(a, inverse_permutation.entry, lower_begin, lower_column);
+			GrokInternal::EliminationTree(n, lower_begin.entry, lower_column.entry, parent.entry);
+
+			// Column counts of L: the nonzeros of row i are the subtree of the etree spanned by the
+			// nonzeros of row i of A
+			Vector<int> count(n);
+			Vector<int> mark(n);
+			count.Fill(1);
+			mark.Fill(-1);
+			for (register int i = 0; i < n; ++i)
+			{
+				mark.entry[i] = i;
+				for (register int k = lower_begin.entry[i]; k < lower_begin.entry[i + 1]; ++k)
+				{
+					for (register int r = lower_column.entry[k]; mark.entry[r] != i; r = parent.entry[r])
+					{
+						++count.entry[r];
+						mark.entry[r] = i;
+					}
+				}
+			}
+
+			// Supernodes: j joins the supernode of j - 1 when it is the parent of j - 1 and the explicit zeros
+			// stored this way are few. Fundamental supernodes (j - 1 the only child of j, with the structure of
+			// j plus the diagonal) add none; otherwise the relaxation uses the CHOLMOD thresholds: any zeros up
+			// to 4 columns, 80% of the entries up to 16 columns, 10% up to 48 and 5% beyond.
+			supernode_of.Resize(n);
+			register int s = -1;
+			register int first = 0;
+			register double nonzeros = 0;
+			for (register int j = 0; j < n; ++j)
+			{
+				register bool join = false;
+				if ((j > 0) && (parent.entry[j - 1] == j))
+				{
+					register double width = j - first + 1;
+					register double height = width + count.entry[j] - 1;
+					register double stored = width*height - width*(width - 1)/2;
+					register double zeros = (stored - nonzeros - count.entry[j])/stored;
+					join = (width <= 4) || ((width <= 16) && (zeros < 0.8)) || ((width <= 48) && (zeros < 0.1)) || (zeros < 0.05);
+				}
+				if (!join)
+				{
+					++s;
+					first = j;
+					nonzeros = 0;
+				}
+				nonzeros += count.entry[j];
+				supernode_of.entry[j] = s;
+			}
+
+			// The structure of a supernode is its columns plus the structure of its last column
+			const int supernodes = s + 1;
+			supernode_begin.Resize(supernodes + 1);
+			structure_begin.Resize(supernodes + 1);
+			register int size = 0;
+			for (register int j = 0; j < n; ++j)
+			{
+				if ((j == 0) || (supernode_of.entry[j] != supernode_of.entry[j - 1]))
+				{
+					supernode_begin.entry[supernode_of.entry[j]] = j;
+					structure_begin.entry[supernode_of.entry[j]] = size;
+				}
+				if ((j == n - 1) || (supernode_of.entry[j] != supernode_of.entry[j + 1]))
+				{
+					size += j - supernode_begin.entry[supernode_of.entry[j]] + count.entry[j];
+				}
+			}
+			supernode_begin.entry[supernodes] = n;
+			structure_begin.entry[supernodes] = size;
+
+			// Row structures, rows are visited in increasing order so they come out sorted
+			structure.Resize(size);
+			Vector<int> next(supernodes);
+			Vector<int> supernode_mark(supernodes);
+			for (s = 0; s < supernodes; ++s)
+			{
+				next.entry[s] = structure_begin.entry[s];
+				supernode_mark.entry[s] = -1;
+			}
+			mark.Fill(-1);
+			for (register int i = 0; i < n; ++i)
+			{
+				mark.entry[i] = i;
+				supernode_mark.entry[supernode_of.entry[i]] = i;
+				structure.entry[next.entry[supernode_of.entry[i]]++] = i;
+				for (register int k = lower_begin.entry[i]; k < lower_begin.entry[i + 1]; ++k)
+				{
+					for (register int r = lower_column.entry[k]; mark.entry[r] != i; r = parent.entry[r])
+					{
+						mark.entry[r] = i;
+						register int t = supernode_of.entry[r];
+						if (supernode_mark.entry[t] != i)
+						{
+							supernode_mark.entry[t] = i;
+							structure.entry[next.entry[t]++] = i;
+						}
+					}
+				}
+			}
+
+			register int max_size = 0;
+			register int max_width = 0;
+			block.Resize(supernodes);
+			for (s = 0; s < supernodes; ++s)
+			{
+				Assert(next.entry[s] == structure_begin.entry[s + 1]);
+
+				register int size_s = structure_begin.entry[s + 1] - structure_begin.entry[s];
+				register int width_s = supernode_begin.entry[s + 1] - supernode_begin.entry[s];
+				block.entry[s].Resize(size_s, width_s);
+				max_size = (size_s > max_size) ? size_s : max_size;
+				max_width = (width_s > max_width) ? width_s : max_width;
+			}
+			diagonal.Resize(n);
+
+			// Where each entry of the lower triangle of A lands
+			assembly.Resize(a.NonZeros());
+			for (register int i = 0; i < n; ++i)
+			{
+				for (register int k = a.row_begin.entry[i]; k < a.row_begin.entry[i + 1]; ++k)
+				{
+					register int j = a.column.entry[k];
+					if (j > i)
+					{
+						assembly.entry[k] = static_cast<double*>(0);
+						continue;
+					}
+					register int x = inverse_permutation.entry[i];
+					register int y = inverse_permutation.entry[j];
+					register int row = (x > y) ? x : y;
+					register int column = (x > y) ? y : x;
+					register int t = supernode_of.entry[column];
+					register int begin = structure_begin.entry[t];
+					register int end = structure_begin.entry[t + 1];
+					while (begin < end)
+					{
+						register int middle = begin + (end - begin)/2;
+						if (structure.entry[middle] < row)
+						{
+							begin = middle + 1;
+						}
+						else
+						{
+							end = middle;
+						}
+					}
+
+					Assert(structure.entry[begin] == row);
+
+					assembly.entry[k] = &block.entry[t].entry[begin - structure_begin.entry[t]][column - supernode_begin.entry[t]];
+				}
+			}
+
+			position.Resize(n);
+			link_head.Resize(supernodes);
+			link_next.Resize(supernodes);
+			next_row.Resize(supernodes);
+			scaled.Resize(max_width, max_width);
+			update.Resize(max_size, max_width);
+
+			this->rows = n;
+			this->supernodes = supernodes;
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	void SparseCholesky::Factorize(const SparseMatrixCSR<double>& a) throw(MemoryException, FactorizationException)
+	{
+		Assert(a.rows == rows);
+		Assert(a.NonZeros() == assembly.size);
+
+		try
+		{
+			for (register int s = 0; s < supernodes; ++s)
+			{
+				block.entry[s].Fill(0.0);
+			}
+			const int nonzeros = a.NonZeros();
+			for (register int k = 0; k < nonzeros; ++k)
+			{
+				if (assembly.entry[k])
+				{
+					*assembly.entry[k] += a.value.entry[k];
+				}
+			}
+			register double largest = 0;
+			for (register int i = 0; i < rows; ++i)
+			{
+				for (register int k = a.row_begin.entry[i]; k < a.row_begin.entry[i + 1]; ++k)
+				{
+					if ((a.column.entry[k] == i) && (fabs(a.value.entry[k]) > largest))
+					{
+						largest = fabs(a.value.entry[k]);
+					}
+				}
+			}
+			const double smallest_pivot = pivot_tolerance*largest;
+
+			// Supernode d waits in the list of the supernode that holds its row next_row[d], the first one
+			// it has not updated yet
+			link_head.Fill(-1);
+			for (int s = 0; s < supernodes; ++s)
+			{
+				const int first = supernode_begin.entry[s];
+				const int width = supernode_begin.entry[s + 1] - first;
+				const int size = structure_begin.entry[s + 1] - structure_begin.entry[s];
+				const int* __restrict row = structure.entry + structure_begin.entry[s];
+				double** __restrict b = block.entry[s].entry;
+				for (register int r = 0; r < size; ++r)
+				{
+					position.entry[row[r]] = r;
+				}
+
+				register int d = link_head.entry[s];
+				while (d != -1)
+				{
+					const int next_d = link_next.entry[d];
+					const int first_d = supernode_begin.entry[d];
+					const int width_d = supernode_begin.entry[d + 1] - first_d;
+					const int size_d = structure_begin.entry[d + 1] - structure_begin.entry[d];
+					const int* __restrict row_d = structure.entry + structure_begin.entry[d];
+					double** __restrict l_d = block.entry[d].entry;
+					const double* __restrict diagonal_d = diagonal.entry + first_d;
+					const int p = next_row.entry[d];
+					register int q = p + 1;
+					while ((q < size_d) && (row_d[q] < first + width))
+					{
+						++q;
+					}
+
+					// Rows [p, q) of L_d scaled by D_d, then the update L_d[p:, :]*D_d*L_d[p:q, :]'
+					for (register int c = 0; c < q - p; ++c)
+					{
+						const double* __restrict l_c = l_d[p + c];
+						double* __restrict scaled_c = scaled.entry[c];
+						for (register int t = 0; t < width_d; ++t)
+						{
+							scaled_c[t] = l_c[t]*diagonal_d[t];
+						}
+					}
+					if (static_cast<double>(size_d - p)*static_cast<double>(q - p)*static_cast<double>(width_d) >= CHOLESKY_GEMM_LIMIT)
+					{
+						GrokInternal::LowerProduct(1.0, block.entry[d].View(p, 0, size_d - p, width_d), scaled.View(0, 0, q - p, width_d), 0.0, update.View(0, 0, size_d - p, q - p));
+						for (register int r = 0; r < size_d - p; ++r)
+						{
+							double* __restrict b_r = b[position.entry[row_d[p + r]]];
+							const double* __restrict update_r = update.entry[r];
+							for (register int c = 0; (c <= r) && (c < q - p); ++c)
+							{
+								b_r[row_d[p + c] - first] -= update_r[c];
+							}
+						}
+					}
+					else
+					{
+						for (register int r = 0; r < size_d - p; ++r)
+						{
+							double* __restrict b_r = b[position.entry[row_d[p + r]]];
+							const double* __restrict l_r = l_d[p + r];
+							for (register int c = 0; (c <= r) && (c < q - p); ++c)
+							{
+								const double* __restrict scaled_c = scaled.entry[c];
+								register double sum = 0;
+								for (register int t = 0; t < width_d; ++t)
+								{
+									sum += l_r[t]*scaled_c[t];
+								}
+								b_r[row_d[p + c] - first] -= sum;
+							}
+						}
+					}
+
+					next_row.entry[d] = q;
+					if (q < size_d)
+					{
+						register int t = supernode_of.entry[row_d[q]];
+						link_next.entry[d] = link_head.entry[t];
+						link_head.entry[t] = d;
+					}
+					d = next_d;
+				}
+
+				// Dense LDL' of the block by panels of CHOLESKY_BLOCK_COLUMNS columns, each panel column by
+				// column, then the columns right of the panel are updated with Gemm
+				for (register int panel = 0; panel < width; panel += CHOLESKY_BLOCK_COLUMNS)
+				{
+					const int panel_end = (width - panel < CHOLESKY_BLOCK_COLUMNS) ? width : panel + CHOLESKY_BLOCK_COLUMNS;
+					double* __restrict v = scaled.entry[0];
+					for (register int j = panel; j < panel_end; ++j)
+					{
+						double* __restrict b_j = b[j];
+						register double pivot = b_j[j];
+						for (register int t = panel; t < j; ++t)
+						{
+							v[t] = b_j[t]*diagonal.entry[first + t];
+							pivot -= b_j[t]*v[t];
+						}
+						if (!(fabs(pivot) > smallest_pivot))
+						{
+							Throw(FactorizationException(first + j));
+						}
+						diagonal.entry[first + j] = pivot;
+						b_j[j] = 1;
+						const double inverse = 1.0/pivot;
+						#if defined(_OPENMP)
+							#pragma omp parallel for schedule(static) if ((size - j)*(j - panel) >= PARALLEL_VECTOR_LIMIT)
+						#endif
+						for (int i = j + 1; i < size; ++i)
+						{
+							double* __restrict b_i = b[i];
+							register double sum = b_i[j];
+							for (register int t = panel; t < j; ++t)
+							{
+								sum -= b_i[t]*v[t];
+							}
+							b_i[j] = sum*inverse;
+						}
+					}
+
+					// Lower part of B[panel_end:, panel_end:width] -= L[panel_end:, panel]*D*L[panel_end:width, panel]'
+					if (panel_end < width)
+					{
+						const int panel_width = panel_end - panel;
+						for (register int c = 0; c < width - panel_end; ++c)
+						{
+							const double* __restrict l_c = b[panel_end + c] + panel;
+							double* __restrict scaled_c = scaled.entry[c];
+							for (register int t = 0; t < panel_width; ++t)
+							{
+								scaled_c[t] = l_c[t]*diagonal.entry[first + panel + t];
+							}
+						}
+						GrokInternal::LowerProduct(-1.0, block.entry[s].View(panel_end, panel, size - panel_end, panel_width), scaled.View(0, 0, width - panel_end, panel_width), 1.0, block.entry[s].View(panel_end, panel_end, size - panel_end, width - panel_end));
+					}
+				}
+
+				if (size > width)
+				{
+					next_row.entry[s] = width;
+					register int t = supernode_of.entry[row[width]];
+					link_next.entry[s] = link_head.entry[t];
+					link_head.entry[t] = s;
+				}
+			}
+		}
+		catch (Exception&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	void SparseCholesky::Solve(const Vector<double>& b, Vector<double>& x) const throw(MemoryException)
+	{
+		Assert(b.size == rows);
+		Assert(x.size == rows);
+
+		try
+		{
+			Vector<double> y(rows);
+			for (register int k = 0; k < rows; ++k)
+			{
+				y.entry[k] = b.entry[permutation.entry[k]];
+			}
+
+			// L*y = P*b
+			for (register int s = 0; s < supernodes; ++s)
+			{
+				const int first = supernode_begin.entry[s];
+				const int width = supernode_begin.entry[s + 1] - first;
+				const int size = structure_begin.entry[s + 1] - structure_begin.entry[s];
+				const int* __restrict row = structure.entry + structure_begin.entry[s];
+				double** __restrict l = block.entry[s].entry;
+				double* __restrict y_s = y.entry + first;
+				for (register int j = 0; j < width; ++j)
+				{
+					register double sum = y_s[j];
+					for (register int t = 0; t < j; ++t)
+					{
+						sum -= l[j][t]*y_s[t];
+					}
+					y_s[j] = sum;
+				}
+				for (register int r = width; r < size; ++r)
+				{
+					register double sum = 0;
+					for (register int t = 0; t < width; ++t)
+					{
+						sum += l[r][t]*y_s[t];
+					}
+					y.entry[row[r]] -= sum;
+				}
+			}
+
+			for (register int k = 0; k < rows; ++k)
+			{
+				y.entry[k] /= diagonal.entry[k];
+			}
+
+			// L'*z = y
+			for (register int s = supernodes - 1; s >= 0; --s)
+			{
+				const int first = supernode_begin.entry[s];
+				const int width = supernode_begin.entry[s + 1] - first;
+				const int size = structure_begin.entry[s + 1] - structure_begin.entry[s];
+				const int* __restrict row = structure.entry + structure_begin.entry[s];
+				double** __restrict l = block.entry[s].entry;
+				double* __restrict y_s = y.entry + first;
+				for (register int r = width; r < size; ++r)
+				{
+					register double y_r = y.entry[row[r]];
+					for (register int t = 0; t < width; ++t)
+					{
+						y_s[t] -= l[r][t]*y_r;
+					}
+				}
+				for (register int j = width - 1; j >= 0; --j)
+				{
+					register double y_j = y_s[j];
+					for (register int t = 0; t < j; ++t)
+					{
+						y_s[t] -= l[j][t]*y_j;
+					}
+				}
+			}
+
+			for (register int k = 0; k < rows; ++k)
+			{
+				x.entry[permutation.entry[k]] = y.entry[k];
+			}
+		}
+		catch (MemoryException&)
+		{
+			ReThrow();
+		}
+	}
+
+
+	double SparseCholesky::FactorNonZeros() const throw()
+	{
+		register double nonzeros = 0;
+		for (register int s = 0; s < supernodes; ++s)
+		{
+			register double width = supernode_begin.entry[s + 1] - supernode_begin.entry[s];
+			register double size = structure_begin.entry[s + 1] - structure_begin.entry[s];
+			nonzeros += size*width - width*(width - 1)/2;
+		}
+		return nonzeros;
+	}
+}
@@ -0,0 +1,177 @@
+// SparseCholesky.h
+// Copyright (C) 2016 Miguel Vargas-Felix (miguel.vargas@gmail.com)
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Library General Public
+// License as published by the Free Software Foundation; either
+// version 2 of the License, or (at your option) any later version.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with this library; if not, write to the Free
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+#pragma once
+
+#include <Basic/Assert.h>
+#include <Basic/Exception.h>
+#include <Basic/Memory.h>
+#include <Container/CSRMatrix.h>
+#include <Container/Matrix.h>
+#include <Container/Vector.h>
+
+
+// Supernode updates with at least this many multiply-adds go through Gemm, smaller ones are done in place
+#if !defined(CHOLESKY_GEMM_LIMIT)
+	#define CHOLESKY_GEMM_LIMIT 4096
+#endif
+
+// Supernodes are factored in panels of this many columns, the rest of the supernode is updated with Gemm
+#if !defined(CHOLESKY_BLOCK_COLUMNS)
+	#define CHOLESKY_BLOCK_COLUMNS 64
+#endif
+
+// Default pivot_tolerance of SparseCholesky. Singular matrices leave rounding noise of about 1e-13 times
+// the largest diagonal entry in their pivots instead of an exact zero.
+#if !defined(CHOLESKY_PIVOT_TOLERANCE)
+	#define CHOLESKY_PIVOT_TOLERANCE 1e-12
+#endif
+
+
+namespace Grok
+{
+	struct FactorizationException : public Exception
+	{
+		// Column of the permuted matrix where the pivot fell below the tolerance
+		int column;
+
+		FactorizationException(int column) throw()
+		:	Exception(),
+			column(column)
+		{
+		}
+	};
+
+
+	// Approximate minimum degree ordering of the symmetric pattern given by the lower triangle of a
+	// (P. R. Amestoy, T. A. Davis, I. S. Duff, An Approximate Minimum Degree Ordering Algorithm. SIAM
+	// Journal on Matrix Analysis and Applications, Vol. 17, No. 4. 1996). Uses the quotient graph with
+	// approximate external degrees and element absorption, without supervariable detection. Rows denser
+	// than 10*sqrt(rows) go last. Row permutation[k] of a becomes row k.
+	void ApproximateMinimumDegree(const SparseMatrixCSR<double>& a, Vector<int>& permutation) throw(MemoryException);
+
+
+	// Supernodal LDL' factorization P*A*P' = L*D*L' of a symmetric matrix, without pivoting. Only the
+	// lower triangle of A is read. Analyze does all the work that depends on the pattern only: ordering,
+	// elimination tree, postorder, relaxed supernodes, their row structures and the storage of L.
+	// Factorize can then be called any number of times for matrices with that same pattern.
+	//
+	// Supernode s holds the columns [supernode_begin[s], supernode_begin[s + 1]) of L as the dense block
+	// block[s], whose row r is row structure[structure_begin[s] + r] of L. Its diagonal block is unit lower
+	// triangular (D is kept apart in diagonal). Factorize is left-looking: each supernode gathers the
+	// updates of its descendants, computed with Gemm when large, then factors its dense block by panels.
+	struct SparseCholesky
+	{
+		int rows;
+
+		int supernodes;
+
+		Vector<int> permutation;
+
+		Vector<int> inverse_permutation;
+
+		// Elimination tree of the permuted matrix, -1 at roots
+		Vector<int> parent;
+
+		Vector<int> supernode_of;
+
+		Vector<int> supernode_begin;
+
+		Vector<int> structure_begin;
+
+		Vector<int> structure;
+
+		Vector<Matrix<double> > block;
+
+		Vector<double> diagonal;
+
+		// Factorize throws when a pivot is not larger in magnitude than pivot_tolerance times the largest
+		// magnitude on the diagonal of A
+		double pivot_tolerance;
+
+
+		inline SparseCholesky() throw()
+		:	rows(0),
+			supernodes(0),
+			permutation(),
+			inverse_permutation(),
+			parent(),
+			supernode_of(),
+			supernode_begin(),
+			structure_begin(),
+			structure(),
+			block(),
+			diagonal(),
+			pivot_tolerance(CHOLESKY_PIVOT_TOLERANCE),
+			assembly(),
+			position(),
+			link_head(),
+			link_next(),
+			next_row(),
+			scaled(),
+			update()
+		{
+		}
+
+
+		SparseCholesky(const SparseMatrixCSR<double>& a) throw(MemoryException);
+
+
+		// Symbolic factorization with the approximate minimum degree ordering
+		void Analyze(const SparseMatrixCSR<double>& a) throw(MemoryException);
+
+
+		// Symbolic factorization with a given ordering, row ordering[k] of a becomes row k (before the postorder)
+		void Analyze(const SparseMatrixCSR<double>& a, const Vector<int>& ordering) throw(MemoryException);
+
+
+		// Numeric factorization of a matrix with the pattern given to Analyze (stored in the same order)
+		void Factorize(const SparseMatrixCSR<double>& a) throw(MemoryException, FactorizationException);
+
+
+		// x = A^-1*b, b and x may be the same vector
+		void Solve(const Vector<double>& b, Vector<double>& x) const throw(MemoryException);
+
+
+		// Entries of L, diagonal included
+		double FactorNonZeros() const throw();
+
+
+		private:
+
+			// Entry of the blocks where each entry of A is added, null for the upper triangle
+			Vector<double*> assembly;
+
+			Vector<int> position;
+
+			Vector<int> link_head;
+
+			Vector<int> link_next;
+
+			Vector<int> next_row;
+
+			Matrix<double> scaled;
+
+			Matrix<double> update;
+
+
+			SparseCholesky(const SparseCholesky&);
+
+
+			SparseCholesky& operator = (const SparseCholesky&);
+	};
+}